@@ -1,2 +1,4 @@
-avm = StaticLibrary( 'avm2', sources = [ 'avm', 'base' ] )
-Executable( 'avmshell', sources = [ 'avmshell/main.cpp' ], include = [ 'avm' ], libs = [ avm ] )
\ No newline at end of file
+avm        = StaticLibrary( 'avm2', sources = [ 'avm', 'base' ] )
+avmRelease = StaticLibrary( 'avm2-release', sources = [ 'avm', 'base' ], defines = [ 'AVM2_DEBUG=0' ] )
+Executable( 'avmshell', sources = [ 'avmshell/main.cpp' ], include = [ 'avm' ], libs = [ avm ] )
+Executable( 'avmbench', sources = [ 'avmbench/main.cpp' ], include = [ 'avm' ], libs = [ avmRelease ] )
\ No newline at end of file
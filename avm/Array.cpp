@@ -37,16 +37,16 @@ namespace avm2
 // -------------------------------------------------------------- Array -------------------------------------------------------- //
 
 // ** Array::Array
-Array::Array( Domain* domain, int size ) : Object( domain )
+Array::Array( Domain* domain, int size ) : Object( domain ), m_length( 0 ), m_isSparse( false )
 {
     m_class = domain->findClass( "Array" );
     assert( m_class != NULL );
-    
-    m_array.resize( size );
+
+    resize( size );
 }
 
 // ** Array::Array
-Array::Array( Domain* domain, const ValueArray& values ) : Object( domain )
+Array::Array( Domain* domain, const ValueArray& values ) : Object( domain ), m_length( values.size() ), m_isSparse( false )
 {
     m_class = domain->findClass( "Array" );
     assert( m_class != NULL );
@@ -68,18 +68,28 @@ const char* Array::to_string( void )
     return m_stringValue.c_str();
 }
 
+// ** nameToIndex
+//! Parses a property name that is an element index, negative and too large numbers name dynamic properties.
+static bool nameToIndex( const Str& name, int* index )
+{
+    char* tail  = NULL;
+    long  value = strtol( name.c_str(), &tail, 10 );
+
+    if( tail == name.c_str() || *tail != 0 || value < 0 || value > Array::MaxIndex ) {
+        return false;
+    }
+
+    *index = int( value );
+    return true;
+}
+
 // ** Array::setMember
 bool Array::set_member( const Str& name, const Value& value )
 {
     int index;
 
-    if( string_to_number( &index, name.c_str() ) ) {
-        if( index >= m_array.size() ) {
-            m_array.resize( index + 1 );
-        }
-        m_array[index] = value;
-
-        return true;
+    if( nameToIndex( name, &index ) ) {
+        return setElement( index, value );
     }
 
     return Object::set_member( name, value );
@@ -90,40 +100,158 @@ bool Array::get_member( const Str& name, Value* value )
 {
     int index;
 
-    if( !string_to_number( &index, name.c_str() ) ) {
+    if( !nameToIndex( name, &index ) ) {
         return Object::get_member( name, value );
     }
 
-    if( index >= 0 && index < length() ) {
-        if( value ) *value = m_array[index];
-        return true;
+    return element( index, value );
+}
+
+// ** Array::nextIndex
+int Array::nextIndex( int index ) const
+{
+    // ** Elements are enumerated by their position, a cursor is an element index plus one
+    if( !m_isSparse ) {
+        return index >= 0 && index < m_length ? index + 1 : 0;
     }
 
-    return false;
+    SparseValues::const_iterator i = m_sparse.lower_bound( index );
+    return i != m_sparse.end() ? i->first + 1 : 0;
 }
 
-// ** Array::createIterator
-IteratorPtr Array::createIterator( const Value& value )
+// ** Array::nameAt
+Value Array::nameAt( int index ) const
 {
-    return new ArrayIterator( &m_array, value.asInt() );
+    return index - 1;
 }
 
-// ** Array::nextKey
-Value Array::nextKey( const Value& key ) const
+// ** Array::valueAt
+Value Array::valueAt( int index ) const
 {
-    return key.asInt() - 1; // ** VM passed a 1-based indices
+    return at( index - 1 );
 }
 
-// ** Array::getPropertyByKey
-Value Array::getPropertyByKey( const Value& key ) const
+// ** Array::isSparse
+bool Array::isSparse( void ) const
 {
-    int idx = key.isNumber() ? key.asInt() - 1 : -1;
-    return idx >= 0 && idx < length() ? m_array[idx] : Value::undefined;
+    return m_isSparse;
+}
+
+// ** Array::isTooSparse
+bool Array::isTooSparse( int count, int length, int density )
+{
+    return length > SparseMinLength && count < length / density;
+}
+
+// ** Array::elementCount
+int Array::elementCount( void ) const
+{
+    return m_isSparse ? ( int )m_sparse.size() : m_length;
+}
+
+// ** Array::makeSparse
+void Array::makeSparse( void )
+{
+    assert( !m_isSparse );
+
+    // ** Holes of a dense array are undefined values, they are not worth an entry
+    for( int i = 0; i < m_length; i++ ) {
+        if( !m_array[i].isUndefined() ) {
+            m_sparse[i] = m_array[i];
+        }
+    }
+
+    m_array.clear();
+    m_isSparse = true;
+}
+
+// ** Array::makeDense
+void Array::makeDense( void )
+{
+    assert( m_isSparse );
+
+    m_array.resize( m_length );
+
+    for( SparseValues::const_iterator i = m_sparse.begin(), end = m_sparse.end(); i != end; ++i ) {
+        m_array[i->first] = i->second;
+    }
+
+    m_sparse.clear();
+    m_isSparse = false;
+}
+
+// ** Array::at
+Value Array::at( int index ) const
+{
+    Value value;
+    return element( index, &value ) ? value : Value::undefined;
+}
+
+// ** Array::getElement
+bool Array::getElement( const Name* name, int index, Value* value ) const
+{
+    return element( index, value );
+}
+
+// ** Array::setElement
+bool Array::setElement( const Name* name, int index, const Value& value )
+{
+    return setElement( index, value );
+}
+
+// ** Array::element
+bool Array::element( int index, Value* value ) const
+{
+    if( index < 0 || index >= m_length ) {
+        return false;
+    }
+
+    if( !m_isSparse ) {
+        if( value ) *value = m_array[index];
+        return true;
+    }
+
+    SparseValues::const_iterator i = m_sparse.find( index );
+
+    if( i == m_sparse.end() ) {
+        return false;
+    }
+
+    if( value ) *value = i->second;
+    return true;
+}
+
+// ** Array::setElement
+bool Array::setElement( int index, const Value& value )
+{
+    assert( index >= 0 && index <= MaxIndex );
+
+    if( index >= m_length ) {
+        resize( index + 1 );
+    }
+
+    if( !m_isSparse ) {
+        m_array[index] = value;
+        return true;
+    }
+
+    m_sparse[index] = value;
+
+    if( !isTooSparse( elementCount(), m_length, DenseDensity ) ) {
+        makeDense();
+    }
+
+    return true;
 }
 
 // ** Array::splice
 Value Array::splice( int startIndex, int deleteCount, const ValueArray& values )
 {
+    // ** Splicing renumbers every element after the start index, so operate on a dense array
+    if( m_isSparse ) {
+        makeDense();
+    }
+
     if( startIndex  < 0 ) startIndex  = length() + startIndex;
     if( deleteCount < 0 ) deleteCount = length() - startIndex;
 
@@ -140,6 +268,8 @@ Value Array::splice( int startIndex, int deleteCount, const ValueArray& values )
         m_array.insert( m_array.begin() + startIndex + i, values[i] );
     }
 
+    m_length = m_array.size();
+
     return new Array( m_domain, result );
 }
 
@@ -153,7 +283,7 @@ Value Array::slice( int startIndex, int endIndex ) const
     ValueArray result;
 
     for( int i = startIndex; i < endIndex; i++ ) {
-        result.push_back( m_array[i] );
+        result.push_back( at( i ) );
     }
 
     return new Array( m_domain, result );
@@ -162,11 +292,9 @@ Value Array::slice( int startIndex, int endIndex ) const
 // ** Array::concat
 void Array::concat( ValueArray& target, const Value& value )
 {
-    if( value.isArray() ) {
-        const ValueArray& items = value.asArray()->items();
-
-        for( ValueArray::const_iterator i = items.begin(), end = items.end(); i != end; ++i ) {
-            concat( target, *i );
+    if( const Array* array = value.asArray() ) {
+        for( int i = 0, n = array->length(); i < n; i++ ) {
+            concat( target, array->at( i ) );
         }
     } else {
         target.insert( target.end(), value );
@@ -176,7 +304,11 @@ void Array::concat( ValueArray& target, const Value& value )
 // ** Array::concat
 Value Array::concat( const ValueArray& values ) const
 {
-    ValueArray result = m_array;
+    ValueArray result;
+
+    for( int i = 0; i < m_length; i++ ) {
+        result.push_back( at( i ) );
+    }
 
     for( ValueArray::const_iterator i = values.begin(), end = values.end(); i != end; ++i ) {
         concat( result, *i );
@@ -188,20 +320,14 @@ Value Array::concat( const ValueArray& values ) const
 // ** Array::length
 int Array::length( void ) const
 {
-    return ( int )m_array.size();
-}
-
-// ** Array::items
-const ValueArray& Array::items( void ) const
-{
-    return m_array;
+    return m_length;
 }
 
 // ** Array::push
 int Array::push( const ValueArray& values )
 {
     for( int i = 0, n = ( int )values.size(); i < n; i++ ) {
-        m_array.push_back( values[i] );
+        push( values[i] );
     }
 
     return length();
@@ -210,21 +336,57 @@ int Array::push( const ValueArray& values )
 // ** Array::push
 int Array::push( const Value& value )
 {
-    m_array.push_back( value );
+    if( m_isSparse ) {
+        setElement( m_length, value );
+    } else {
+        m_array.push_back( value );
+        m_length++;
+    }
+
     return length();
 }
 
 // ** Array::resize
 void Array::resize( int size )
 {
-    m_array.resize( size );
+    if( size < 0 ) {
+        size = 0;
+    }
+
+    // ** Growing far beyond the stored elements switches to sparse storage instead of allocating the holes
+    if( !m_isSparse && isTooSparse( elementCount(), size, SparseDensity ) ) {
+        makeSparse();
+    }
+
+    m_length = size;
+
+    if( !m_isSparse ) {
+        m_array.resize( size );
+        return;
+    }
+
+    m_sparse.erase( m_sparse.lower_bound( size ), m_sparse.end() );
+
+    if( !isTooSparse( elementCount(), m_length, DenseDensity ) ) {
+        makeDense();
+    }
 }
 
 // ** Array::pop
 Value Array::pop( void )
 {
-    Value value = m_array.back();
-    m_array.pop_back();
+    if( m_length == 0 ) {
+        return Value::undefined;
+    }
+
+    Value value = at( m_length - 1 );
+
+    if( m_isSparse ) {
+        resize( m_length - 1 );
+    } else {
+        m_array.pop_back();
+        m_length--;
+    }
 
     return value;
 }
@@ -232,8 +394,26 @@ Value Array::pop( void )
 // ** Array::shift
 Value Array::shift( void )
 {
-    Value result = m_array[0];
-    m_array.erase( m_array.begin() );
+    if( m_length == 0 ) {
+        return Value::undefined;
+    }
+
+    Value result = at( 0 );
+
+    if( !m_isSparse ) {
+        m_array.erase( m_array.begin() );
+        m_length--;
+        return result;
+    }
+
+    SparseValues shifted;
+
+    for( SparseValues::const_iterator i = m_sparse.upper_bound( 0 ), end = m_sparse.end(); i != end; ++i ) {
+        shifted[i->first - 1] = i->second;
+    }
+
+    m_sparse.swap( shifted );
+    resize( m_length - 1 );
 
     return result;
 }
@@ -241,15 +421,31 @@ Value Array::shift( void )
 // ** Array::unshift
 int Array::unshift( const Value& value )
 {
-    m_array.insert( m_array.begin(), value );
+    if( !m_isSparse ) {
+        m_array.insert( m_array.begin(), value );
+        m_length++;
+        return length();
+    }
+
+    SparseValues shifted;
+    shifted[0] = value;
+
+    for( SparseValues::const_iterator i = m_sparse.begin(), end = m_sparse.end(); i != end; ++i ) {
+        shifted[i->first + 1] = i->second;
+    }
+
+    m_sparse.swap( shifted );
+    resize( m_length + 1 );
+
     return length();
 }
 
 // ** Array::every
 bool Array::every( Function *function, const Value& instance ) const
 {
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        Value args[] = { m_array[i], i, ( Object* )this };
+    for( int cursor = nextIndex( 0 ); cursor; cursor = nextIndex( cursor ) ) {
+        int   i      = cursor - 1;
+        Value args[] = { at( i ), i, ( Object* )this };
         Value result = function->call( Value::undefined, args, 3 );
 
         if( result.asBool() == false ) {
@@ -263,23 +459,25 @@ bool Array::every( Function *function, const Value& instance ) const
 // ** Array::some
 bool Array::some( Function *function, const Value& instance ) const
 {
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        Value args[] = { m_array[i], i, ( Object* )this };
+    for( int cursor = nextIndex( 0 ); cursor; cursor = nextIndex( cursor ) ) {
+        int   i      = cursor - 1;
+        Value args[] = { at( i ), i, ( Object* )this };
         Value result = function->call( Value::undefined, args, 3 );
 
         if( result.asBool() == true ) {
             return true;
         }
     }
-    
+
     return false;
 }
 
 // ** Array::forEach
 void Array::forEach( Function* function, const Value& instance ) const
 {
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        Value args[] = { m_array[i], i, ( Object* )this };
+    for( int cursor = nextIndex( 0 ); cursor; cursor = nextIndex( cursor ) ) {
+        int   i      = cursor - 1;
+        Value args[] = { at( i ), i, ( Object* )this };
         function->call( Value::undefined, args, 3 );
     }
 }
@@ -287,16 +485,17 @@ void Array::forEach( Function* function, const Value& instance ) const
 // ** Array::map
 Value Array::map( Function* function, const Value& instance ) const
 {
-    ValueArray mapped;
+    Array* mapped = new Array( m_domain, m_length );
 
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        Value args[] = { m_array[i], i, ( Object* )this };
+    for( int cursor = nextIndex( 0 ); cursor; cursor = nextIndex( cursor ) ) {
+        int   i      = cursor - 1;
+        Value args[] = { at( i ), i, ( Object* )this };
         Value result = function->call( Value::undefined, args, 3 );
 
-        mapped.push_back( result );
+        mapped->setElement( i, result );
     }
 
-    return new Array( m_domain, mapped );
+    return mapped;
 }
 
 // ** Array::filter
@@ -304,15 +503,17 @@ Value Array::filter( Function *function, const Value& instance ) const
 {
     ValueArray filtered;
 
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        Value args[] = { m_array[i], i, ( Object* )this };
+    for( int cursor = nextIndex( 0 ); cursor; cursor = nextIndex( cursor ) ) {
+        int   i      = cursor - 1;
+        Value item   = at( i );
+        Value args[] = { item, i, ( Object* )this };
         Value result = function->call( Value::undefined, args, 3 );
 
         if( result.isBool() && result.asBool() ) {
-            filtered.push_back( m_array[i] );
+            filtered.push_back( item );
         }
     }
-    
+
     return new Array( m_domain, filtered );
 }
 
@@ -340,10 +541,10 @@ int Array::indexOf( const Value& value, int startIndex ) const
 {
     if( startIndex < 0 )        startIndex = 0;
     if( startIndex > length() ) startIndex = length();
-    
-    for( int i = startIndex, n = ( int )m_array.size(); i < n; i++ ) {
-        if( Value::compare( m_array[i], value ) ) {
-            return i;
+
+    for( int cursor = nextIndex( startIndex ); cursor; cursor = nextIndex( cursor ) ) {
+        if( Value::compare( at( cursor - 1 ), value ) ) {
+            return cursor - 1;
         }
     }
 
@@ -356,6 +557,16 @@ int Array::lastIndexOf( const Value& value, int startIndex ) const
     if( startIndex < 0 )        startIndex = length() - 1;
     if( startIndex > length() ) startIndex = length() - 1;
 
+    if( m_isSparse ) {
+        for( SparseValues::const_reverse_iterator i( m_sparse.upper_bound( startIndex ) ), end = m_sparse.rend(); i != end; ++i ) {
+            if( Value::compare( i->second, value ) ) {
+                return i->first;
+            }
+        }
+
+        return -1;
+    }
+
     for( int i = startIndex; i >= 0; i-- ) {
         if( Value::compare( m_array[i], value ) ) {
             return i;
@@ -370,8 +581,8 @@ Value Array::join( const Str& separator ) const
 {
     Str result = "";
 
-    for( int i = 0, n = ( int )m_array.size(); i < n; i++ ) {
-        const Value& value = m_array[i];
+    for( int i = 0, n = m_length; i < n; i++ ) {
+        Value value = at( i );
         result += value.isUndefined() ? "" : value.asString();
 
         if( i < (n - 1) ) {
@@ -385,6 +596,17 @@ Value Array::join( const Str& separator ) const
 // ** Array::reverse
 Value Array::reverse( void )
 {
+    if( m_isSparse ) {
+        SparseValues reversed;
+
+        for( SparseValues::const_iterator i = m_sparse.begin(), end = m_sparse.end(); i != end; ++i ) {
+            reversed[m_length - 1 - i->first] = i->second;
+        }
+
+        m_sparse.swap( reversed );
+        return this;
+    }
+
     ValueArray result;
 
     for( int i = length() - 1; i >= 0; i-- ) {
@@ -396,6 +618,28 @@ Value Array::reverse( void )
     return this;
 }
 
+// ** Array::sortElements
+void Array::sortElements( const ArrayComparator& comparator )
+{
+    if( !m_isSparse ) {
+        std::sort( m_array.begin(), m_array.end(), comparator );
+        return;
+    }
+
+    // ** Sorted elements of a sparse array are packed to its beginning, holes move to the end
+    ValueArray values;
+
+    for( SparseValues::const_iterator i = m_sparse.begin(), end = m_sparse.end(); i != end; ++i ) {
+        values.push_back( i->second );
+    }
+
+    std::sort( values.begin(), values.end(), comparator );
+    m_sparse.clear();
+
+    for( int i = 0, n = values.size(); i < n; i++ ) {
+        m_sparse[i] = values[i];
+    }
+}
 
 // ** Array::sort
 void Array::sort( const Value& first, const Value& second )
@@ -405,7 +649,7 @@ void Array::sort( const Value& first, const Value& second )
     if( first.isNumber() )       flags.push_back( first.asInt() );
     else if( second.isNumber() ) flags.push_back( second.asInt() );
 
-    std::sort( m_array.begin(), m_array.end(), ArrayComparator( first.asFunction(), StrArray(), flags ) );
+    sortElements( ArrayComparator( first.asFunction(), StrArray(), flags ) );
 }
 
 // ** Array::sortOn
@@ -414,33 +658,7 @@ void Array::sortOn( const Value& fieldName, const Value& options )
     StrArray     fields = fieldName.asStrArray();
     IntegerArray flags  = options.asIntegerArray();
 
-    std::sort( m_array.begin(), m_array.end(), ArrayComparator( NULL, fields, flags ) );
-}
-
-// --------------------------------------------------------- ArrayIterator --------------------------------------------------------- //
-
-// ** ArrayIterator::ArrayIterator
-ArrayIterator::ArrayIterator( ValueArray* values, int idx ) : m_values( values ), m_iterator( idx )
-{
-    next();
-}
-
-// ** ArrayIterator::hasNext
-bool ArrayIterator::hasNext( void ) const
-{
-    return m_iterator <= ( int )m_values->size();
-}
-
-// ** ArrayIterator::next
-void ArrayIterator::next( void )
-{
-    ++m_iterator;
-}
-
-// ** ArrayIterator::key
-Value ArrayIterator::key( void ) const
-{
-    return m_iterator;
+    sortElements( ArrayComparator( NULL, fields, flags ) );
 }
 
 // -------------------------------------------------------- ArrayComparator -------------------------------------------------------- //
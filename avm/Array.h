@@ -32,9 +32,13 @@
 
 #include "Function.h"
 
+#include <map>
+
 namespace avm2
 {
 
+    class ArrayComparator;
+
     // ** class Array
 	class Array : public Object {
     public:
@@ -47,6 +51,17 @@ namespace avm2
 			Numeric             = 16
         };
 
+        //! Elements are kept in an ordered map once fewer than one of SparseDensity slots would be used,
+        //! and move back to a plain array when at least one of DenseDensity slots is filled again.
+        enum {
+            SparseMinLength     = 1024,
+            SparseDensity       = 4,
+            DenseDensity        = 2
+        };
+
+        //! Largest element index, so the length one past it still fits an int. Larger names are dynamic properties.
+        enum { MaxIndex = 0x7ffffffe };
+
                             AvmDeclareType( AS_ARRAY, Object )
 
                             Array( Domain* domain, int size = 0 );
@@ -57,9 +72,11 @@ namespace avm2
         virtual void        copy_to( Object* target );
         virtual bool        set_member( const Str& name, const Value& value );
         virtual bool        get_member( const Str& name, Value* value );
-        virtual IteratorPtr createIterator( const Value& value );
-        virtual Value       getPropertyByKey( const Value& key ) const;
-        virtual Value       nextKey( const Value& key ) const;
+        virtual int         nextIndex( int index ) const;
+        virtual Value       nameAt( int index ) const;
+        virtual Value       valueAt( int index ) const;
+        virtual bool        getElement( const Name* name, int index, Value* value ) const;
+        virtual bool        setElement( const Name* name, int index, const Value& value );
 
         // ** Array
 		int                 push( const ValueArray& values );
@@ -82,7 +99,10 @@ namespace avm2
         int                 unshift( const Value& item );
 	//	void                sort( int options, Function* compare );
 		int                 length( void ) const;
-        const ValueArray&   items( void ) const;
+        bool                isSparse( void ) const;
+        Value               at( int index ) const;
+        bool                element( int index, Value* value ) const;
+        bool                setElement( int index, const Value& value );
         int                 indexOf( const Value& value, int fromIndex = 0 ) const;
         int                 lastIndexOf( const Value& value, int fromIndex = -1 ) const;
         Value               join( const Str& separator = "," ) const;
@@ -92,31 +112,25 @@ namespace avm2
 
     private:
 
+        //! Sparse elements ordered by index.
+        typedef std::map<int, Value> SparseValues;
+
         static void         concat( ValueArray& items, const Value& value );
+        static bool         isTooSparse( int count, int length, int density );
+        int                 elementCount( void ) const;
+        void                makeSparse( void );
+        void                makeDense( void );
+        void                sortElements( const ArrayComparator& comparator );
 
     private:
 
         Str                 m_stringValue;
+        int                 m_length;
+        bool                m_isSparse;
         ValueArray          m_array;
+        SparseValues        m_sparse;
 	};
 
-    // ** class ArrayIterator
-    class ArrayIterator : public Iterator {
-    public:
-
-                            ArrayIterator( ValueArray* values, int idx );
-
-        // ** Iterator
-        virtual bool        hasNext( void ) const;
-        virtual void        next( void );
-        virtual Value       key( void ) const;
-
-    private:
-
-        ValueArray*         m_values;
-        int                 m_iterator;
-    };
-
     // ** class ArrayComparator
     class ArrayComparator {
     public:
@@ -49,9 +49,83 @@
 #define AvmReferenceError( ... )    throwError( frame, ReferenceError, __VA_ARGS__ );                   \
                                     AvmHandleException( frame )
 
+// ** Only backward branches count towards the runaway limit and loop hotness, so straight-line code pays nothing for them.
+#define AvmBranch( target )         if( (target) < op ) {                                               \
+                                        if( ++runAway > AvmRunAwayLimit ) {                             \
+                                            AvmReferenceError( "Loop runaway error" );                  \
+                                        }                                                               \
+                                        AvmBackEdge( (target) + 1 );                                    \
+                                    }                                                                   \
+                                    op = (target)
+
+#if AVM2_JIT
+    // ** A hot loop moves the running call to compiled code at the loop header (on-stack replacement).
+    #define AvmBackEdge( header )   if( ++backEdges[header] >= loopThreshold && canEnterLoop( function, header ) ) { \
+                                        if( JitCode jitCode = tierUp( function, header ) ) {            \
+                                            op = enterCompiled( jitCode, function, frame, registers, runAway ); \
+                                            if( op < 0 ) {                                              \
+                                                return;                                                 \
+                                            }                                                           \
+                                            AvmHandleException( frame );                                \
+                                            op--;                                                       \
+                                            continue;                                                   \
+                                        }                                                               \
+                                    }
+#else
+    #define AvmBackEdge( header )   backEdges[header]++
+#endif
+
+// ** Pops two int operands and pushes the result of a given operator, int opcodes wrap around on overflow.
+#define AvmIntBinary( operator )    {                                                                   \
+                                        Uint32 b = stack.pop().asInt();                                 \
+                                        Uint32 a = stack.pop().asInt();                                 \
+                                        stack.push( int( a operator b ) );                              \
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );               \
+                                    }
+
+// ** Pops two operands a and b and pushes a boolean result of a given expression.
+#define AvmCompare( expression )    {                                                                   \
+                                        Value b = stack.pop();                                          \
+                                        Value a = stack.pop();                                          \
+                                        stack.push( Value( expression ) );                              \
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );               \
+                                    }
+
+#if AVM2_DEBUG
+    #define AvmTrace( i )           IF_VERBOSE_ACTION( opCode = Dump::formatOpCode( (i)->opCode ); logger::msg( "\n" ) )
+#else
+    #define AvmTrace( i )
+#endif
+
+// ** Threaded handlers fetch and dispatch the next instruction themselves, so each one ends with its own indirect
+//    branch instead of sharing the one at the loop head. Exceptions and loop tier-up still go through the loop.
+#if AVM2_THREADED_DISPATCH
+    #define AvmDispatch( i )        goto *(i)->handler;
+    #define AvmCase( name )         Handler##name
+    #define AvmDefault              HandlerUnhandled
+    #define AvmNext                 if( ++op >= n ) {                                                   \
+                                        return;                                                         \
+                                    }                                                                   \
+                                    i = &code[op];                                                      \
+                                    AvmTrace( i );                                                      \
+                                    goto *i->handler
+#else
+    #define AvmDispatch( i )        switch( (i)->opCode )
+    #define AvmCase( name )         case name
+    #define AvmDefault              default
+    #define AvmNext                 continue
+#endif
+
+// ** Register instruction operand, negative indices read the constant pool.
+#define AvmOperand( index )         ( (index) >= 0 ? registers[index] : constants[~(index)] )
+
 namespace avm2
 {
 
+#if AVM2_THREADED_DISPATCH
+const void** Avm::s_handlers = NULL;
+#endif
+
 // ** Avm::Avm
 Avm::Avm( const FunctionScript* function, Domain* domain ) : m_function( function ), m_domain( domain )
 {
@@ -61,20 +135,189 @@ Avm::~Avm( void )
 {
 }
 
+// ** Avm::resolveHandlers
+void Avm::resolveHandlers( Instructions& instructions )
+{
+#if AVM2_THREADED_DISPATCH
+    // ** Handler addresses are labels local to Avm::execute, so let it publish them first.
+    if( s_handlers == NULL ) {
+        Avm( NULL, NULL ).execute( NULL, NULL );
+    }
+
+    for( int i = 0, n = ( int )instructions.size(); i < n; i++ ) {
+        instructions[i].handler = s_handlers[instructions[i].opCode];
+    }
+#endif
+}
+
 // ** Avm::execute
 void Avm::execute( const FunctionScript* function, Frame* frame )
 {
+#if AVM2_THREADED_DISPATCH
+    if( function == NULL ) {
+        static const void* handlers[OpCodeTotal];
+
+        for( int i = 0; i < OpCodeTotal; i++ ) {
+            handlers[i] = &&AvmDefault;
+        }
+
+        #define AvmRegisterHandler( name ) handlers[name] = &&AvmCase( name )
+        AvmRegisterHandler( GetLocal0 );
+        AvmRegisterHandler( GetLocal1 );
+        AvmRegisterHandler( GetLocal2 );
+        AvmRegisterHandler( GetLocal3 );
+        AvmRegisterHandler( SetLocal );
+        AvmRegisterHandler( GetLocal );
+        AvmRegisterHandler( SetLocal1 );
+        AvmRegisterHandler( SetLocal2 );
+        AvmRegisterHandler( SetLocal3 );
+        AvmRegisterHandler( Kill );
+        AvmRegisterHandler( PushScope );
+        AvmRegisterHandler( PopScope );
+        AvmRegisterHandler( GetScopeObject );
+        AvmRegisterHandler( GetGlobalScope );
+        AvmRegisterHandler( FindProperty );
+        AvmRegisterHandler( FindPropertyStrict );
+        AvmRegisterHandler( GetLex );
+        AvmRegisterHandler( GetSuper );
+        AvmRegisterHandler( SetSuper );
+        AvmRegisterHandler( GetProperty );
+        AvmRegisterHandler( SetProperty );
+        AvmRegisterHandler( InitProperty );
+        AvmRegisterHandler( SetSlot );
+        AvmRegisterHandler( GetSlot );
+        AvmRegisterHandler( Call );
+        AvmRegisterHandler( CallSuper );
+        AvmRegisterHandler( CallSuperVoid );
+        AvmRegisterHandler( CallPropVoid );
+        AvmRegisterHandler( CallProperty );
+        AvmRegisterHandler( ReturnVoid );
+        AvmRegisterHandler( ReturnValue );
+        AvmRegisterHandler( NewObject );
+        AvmRegisterHandler( NewArray );
+        AvmRegisterHandler( NewClass );
+        AvmRegisterHandler( NewActivation );
+        AvmRegisterHandler( NewCatch );
+        AvmRegisterHandler( NewFunction );
+        AvmRegisterHandler( Construct );
+        AvmRegisterHandler( ConstructProp );
+        AvmRegisterHandler( ConstructSuper );
+        AvmRegisterHandler( Coerce );
+        AvmRegisterHandler( CoerceToAny );
+        AvmRegisterHandler( ConvertToInt );
+        AvmRegisterHandler( ConvertToUInt );
+        AvmRegisterHandler( ConvertToBool );
+        AvmRegisterHandler( ConvertToString );
+        AvmRegisterHandler( ConvertToDouble );
+        AvmRegisterHandler( InstanceOf );
+        AvmRegisterHandler( IsTypeLate );
+        AvmRegisterHandler( TypeOf );
+        AvmRegisterHandler( ApplyType );
+        AvmRegisterHandler( PushNull );
+        AvmRegisterHandler( PushByte );
+        AvmRegisterHandler( PushInt );
+        AvmRegisterHandler( PushUInt );
+        AvmRegisterHandler( PushDouble );
+        AvmRegisterHandler( PushShort );
+        AvmRegisterHandler( PushString );
+        AvmRegisterHandler( PushTrue );
+        AvmRegisterHandler( PushFalse );
+        AvmRegisterHandler( PushUndefined );
+        AvmRegisterHandler( Pop );
+        AvmRegisterHandler( Dup );
+        AvmRegisterHandler( Swap );
+        AvmRegisterHandler( Add );
+        AvmRegisterHandler( Subtract );
+        AvmRegisterHandler( Negate );
+        AvmRegisterHandler( NegateI );
+        AvmRegisterHandler( Multiply );
+        AvmRegisterHandler( Increment );
+        AvmRegisterHandler( Decrement );
+        AvmRegisterHandler( IncLocal );
+        AvmRegisterHandler( DecLocal );
+        AvmRegisterHandler( AddI );
+        AvmRegisterHandler( SubtractI );
+        AvmRegisterHandler( MultiplyI );
+        AvmRegisterHandler( IncrementI );
+        AvmRegisterHandler( DecrementI );
+        AvmRegisterHandler( IncLocalI );
+        AvmRegisterHandler( DecLocalI );
+        AvmRegisterHandler( BitAnd );
+        AvmRegisterHandler( BitOr );
+        AvmRegisterHandler( BitXOR );
+        AvmRegisterHandler( BitNot );
+        AvmRegisterHandler( LeftShift );
+        AvmRegisterHandler( RightShift );
+        AvmRegisterHandler( URightShift );
+        AvmRegisterHandler( LessThan );
+        AvmRegisterHandler( LessEquals );
+        AvmRegisterHandler( GreaterThan );
+        AvmRegisterHandler( GreaterEquals );
+        AvmRegisterHandler( StrictEquals );
+        AvmRegisterHandler( Equals );
+        AvmRegisterHandler( In );
+        AvmRegisterHandler( HasNext2 );
+        AvmRegisterHandler( NextValue );
+        AvmRegisterHandler( NextName );
+        AvmRegisterHandler( DeleteProperty );
+        AvmRegisterHandler( Label );
+        AvmRegisterHandler( Jump );
+        AvmRegisterHandler( IfTrue );
+        AvmRegisterHandler( IfLess );
+        AvmRegisterHandler( IfNotLessEqual );
+        AvmRegisterHandler( IfGreater );
+        AvmRegisterHandler( IfLessEqual );
+        AvmRegisterHandler( IfFalse );
+        AvmRegisterHandler( IfStictNotEqual );
+        AvmRegisterHandler( IfNotEqual );
+        AvmRegisterHandler( IfNotGreater );
+        AvmRegisterHandler( IfNotLess );
+        AvmRegisterHandler( IfGreaterEqual );
+        AvmRegisterHandler( IfNotGreaterEqual );
+        AvmRegisterHandler( LookupSwitch );
+        AvmRegisterHandler( DebugFile );
+        AvmRegisterHandler( DebugLine );
+        AvmRegisterHandler( Debug );
+        AvmRegisterHandler( Throw );
+        AvmRegisterHandler( RegMove );
+        AvmRegisterHandler( RegAdd );
+        AvmRegisterHandler( RegSubtract );
+        AvmRegisterHandler( RegMultiply );
+        AvmRegisterHandler( RegIncrement );
+        AvmRegisterHandler( RegIncrementI );
+        AvmRegisterHandler( RegDecrement );
+        AvmRegisterHandler( RegIfLess );
+        AvmRegisterHandler( RegIfGreater );
+        AvmRegisterHandler( RegIfLessEqual );
+        AvmRegisterHandler( RegIfNotLess );
+        AvmRegisterHandler( RegIfNotEqual );
+        AvmRegisterHandler( RegIfTrue );
+        AvmRegisterHandler( RegIfFalse );
+        AvmRegisterHandler( RegPushScope );
+        AvmRegisterHandler( RegGetProperty );
+        AvmRegisterHandler( RegIfEquals );
+        AvmRegisterHandler( RegIfNotEquals );
+        #undef AvmRegisterHandler
+
+        s_handlers = handlers;
+        return;
+    }
+#endif
+
     Value*      result     = &frame->m_result;
     Stack&      stack      = frame->m_stack;
     ScopeStack& scopeStack = frame->m_scope;
 
-    ValueArray registers;
-    frame->fillLocalRegisters( registers, 16 );
-    
+    int* backEdges = &function->m_backEdges[0];
+    function->m_callCount++;
+
+    Value*       registers = frame->allocateRegisters( imax( function->m_registerCount, frame->nargs() + 1 ), function->m_maxStack, function->m_maxScope );
+    const Value* constants = function->m_constants.empty() ? NULL : &function->m_constants[0];
+
     AVM2_VERBOSE( "Avm::execute : function=%s, instance=%s\n", function->name().c_str(), registers[0].asCString() );
 
-    const Instructions& code        = function->m_instructions;
-    Exceptions          exceptions  = function->exceptions();
+    const Instructions&     code        = function->m_instructions;
+    const ExceptionTable&   exceptions  = function->m_exceptionTable;
 
     Arguments           args;
     Value               object;
@@ -82,93 +325,117 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
     const char*         debugFile  = "";
     int                 debugLine  = 0;
     int                 runAway    = 0;
+    int                 op         = 0;
+
+#if AVM2_JIT
+    const int           loopThreshold = m_domain->loopThreshold();
 
-    for( int op = 0, n = ( int )code.size(); op < n; op++, runAway++ ) {
-        const Instruction&  i      = code[op];
-        const char*         opCode = Dump::formatOpCode( i.opCode );
+    // ** A function is compiled once, calls enter the compiled code only if the JIT kept an entry for them
+    if( !function->m_tieredUp && function->m_callCount >= m_domain->callThreshold() ) {
+        tierUp( function, 0 );
+    }
+
+    // ** Compiled code returns an instruction to continue the call at, if it can't run the function to the end
+    if( JitCode jitCode = function->m_jitEntry ) {
+        op = enterCompiled( jitCode, function, frame, registers, runAway );
+
+        if( op < 0 ) {
+            return;
+        }
 
-        if( runAway > 1000000 ) {
-            AvmReferenceError( "Loop runaway error" );
+        if( frame->hasUnhandledException() ) {
+            if( !handleException( exceptions, frame, op, "" ) ) {
+                return;
+            }
+            op++;
         }
+    }
+#endif
+
+    for( int n = ( int )code.size(); op < n; op++ ) {
+        const Instruction*  i      = &code[op];
+        const char*         opCode = "";
 
-        switch( i.opCode ) {
+        AvmTrace( i );
+
+        AvmDispatch( i ) {
             // --------------------------------------------------- Locals ----------------------------------------------- //
 
-            case GetLocal0:             AVM2_VERBOSE( "%s : local[0] = %s\n", opCode, registers[0].asCString() );
+            AvmCase( GetLocal0 ):       AVM2_VERBOSE( "%s : local[0] = %s\n", opCode, registers[0].asCString() );
                                         stack.push( registers[0], opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case GetLocal1:             AVM2_VERBOSE( "%s : local[1] = %s\n", opCode, registers[1].asCString() );
+            AvmCase( GetLocal1 ):       AVM2_VERBOSE( "%s : local[1] = %s\n", opCode, registers[1].asCString() );
                                         stack.push( registers[1], opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case GetLocal2:             AVM2_VERBOSE( "%s : local[2] = %s\n", opCode, registers[2].asCString() );
+            AvmCase( GetLocal2 ):       AVM2_VERBOSE( "%s : local[2] = %s\n", opCode, registers[2].asCString() );
                                         stack.push( registers[2], opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case GetLocal3:             AVM2_VERBOSE( "%s : local[3] = %s\n", opCode, registers[3].asCString() );
+            AvmCase( GetLocal3 ):       AVM2_VERBOSE( "%s : local[3] = %s\n", opCode, registers[3].asCString() );
                                         stack.push( registers[3], opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case SetLocal:              AVM2_VERBOSE( "%s : local[%d] = %s\n", opCode, i.Integer, stack.top().asCString() );
-                                        registers[i.Integer] = stack.pop();
+            AvmCase( SetLocal ):        AVM2_VERBOSE( "%s : local[%d] = %s\n", opCode, i->Integer, stack.top().asCString() );
+                                        registers[i->Integer] = stack.pop();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case GetLocal:              AVM2_VERBOSE( "%s : local[%d] = %s\n", opCode, i.Integer, registers[i.Integer].asCString() );
-                                        stack.push( registers[i.Integer] );
+            AvmCase( GetLocal ):        AVM2_VERBOSE( "%s : local[%d] = %s\n", opCode, i->Integer, registers[i->Integer].asCString() );
+                                        stack.push( registers[i->Integer] );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case SetLocal1:             AVM2_VERBOSE( "%s : local[1] = %s\n", opCode, stack.top().asCString() );
+            AvmCase( SetLocal1 ):       AVM2_VERBOSE( "%s : local[1] = %s\n", opCode, stack.top().asCString() );
                                         registers[1] = stack.pop();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case SetLocal2:             AVM2_VERBOSE( "%s : local[2] = %s\n", opCode, stack.top().asCString() );
+            AvmCase( SetLocal2 ):       AVM2_VERBOSE( "%s : local[2] = %s\n", opCode, stack.top().asCString() );
                                         registers[2] = stack.pop();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case SetLocal3:             AVM2_VERBOSE( "%s : local[3] = %s\n", opCode, stack.top().asCString() );
+            AvmCase( SetLocal3 ):       AVM2_VERBOSE( "%s : local[3] = %s\n", opCode, stack.top().asCString() );
                                         registers[3] = stack.pop();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case Kill:                  AVM2_VERBOSE( "%s : %d\n", opCode, i.Integer );
-                                        registers[i.Integer] = Value::undefined;
-                                        break;
+            AvmCase( Kill ):            AVM2_VERBOSE( "%s : %d\n", opCode, i->Integer );
+                                        registers[i->Integer] = Value::undefined;
+                                        AvmNext;
 
             // -------------------------------------------------- Scope ------------------------------------------------- //
 
-            case PushScope:             AVM2_VERBOSE( "%s : %s\n", opCode, stack.top().asCString() );
+            AvmCase( PushScope ):       AVM2_VERBOSE( "%s : %s\n", opCode, stack.top().asCString() );
                                         scopeStack.push( stack.pop().asObject(), opCode );
                                         AVM2_DEBUG_ONLY( dumpScopeStack( "scope", scopeStack ) );
-                                        break;
+                                        AvmNext;
 
-            case PopScope:              AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( PopScope ):        AVM2_VERBOSE( "%s\n", opCode );
                                         scopeStack.pop();
                                         AVM2_DEBUG_ONLY( dumpScopeStack( "scope", scopeStack ) );
-                                        break;
+                                        AvmNext;
 
-            case GetScopeObject:        AVM2_VERBOSE( "%s : %d (pushed %s)\n", opCode, i.Integer, scopeStack.at( i.Integer )->to_string() );
-                                        stack.push( scopeStack.at( i.Integer ), opCode );
+            AvmCase( GetScopeObject ):  AVM2_VERBOSE( "%s : %d (pushed %s)\n", opCode, i->Integer, scopeStack.at( i->Integer )->to_string() );
+                                        stack.push( scopeStack.at( i->Integer ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case GetGlobalScope:        AVM2_VERBOSE( "%s : %s\n", opCode, scopeStack.globalScope()->to_string() );
+            AvmCase( GetGlobalScope ):  AVM2_VERBOSE( "%s : %s\n", opCode, scopeStack.globalScope()->to_string() );
                                         stack.push( scopeStack.globalScope(), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
             // ---------------------------------------------- Property access -------------------------------------------- //
                 
-            case FindProperty:          AVM2_VERBOSE( "%s : '%s' at scope stack - ", opCode, i.Identifier->name().c_str() );
-                                        if( Object* object = findProperty( i.Identifier, frame ) ) {
+            AvmCase( FindProperty ):    AVM2_VERBOSE( "%s : '%s' at scope stack - ", opCode, i->Identifier->name().c_str() );
+                                        if( Object* object = findProperty( i->Identifier, i->lexicalCache, frame ) ) {
                                             AVM2_VERBOSE( "found at %s\n", object->to_string() );
                                             stack.push( Value( object ), opCode );
                                         } else {
@@ -176,54 +443,54 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             stack.push( scopeStack.globalScope(), opCode );
                                         }
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
             
-            case FindPropertyStrict:    AVM2_VERBOSE( "%s : '%s' at scope stack - ", opCode, i.Identifier->name().c_str() );
-                                        if( Object* object = findProperty( i.Identifier, frame ) ) {
+            AvmCase( FindPropertyStrict ): AVM2_VERBOSE( "%s : '%s' at scope stack - ", opCode, i->Identifier->name().c_str() );
+                                        if( Object* object = findProperty( i->Identifier, i->lexicalCache, frame ) ) {
                                             AVM2_VERBOSE( "found at %s\n", object->to_string() );
                                             stack.push( object, opCode );
                                         } else {
-                                            AvmReferenceError( "The property '%s' could not be resolved.", i.Identifier->name().c_str() );
+                                            AvmReferenceError( "The property '%s' could not be resolved.", i->Identifier->name().c_str() );
                                         }
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case GetLex:                {
-                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i.Identifier->name().c_str() );
+            AvmCase( GetLex ):          {
+                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i->Identifier->name().c_str() );
                                             Value value;
-                                            if( findProperty( i.Identifier, frame, &value, true ) ) {
+                                            if( findProperty( i->Identifier, i->lexicalCache, frame, &value, true ) ) {
                                                 stack.push( value, opCode );
                                             } else {
-                                                AvmReferenceError( "The property '%s' could not be resolved.", i.Identifier->name().c_str() );
+                                                AvmReferenceError( "The property '%s' could not be resolved.", i->Identifier->name().c_str() );
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case GetSuper:              {
-                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i.Identifier->name().c_str() );
+            AvmCase( GetSuper ):        {
+                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i->Identifier->name().c_str() );
 
                                             object = stack.pop();
                                             if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i.Identifier->name().c_str() );
+                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i->Identifier->name().c_str() );
                                             }
 
-                                            value = m_function->m_super->executeWithInstance( object.asObject(), args, frame );
+                                            value = m_function->m_super->executeWithInstance( object.asObject(), Arguments(), frame );
                                             AvmHandleException( frame );
 
                                             stack.push( value, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case SetSuper:              {
-                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i.Identifier->name().c_str() );
+            AvmCase( SetSuper ):        {
+                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i->Identifier->name().c_str() );
 
                                             stack.arguments( args, 1 );
 
                                             object = stack.pop();
                                             if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i.Identifier->name().c_str() );
+                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i->Identifier->name().c_str() );
                                             }
 
                                             Value value = m_function->m_super->executeWithInstance( object.asObject(), args, frame );
@@ -232,61 +499,63 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             stack.push( value, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case GetProperty:           {
-                                            AVM2_VERBOSE( "%s : '%s' at %s\n", opCode, i.Identifier->name().c_str(), stack.top().asCString() );
+            AvmCase( GetProperty ):     {
+                                            AVM2_VERBOSE( "%s : '%s' at %s\n", opCode, i->Identifier->name().c_str(), stack.top().asCString() );
 
-                                            bool resolved = resolveProperty( object, value, i.Identifier, frame, true );
+                                            bool resolved = resolveProperty( object, value, i->Identifier, i->cache, frame, !( i->flags & Instruction::UnboundCallee ) );
 
-                                            if( object.isNull() ) {
-                                                AvmTypeError( "Cannot access a property or method of a null object reference." );
-                                            }
+                                            if( !( i->flags & Instruction::NonNullReceiver ) ) {
+                                                if( object.isNull() ) {
+                                                    AvmTypeError( "Cannot access a property or method of a null object reference." );
+                                                }
 
-                                            if( object.isUndefined() ) {
-                                                AvmTypeError( "A term is undefined and has no properties." );
+                                                if( object.isUndefined() ) {
+                                                    AvmTypeError( "A term is undefined and has no properties." );
+                                                }
                                             }
 
                                             stack.push( value, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case SetProperty:
-            case InitProperty:          {
-                                            AVM2_VERBOSE( "%s : %s.%s = %s\n", opCode, stack.top(1).asCString(), i.Identifier->name().c_str(), stack.top().asCString() );
-                                            if( !setProperty( i.Identifier, frame, stack.pop() ) ) {
-                                                AvmReferenceError( "The property '%s' could not be set.", i.Identifier->name().c_str() );
+            AvmCase( SetProperty ):
+            AvmCase( InitProperty ):    {
+                                            AVM2_VERBOSE( "%s : %s.%s = %s\n", opCode, stack.top(1).asCString(), i->Identifier->name().c_str(), stack.top().asCString() );
+                                            if( !setProperty( i->Identifier, i->cache, frame, stack.pop() ) ) {
+                                                AvmReferenceError( "The property '%s' could not be set.", i->Identifier->name().c_str() );
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case SetSlot:               {
-                                            AVM2_VERBOSE( "%s : %s[%d] = %s\n", opCode, stack.top( 1 ).asCString(), i.Integer, stack.top( 0 ).asCString() );
+            AvmCase( SetSlot ):         {
+                                            AVM2_VERBOSE( "%s : %s[%d] = %s\n", opCode, stack.top( 1 ).asCString(), i->Integer, stack.top( 0 ).asCString() );
                                             Value   value  = stack.pop();
                                             Object* object = stack.pop().asObject();
 
-                                            object->setSlot( i.Integer, value );
+                                            object->setSlot( i->Integer, value );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case GetSlot:               AVM2_VERBOSE( "%s : %s[%d] = %s\n", opCode, stack.top().asCString(), i.Integer, stack.top().asObject()->slot( i.Integer ).asCString() );
-                                        stack.push( stack.pop().asObject()->slot( i.Integer ), opCode );
+            AvmCase( GetSlot ):         AVM2_VERBOSE( "%s : %s[%d] = %s\n", opCode, stack.top().asCString(), i->Integer, stack.top().asObject()->slot( i->Integer ).asCString() );
+                                        stack.push( stack.pop().asObject()->slot( i->Integer ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
             // ---------------------------------------------- Function invokation -------------------------------------------- //
 
-            case Call:                  {
+            AvmCase( Call ):            {
                                             AVM2_VERBOSE( "%s : ", opCode );
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
                                             Value receiver = stack.pop();
                                             Value value    = stack.pop();
 
-                                            if( !value.isFunction() ) {
+                                            if( !( i->flags & Instruction::CalleeIsFunction ) && !value.isFunction() ) {
                                                 AvmTypeError( "Value is not a function." );
                                             }
 
@@ -296,49 +565,68 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             stack.push( result );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case CallSuper:
-            case CallSuperVoid:         {
+            AvmCase( CallSuper ):
+            AvmCase( CallSuperVoid ):   {
                                             AVM2_VERBOSE( "%s : ", opCode );
-                                            stack.arguments( args, i.ArgCount );
-
-                                            assert( m_function->m_super != NULL );
+                                            stack.arguments( args, i->ArgCount );
 
                                             object = stack.pop();
                                             if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i.Identifier->name().c_str() );
+                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i->Identifier->name().c_str() );
+                                            }
+
+                                            // ** Resolve a base class method once, the base traits of a running method never change
+                                            const Traits* base   = m_function->superTraits();
+                                            Function*     method = NULL;
+
+                                            if( base ) {
+                                                if( !i->cache->m_base || base->dispatchBase( i->cache->m_dispId ) != i->cache->m_base ) {
+                                                    i->cache->m_dispId = base->resolveDispatchId( i->Identifier );
+                                                    i->cache->m_base   = base->dispatchBase( i->cache->m_dispId );
+                                                }
+
+                                                method = i->cache->m_base ? base->method( i->cache->m_dispId ) : NULL;
+                                            }
+
+                                            if( !method ) {
+                                                method = m_function->m_super.get_ptr();
                                             }
 
-                                            m_function->m_super->executeWithInstance( object.asObject(), args, frame );
+                                            if( !method ) {
+                                                AvmReferenceError( "Property %s not found on a base class.\n", i->Identifier->name().c_str() );
+                                            }
+
+                                            Value result = method->executeWithInstance( object.asObject(), args, frame );
                                             AvmHandleException( frame );
 
-                                            if( op != CallSuperVoid ) {
-                                                stack.push( frame->result() );
+                                            if( i->opCode != CallSuperVoid ) {
+                                                stack.push( result );
                                             }
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case CallPropVoid:          {
-                                            AVM2_VERBOSE( "%s : %s ", opCode, i.Identifier->name().c_str() );
+            AvmCase( CallPropVoid ):    {
+                                            AVM2_VERBOSE( "%s : %s ", opCode, i->Identifier->name().c_str() );
 
                                             // ** Pop arguments
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
-                                            bool resolved = resolveProperty( object, value, i.Identifier, frame );
+                                            bool resolved = resolveProperty( object, value, i->Identifier, i->cache, frame );
 
-                                            if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i.Identifier->name().c_str() );
+                                            if( !( i->flags & Instruction::NonNullReceiver ) && object.isNullOrUndefined() ) {
+                                                AvmTypeError( "Failed to call property '%s', a term is undefined and has no properties.\n", i->Identifier->name().c_str() );
                                             }
 
                                             if( !resolved ) {
-                                                AvmTypeError( "Property %s not found on %s and there is no default value.\n", i.Identifier->name().c_str(), object.type() );
+                                                AvmTypeError( "Property %s not found on %s and there is no default value.\n", i->Identifier->name().c_str(), object.type() );
                                             }
 
                                             if( !value.isFunction() ) {
-                                                AvmTypeError( "%s, value is not a function.", i.Identifier->name().c_str() );
+                                                AvmTypeError( "%s, value is not a function.", i->Identifier->name().c_str() );
                                             }
 
                                             value.asFunction()->executeWithInstance( object.asObject(), args, frame );
@@ -346,27 +634,27 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case CallProperty:          {
-                                            AVM2_VERBOSE( "%s : %s ", opCode, i.Identifier->name().c_str() );
+            AvmCase( CallProperty ):    {
+                                            AVM2_VERBOSE( "%s : %s ", opCode, i->Identifier->name().c_str() );
 
                                             // ** Pop arguments
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
                                             // ** Pop object
-                                            bool resolved = resolveProperty( object, value, i.Identifier, frame );
+                                            bool resolved = resolveProperty( object, value, i->Identifier, i->cache, frame );
 
-                                            if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "%s, cannot access a property or method of a null object reference.", i.Identifier->name().c_str() );
+                                            if( !( i->flags & Instruction::NonNullReceiver ) && object.isNullOrUndefined() ) {
+                                                AvmTypeError( "%s, cannot access a property or method of a null object reference.", i->Identifier->name().c_str() );
                                             }
 
                                             if( !resolved ) {
-                                                AvmReferenceError( "Property %s not found on %s and there is no default value.\n", i.Identifier->name().c_str(), object.type() );
+                                                AvmReferenceError( "Property %s not found on %s and there is no default value.\n", i->Identifier->name().c_str(), object.type() );
                                             }
 
                                             if( !value.isFunction() ) {
-                                                AvmTypeError( "%s, value is not a function.", i.Identifier->name().c_str() );
+                                                AvmTypeError( "%s, value is not a function.", i->Identifier->name().c_str() );
                                             }
 
                                             // ** Call property
@@ -377,16 +665,16 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case ReturnVoid:            if( result ) {
+            AvmCase( ReturnVoid ):      if( result ) {
                                             *result = Value::Undefined;
                                         }
                                         return;
 
-            case ReturnValue:           if( result ) {
+            AvmCase( ReturnValue ):     if( result ) {
                                             *result = stack.pop();
-                                            if( !Value::coerceInPlace( *result, function->returnType() ) ) {
+                                            if( !( i->flags & Instruction::ValueHasType ) && !Value::coerceInPlace( *result, function->returnType() ) ) {
                                                 AvmTypeError( "Failed to coerce return type to %s.", function->returnType()->qualifiedName().c_str() );
                                             }
                                         }
@@ -394,29 +682,31 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
 
             // ---------------------------------------------- Instance construction -------------------------------------------- //
 
-            case NewObject:             {
+            AvmCase( NewObject ):       {
                                             AVM2_VERBOSE( "%s : (", opCode );
 
                                             Object* instance = new Object( m_domain );
-                                            instance->m_members.set_capacity( i.ArgCount );
+                                            instance->reserveMembers( i->ArgCount );
 
-                                            for( int j = 0; j < i.ArgCount; j++ ) {
-                                                Value value = stack.pop();
-                                                Str   name  = stack.pop().asCString();
+                                            // ** Add properties in the source order, so object literals with the same layout share a shape
+                                            for( int j = i->ArgCount; j > 0; j-- ) {
+                                                const Value& value = stack.top( j * 2 - 2 );
+                                                Str          name  = stack.top( j * 2 - 1 ).asCString();
                                                 AVM2_VERBOSE( "%s:%s ", name.c_str(), value.asCString() );
                                                 instance->set_member( name, value );
                                             }
+                                            stack.drop( i->ArgCount * 2 );
                                             AVM2_VERBOSE( ")\n" );
 
                                             stack.push( instance, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NewArray:              {
+            AvmCase( NewArray ):        {
                                             AVM2_VERBOSE( "%s : ", opCode );
 
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
                                             Array* instance = new Array( m_domain );
                                             for( int i = 0, n = args.count(); i < n; i++ ) {
@@ -426,47 +716,47 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             stack.push( instance, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NewClass:              {
-                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i.Class->to_string() );
+            AvmCase( NewClass ):        {
+                                            AVM2_VERBOSE( "%s : '%s'\n", opCode, i->Class->to_string() );
                                             Class* super = cast_to<Class>( stack.top(0).asObject() );
                                             UNUSED(super);
                                             stack.pop();
 
-                                            Class* cls = i.Class;
+                                            Class* cls = i->Class;
                                             cls->initialize();
                                             stack.push( cls, opCode );
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NewActivation:         AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( NewActivation ):   AVM2_VERBOSE( "%s\n", opCode );
                                         stack.push( new ActivationScope( m_domain, function->traits() ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case NewCatch:              AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( NewCatch ):        AVM2_VERBOSE( "%s\n", opCode );
                                         stack.push( new CatchScope( m_domain, function->traits() ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case NewFunction:           {
+            AvmCase( NewFunction ):     {
                                             AVM2_VERBOSE( "%s\n", opCode );
                                             AVM2_DEBUG_ONLY( dumpScopeStack( "scope", scopeStack ) );
-                                            FunctionScript* function = cast_to<FunctionScript>( const_cast<Function*>( i.Function ) );
-                                            stack.push( ( Object* )new FunctionWithScope( m_domain, function, scopeStack ), opCode );
+                                            FunctionScript* function = cast_to<FunctionScript>( const_cast<Function*>( i->Function ) );
+                                            stack.push( ( Object* )new FunctionWithScope( m_domain, function, scopeStack.capture() ), opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case Construct:             {
+            AvmCase( Construct ):       {
                                             AVM2_VERBOSE( "%s : \n", opCode );
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
                                             Value value = stack.pop();
 
-                                            if( !value.isFunction() ) {
+                                            if( !( i->flags & Instruction::CalleeIsFunction ) && !value.isFunction() ) {
                                                 AvmTypeError( "Instantiation attempted on a non-constructor." );
                                             }
 
@@ -476,31 +766,31 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             stack.push( result );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
                 
-            case ConstructProp:         {
-                                            AVM2_VERBOSE( "%s : %s at %s ", opCode, i.Identifier->name().c_str(), stack.top( i.ArgCount ).asCString() );
+            AvmCase( ConstructProp ):   {
+                                            AVM2_VERBOSE( "%s : %s at %s ", opCode, i->Identifier->name().c_str(), stack.top( i->ArgCount ).asCString() );
 
                                             // ** Get the arguments
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
                                             // ** Resolve property
-                                            bool resolved = resolveProperty( object, value, i.Identifier, frame );
+                                            bool resolved = resolveProperty( object, value, i->Identifier, i->cache, frame );
 
-                                            if( object.isNullOrUndefined() ) {
-                                                AvmTypeError( "%s, cannot access a property or method of a null object reference.", i.Identifier->name().c_str() );
+                                            if( !( i->flags & Instruction::NonNullReceiver ) && object.isNullOrUndefined() ) {
+                                                AvmTypeError( "%s, cannot access a property or method of a null object reference.", i->Identifier->name().c_str() );
                                             }
 
                                             if( value.isNullOrUndefined() ) {
-                                                AvmTypeError( "%s, instantiation attempted on a non-constructor.", i.Identifier->name().c_str() );
+                                                AvmTypeError( "%s, instantiation attempted on a non-constructor.", i->Identifier->name().c_str() );
                                             }
 
                                             if( !resolved ) {
-                                                AvmReferenceError( "Property %s not found on %s and could not be called.\n", i.Identifier->name().c_str(), object.type() );
+                                                AvmReferenceError( "Property %s not found on %s and could not be called.\n", i->Identifier->name().c_str(), object.type() );
                                             }
 
                                             // ** Construct
-                                            if( i.Identifier->name() == "Number" ) {
+                                            if( i->Identifier->name() == "Number" ) {
                                                 stack.push( args.count() ? args.values()[0].asNumber() : 0 );
                                             } else {
                                                 Class* cls      = cast_to<Class>( value.asObject() );
@@ -513,18 +803,18 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
                 
-            case ConstructSuper:        {
-                                            AVM2_VERBOSE( "%s : %s (args %d)\n", opCode, stack.top( i.ArgCount ).asCString(), i.ArgCount );
+            AvmCase( ConstructSuper ):  {
+                                            AVM2_VERBOSE( "%s : %s (args %d)\n", opCode, stack.top( i->ArgCount ).asCString(), i->ArgCount );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                 
-                                            const Value& obj = stack.top( i.ArgCount );
-                                            if( obj.isNullOrUndefined() ) {
+                                            const Value& obj = stack.top( i->ArgCount );
+                                            if( !( i->flags & Instruction::NonNullReceiver ) && obj.isNullOrUndefined() ) {
                                                 AvmTypeError( "cannot access a property or method of a null object reference." );
                                             }
 
-                                            stack.arguments( args, i.ArgCount );
+                                            stack.arguments( args, i->ArgCount );
 
                                             if( Class* superClass = cast_to<Class>( m_function->m_super.get() ) ) {
                                                 superClass->construct( obj, args, frame );
@@ -532,47 +822,56 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
             // ----------------------------------------------- Type coercion --------------------------------------------- //
                 
-            case Coerce:                AVM2_VERBOSE( "%s : to %s\n", opCode, i.Identifier->name().c_str() );
-                                        break;
+            AvmCase( Coerce ):          AVM2_VERBOSE( "%s : to %s\n", opCode, i->Identifier->name().c_str() );
+                                        AvmNext;
                 
-            case CoerceToAny:           AVM2_VERBOSE( "%s : to *\n", opCode );
-                                        break;
+            AvmCase( CoerceToAny ):     AVM2_VERBOSE( "%s : to *\n", opCode );
+                                        AvmNext;
+
+            AvmCase( ConvertToInt ):    AVM2_VERBOSE( "%s : %s = %d\n", opCode, stack.top().asCString(), stack.top().asInt() );
+                                        if( !( i->flags & Instruction::ValueHasType ) ) {
+                                            stack.push( Value( stack.pop().asInt() ), opCode );
+                                        }
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        AvmNext;
 
-            case ConvertToInt:          AVM2_VERBOSE( "%s : %s = %d\n", opCode, stack.top().asCString(), stack.top().asInt() );
-                                        stack.push( Value( (double)stack.pop().asInt() ), opCode );
+            AvmCase( ConvertToUInt ):   AVM2_VERBOSE( "%s : %s = %u\n", opCode, stack.top().asCString(), stack.top().asUInt() );
+                                        if( !( i->flags & Instruction::ValueHasType ) ) {
+                                            stack.push( Value( stack.pop().asUInt() ), opCode );
+                                        }
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case ConvertToBool:         AVM2_VERBOSE( "%s : %s = %d\n", opCode, stack.top().asCString(), stack.top().asBool() );
+            AvmCase( ConvertToBool ):   AVM2_VERBOSE( "%s : %s = %d\n", opCode, stack.top().asCString(), stack.top().asBool() );
                                         stack.push( Value( stack.pop().asBool() ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case ConvertToString:       AVM2_VERBOSE( "%s : %s = %s\n", opCode, stack.top().asCString(), stack.top().asCString() );
+            AvmCase( ConvertToString ): AVM2_VERBOSE( "%s : %s = %s\n", opCode, stack.top().asCString(), stack.top().asCString() );
                                         stack.push( Value( stack.pop().asCString() ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case ConvertToDouble:       AVM2_VERBOSE( "%s : %s = %f\n", opCode, stack.top().asCString(), stack.top().asNumber() );
+            AvmCase( ConvertToDouble ): AVM2_VERBOSE( "%s : %s = %f\n", opCode, stack.top().asCString(), stack.top().asNumber() );
                                         stack.push( Value( stack.pop().asNumber() ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case InstanceOf:
-            case IsTypeLate:            {
+            AvmCase( InstanceOf ):
+            AvmCase( IsTypeLate ):      {
                                             AVM2_VERBOSE( "%s : %s is %s\n", opCode, stack.top(1).asCString(), stack.top().asCString() );
                                             Class* type  = cast_to<Class>( stack.pop().asObject() );
                                             Value  value = stack.pop();
                                             stack.push( isType( value, type ), opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case TypeOf:                {
+            AvmCase( TypeOf ):          {
                                             AVM2_VERBOSE( "%s : %s is %s\n", opCode, stack.top().asCString(), stack.top().type() );
                                             value = stack.pop();
                                             switch( value.typeId() ) {
@@ -590,222 +889,315 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case ApplyType:             {
-                                            AVM2_VERBOSE( "%s : args %d\n", opCode, i.ArgCount );
-                                            assert( i.ArgCount == 1 );
+            AvmCase( ApplyType ):       {
+                                            AVM2_VERBOSE( "%s : args %d\n", opCode, i->ArgCount );
+                                            assert( i->ArgCount == 1 );
                                             value = stack.pop();
 
                                             stack.push( m_domain->findClass( "Vector" ), opCode );
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
             // -------------------------------------------- Operand stack ------------------------------------------- //
 
-            case PushNull:              AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( PushNull ):        AVM2_VERBOSE( "%s\n", opCode );
                                         stack.push( Value::null );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case PushByte:              AVM2_VERBOSE( "%s : %d\n", opCode, i.Integer );
-                                        stack.push( Value( i.Integer ), opCode );
+            AvmCase( PushByte ):        AVM2_VERBOSE( "%s : %d\n", opCode, i->Integer );
+                                        stack.push( Value( i->Integer ), opCode );
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        AvmNext;
+
+            AvmCase( PushInt ):         AVM2_VERBOSE( "%s : %d\n", opCode, i->Integer );
+                                        stack.push( Value( i->Integer ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case PushInt:               AVM2_VERBOSE( "%s : %d\n", opCode, i.Integer );
-                                        stack.push( Value( i.Integer ), opCode );
+            AvmCase( PushUInt ):        AVM2_VERBOSE( "%s : %u\n", opCode, i->UInt );
+                                        stack.push( Value( i->UInt ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case PushDouble:            AVM2_VERBOSE( "%s : %f\n", opCode, i.Number );
-                                        stack.push( Value( i.Number ), opCode );
+            AvmCase( PushDouble ):      AVM2_VERBOSE( "%s : %f\n", opCode, i->Number );
+                                        stack.push( Value( i->Number ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case PushShort:             AVM2_VERBOSE( "%s : %d\n", opCode, i.Integer );
-                                        stack.push( Value( i.Integer ), opCode );
-                                        break;
+            AvmCase( PushShort ):       AVM2_VERBOSE( "%s : %d\n", opCode, i->Integer );
+                                        stack.push( Value( i->Integer ), opCode );
+                                        AvmNext;
                 
-            case PushString:            AVM2_VERBOSE( "%s : %s\n", opCode, i.Str->toCString() );
-                                        stack.push( Value( ( Object* )i.Str ), opCode );
+            AvmCase( PushString ):      AVM2_VERBOSE( "%s : %s\n", opCode, i->Str->toCString() );
+                                        stack.push( Value( ( Object* )i->Str ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case PushTrue:              AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( PushTrue ):        AVM2_VERBOSE( "%s\n", opCode );
                                         stack.push( Value( true ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case PushFalse:             AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( PushFalse ):       AVM2_VERBOSE( "%s\n", opCode );
                                         stack.push( Value( false ), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case PushUndefined:         AVM2_VERBOSE( "%s\n",opCode );
+            AvmCase( PushUndefined ):   AVM2_VERBOSE( "%s\n",opCode );
                                         stack.push( Value::undefined );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
                 
-            case Pop:                   AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( Pop ):             AVM2_VERBOSE( "%s\n", opCode );
                                         stack.pop();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case Dup:                   AVM2_VERBOSE( "%s : %s\n", opCode, stack.top().asCString() );
+            AvmCase( Dup ):             AVM2_VERBOSE( "%s : %s\n", opCode, stack.top().asCString() );
                                         stack.push( stack.top(), opCode );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case Swap:                  AVM2_VERBOSE( "%s\n", opCode );
+            AvmCase( Swap ):            AVM2_VERBOSE( "%s\n", opCode );
                                         stack.swap();
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
             // --------------------------------------------- Arithmetic -------------------------------------------- //
                 
-            case Add:                   {
+            AvmCase( Add ):             {
                                             AVM2_VERBOSE( "%s : %s + %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
                                             Value b = stack.pop();
                                             Value a = stack.pop();
                                             stack.push( Value::add( m_domain, a, b ) );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case Subtract:              {
+            AvmCase( Subtract ):        {
                                             AVM2_VERBOSE( "%s : %s - %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
-                                            Value a = stack.pop();
                                             Value b = stack.pop();
-                                            stack.push( b.asNumber() - a.asNumber() );
-                                            AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        }
-                                        break;
-
-            case Negate:                {
-                                            AVM2_VERBOSE( "%s : -%s\n", opCode, stack.top( 0 ).asCString() );
-                                            stack.push( -stack.pop().asNumber() );
+                                            Value a = stack.pop();
+                                            stack.push( Value::subtract( a, b ) );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NegateI:               {
+            AvmCase( Negate ):          {
                                             AVM2_VERBOSE( "%s : -%s\n", opCode, stack.top( 0 ).asCString() );
-                                            stack.push( -stack.pop().asInt() );
+                                            stack.push( Value::negate( stack.pop() ) );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case Multiply:              {
+            AvmCase( Multiply ):        {
                                             AVM2_VERBOSE( "%s : %s * %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
-                                            double b = stack.pop().asNumber();
-                                            double a = stack.pop().asNumber();
-                                            stack.push( a * b );
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            stack.push( Value::multiply( a, b ) );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
+
+            AvmCase( Increment ):       AVM2_VERBOSE( "%s : %s++\n", opCode, stack.top().asCString() );
+                                        stack.push( Value::increment( stack.pop(), 1 ) );
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        AvmNext;
+
+            AvmCase( Decrement ):       AVM2_VERBOSE( "%s : %s--\n", opCode, stack.top().asCString() );
+                                        stack.push( Value::increment( stack.pop(), -1 ) );
+                                        AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        AvmNext;
 
-            case IncrementI:            AVM2_VERBOSE( "%s : %s++\n", opCode, stack.top().asCString() );
-                                        stack.push( Value( double( stack.pop().asInt() + 1 ) ) );
+            AvmCase( IncLocal ):        AVM2_VERBOSE( "%s : local[%d]++\n", opCode, i->Integer );
+                                        registers[i->Integer] = Value::increment( registers[i->Integer], 1 );
+                                        AvmNext;
+
+            AvmCase( DecLocal ):        AVM2_VERBOSE( "%s : local[%d]--\n", opCode, i->Integer );
+                                        registers[i->Integer] = Value::increment( registers[i->Integer], -1 );
+                                        AvmNext;
+
+            // ** Int opcodes wrap around instead of overflowing to a double
+            AvmCase( AddI ):            AVM2_VERBOSE( "%s : %d + %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( + );
+                                        AvmNext;
+
+            AvmCase( SubtractI ):       AVM2_VERBOSE( "%s : %d - %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( - );
+                                        AvmNext;
+
+            AvmCase( MultiplyI ):       AVM2_VERBOSE( "%s : %d * %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( * );
+                                        AvmNext;
+
+            AvmCase( NegateI ):         AVM2_VERBOSE( "%s : -%d\n", opCode, stack.top( 0 ).asInt() );
+                                        stack.push( int( 0u - Uint32( stack.pop().asInt() ) ) );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case Increment:             AVM2_VERBOSE( "%s : %s++\n", opCode, stack.top().asCString() );
-                                        stack.push( Value( double( stack.pop().asNumber() + 1 ) ) );
+            AvmCase( IncrementI ):      AVM2_VERBOSE( "%s : %s++\n", opCode, stack.top().asCString() );
+                                        stack.push( int( Uint32( stack.pop().asInt() ) + 1 ) );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case Decrement:             AVM2_VERBOSE( "%s : %s--\n", opCode, stack.top().asCString() );
-                                        stack.push( Value( double( stack.pop().asNumber() - 1 ) ) );
+            AvmCase( DecrementI ):      AVM2_VERBOSE( "%s : %s--\n", opCode, stack.top().asCString() );
+                                        stack.push( int( Uint32( stack.pop().asInt() ) - 1 ) );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
 
-            case StrictEquals:
-            case Equals:                AVM2_VERBOSE( "%s : %s == %s\n", opCode, stack.top(0).asCString(), stack.top(1).asCString() );
-                                        stack.push( Value::compare( stack.pop(), stack.pop() ) );
+            AvmCase( IncLocalI ):       AVM2_VERBOSE( "%s : local[%d]++\n", opCode, i->Integer );
+                                        registers[i->Integer] = int( Uint32( registers[i->Integer].asInt() ) + 1 );
+                                        AvmNext;
+
+            AvmCase( DecLocalI ):       AVM2_VERBOSE( "%s : local[%d]--\n", opCode, i->Integer );
+                                        registers[i->Integer] = int( Uint32( registers[i->Integer].asInt() ) - 1 );
+                                        AvmNext;
+
+            // ---------------------------------------------- Bitwise ------------------------------------------------ //
+
+            AvmCase( BitAnd ):          AVM2_VERBOSE( "%s : %d & %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( & );
+                                        AvmNext;
+
+            AvmCase( BitOr ):           AVM2_VERBOSE( "%s : %d | %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( | );
+                                        AvmNext;
+
+            AvmCase( BitXOR ):          AVM2_VERBOSE( "%s : %d ^ %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                        AvmIntBinary( ^ );
+                                        AvmNext;
+
+            AvmCase( BitNot ):          AVM2_VERBOSE( "%s : ~%d\n", opCode, stack.top( 0 ).asInt() );
+                                        stack.push( ~stack.pop().asInt() );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
+
+            AvmCase( LeftShift ):       {
+                                            AVM2_VERBOSE( "%s : %d << %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                            Uint32 b = stack.pop().asUInt() & 31;
+                                            Uint32 a = stack.pop().asUInt();
+                                            stack.push( int( a << b ) );
+                                            AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RightShift ):      {
+                                            AVM2_VERBOSE( "%s : %d >> %d\n", opCode, stack.top( 1 ).asInt(), stack.top( 0 ).asInt() );
+                                            Uint32 b = stack.pop().asUInt() & 31;
+                                            int    a = stack.pop().asInt();
+                                            stack.push( a >> b );
+                                            AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        }
+                                        AvmNext;
+
+            AvmCase( URightShift ):     {
+                                            AVM2_VERBOSE( "%s : %u >>> %d\n", opCode, stack.top( 1 ).asUInt(), stack.top( 0 ).asInt() );
+                                            Uint32 b = stack.pop().asUInt() & 31;
+                                            Uint32 a = stack.pop().asUInt();
+                                            stack.push( Value( a >> b ) );
+                                            AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
+                                        }
+                                        AvmNext;
+
+            // --------------------------------------------- Comparison -------------------------------------------- //
 
-            case BitOr:                 AVM2_VERBOSE( "%s : %d | %d\n", opCode, stack.top(0).asInt(), stack.top(1).asInt() );
-                                        stack.push( stack.pop().asInt() | stack.pop().asInt() );
+            AvmCase( StrictEquals ):
+            AvmCase( Equals ):          AVM2_VERBOSE( "%s : %s == %s\n", opCode, stack.top(0).asCString(), stack.top(1).asCString() );
+                                        stack.push( Value::compare( stack.pop(), stack.pop() ) );
                                         AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                        break;
+                                        AvmNext;
+
+            AvmCase( LessThan ):        AVM2_VERBOSE( "%s : %s < %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                        AvmCompare( Value::less( a, b ) );
+                                        AvmNext;
+
+            AvmCase( LessEquals ):      AVM2_VERBOSE( "%s : %s <= %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                        AvmCompare( Value::lessEqual( a, b ) );
+                                        AvmNext;
+
+            AvmCase( GreaterThan ):     AVM2_VERBOSE( "%s : %s > %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                        AvmCompare( Value::less( b, a ) );
+                                        AvmNext;
+
+            AvmCase( GreaterEquals ):   AVM2_VERBOSE( "%s : %s >= %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                        AvmCompare( Value::lessEqual( b, a ) );
+                                        AvmNext;
 
             // ----------------------------------------------- Object iteration ----------------------------------------------- //
 
-            case In:                    {
+            AvmCase( In ):              {
                                             AVM2_VERBOSE( "%s : %s %s\n", opCode, stack.top(0).asCString(), stack.top(1).asCString() );
 
                                             object    = stack.pop();
                                             Value key = stack.pop();
 
                                             if( Object* instance = object.asObject() ) {
-                                                stack.push( instance->hasOwnProperty( key.asString() ), opCode );
+                                                stack.push( instance->hasOwnProperty( key.asStringCopy() ), opCode );
                                             } else {
                                                 stack.push( false );
                                             }
 
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case HasNext2:              {
-                                            AVM2_VERBOSE( "%s : %s %s\n", opCode, registers[i.objectReg].asCString(), registers[i.indexReg].asCString() );
+            AvmCase( HasNext2 ):        {
+                                            AVM2_VERBOSE( "%s : %s %s\n", opCode, registers[i->objectReg].asCString(), registers[i->indexReg].asCString() );
 
-                                            Object* object = registers[i.objectReg].asObject();
-                                            Value&  index  = registers[i.indexReg];
+                                            Object* object = registers[i->objectReg].asObject();
+                                            Value&  index  = registers[i->indexReg];
 
                                             if( object == NULL ) {
                                                 stack.push( false, opCode );
                                                 AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
-                                                continue;
+                                                AvmNext;
                                             }
 
-                                            IteratorPtr it = object->createIterator( index );
+                                            // ** The index register holds an integer cursor into the object's property storage
+                                            int next = object->nextIndex( index.asInt() );
 
-                                            if( it->hasNext() ) {
-                                                index = it->key();
-                                                stack.push( true, opCode );
-                                            } else {
-                                                stack.push( false, opCode );
-                                            }
+                                            index = next;
+                                            stack.push( next != 0, opCode );
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NextValue:             {
+            AvmCase( NextValue ):       {
                                             AVM2_VERBOSE( "%s : %s %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
                                             Value index = stack.pop();
                                             object      = stack.pop().asObject();
 
                                             if( Object* instance = object.asObject() ) {
-                                                stack.push( instance->getPropertyByKey( index ) );
+                                                stack.push( instance->valueAt( index.asInt() ) );
                                             } else {
                                                 stack.push( Value() );
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case NextName:              {
+            AvmCase( NextName ):        {
                                             AVM2_VERBOSE( "%s : %s %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
 
                                             Value index = stack.pop();
                                             object      = stack.pop();
 
                                             if( Object* instance = object.asObject() ) {
-                                                stack.push( instance->nextKey( index ), opCode );
+                                                stack.push( instance->nameAt( index.asInt() ), opCode );
                                             } else {
                                                 stack.push( Value::undefined );
                                             }
                                             AVM2_DEBUG_ONLY( dumpStack( "operand", stack ) );
                                         }
-                                        break;
+                                        AvmNext;
 
-            case DeleteProperty:        {
-                                            AVM2_VERBOSE( "%s : %s\n", opCode, i.Identifier->name().c_str() );
+            AvmCase( DeleteProperty ):  {
+                                            AVM2_VERBOSE( "%s : %s\n", opCode, i->Identifier->name().c_str() );
 
                                             object = stack.pop();
 
@@ -814,138 +1206,314 @@ void Avm::execute( const FunctionScript* function, Frame* frame )
                                             }
 
                                             if( Object* instance = object.asObject() ) {
-                                                stack.push( instance->deletePropertyByName( i.Identifier->name().c_str() ), opCode );
+                                                stack.push( instance->deletePropertyByName( i->Identifier->name().c_str() ), opCode );
                                             } else {
                                                 stack.push( false, opCode );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
             // ---------------------------------------------- Branching ----------------------------------------------- //
 
-            case Label: break;
+            AvmCase( Label ):           AvmNext;
 
                 
-            case Jump:                  AVM2_VERBOSE( "%s : %d\n", opCode, i.offset );
-                                        op = i.offset;
-                                        break;
+            AvmCase( Jump ):            AVM2_VERBOSE( "%s : %d\n", opCode, i->offset );
+                                        AvmBranch( i->offset );
+                                        AvmNext;
 
-            case IfTrue:                {
+            AvmCase( IfTrue ):          {
                                             AVM2_VERBOSE( "%s : %s\n", opCode, stack.top( 0 ).asCString() );
                                             if( stack.pop().asBool() ) {
-                                                op = i.offset;
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfLess:                {
+            AvmCase( IfLess ):          {
                                             AVM2_VERBOSE( "%s : %s < %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
-                                            bool le = stack.pop().asNumber() <= stack.pop().asNumber();
-                                            if( le == false ) {
-                                                op = i.offset;
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            if( !Value::lessEqual( b, a ) ) {
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfNotLessEqual:        // TODO: This appears to have the same effect as ifgt, however, their handling of NaN is different.
-            case IfGreater:             {
+            AvmCase( IfNotLessEqual ):  // TODO: This appears to have the same effect as ifgt, however, their handling of NaN is different.
+            AvmCase( IfGreater ):       {
                                             AVM2_VERBOSE( "%s : %s > %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
-                                            double v2 = stack.pop().asNumber();
-                                            double v1 = stack.pop().asNumber();
+                                            Value v2 = stack.pop();
+                                            Value v1 = stack.pop();
 
-                                            if( v1 > v2 ) {
-                                                op = i.offset;
+                                            if( Value::less( v2, v1 ) ) {
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfLessEqual:           {
+            AvmCase( IfLessEqual ):     {
                                             AVM2_VERBOSE( "%s : %s <= %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
-                                            double v2 = stack.pop().asNumber();
-                                            double v1 = stack.pop().asNumber();
+                                            Value v2 = stack.pop();
+                                            Value v1 = stack.pop();
 
-                                            if( v1 <= v2 ) {
-                                                op = i.offset;
+                                            if( Value::lessEqual( v1, v2 ) ) {
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
 
-            case IfFalse:               {
+            AvmCase( IfFalse ):         {
                                             AVM2_VERBOSE( "%s : %s\n", opCode, stack.top( 0 ).asCString() );
                                             if( stack.pop().asBool() == false ) {
-                                                op = i.offset;
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfStictNotEqual:
-            case IfNotEqual:            {
+            AvmCase( IfStictNotEqual ):
+            AvmCase( IfNotEqual ):      {
                                             AVM2_VERBOSE( "%s : %s != %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
                                             if( stack.pop() != stack.pop() ) {
-                                                op = i.offset;
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfNotGreater:          {
+            AvmCase( IfNotGreater ):    {
                                             AVM2_VERBOSE( "%s : %s <= %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
-                                            double b  = stack.pop().asNumber();
-                                            double a  = stack.pop().asNumber();
-                                            bool   ng = a <= b;
-                                            if( ng ) {
-                                                op = i.offset;
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            if( Value::lessEqual( a, b ) ) {
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case IfNotLess:             {
+            AvmCase( IfNotLess ):       {
                                             AVM2_VERBOSE( "%s : %s <= %s\n", opCode, stack.top( 0 ).asCString(), stack.top( 1 ).asCString() );
-                                            double b  = stack.pop().asNumber();
-                                            double a  = stack.pop().asNumber();
-                                            bool   nl = a >= b;
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            if( Value::lessEqual( b, a ) ) {
+                                                AvmBranch( i->offset );
+                                            }
+                                        }
+                                        AvmNext;
+
+            AvmCase( IfGreaterEqual ):  {
+                                            AVM2_VERBOSE( "%s : %s >= %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            if( Value::lessEqual( b, a ) ) {
+                                                AvmBranch( i->offset );
+                                            }
+                                        }
+                                        AvmNext;
 
-                                            if( nl ) {
-                                                op = i.offset;
+            AvmCase( IfNotGreaterEqual ): {
+                                            AVM2_VERBOSE( "%s : %s < %s\n", opCode, stack.top( 1 ).asCString(), stack.top( 0 ).asCString() );
+                                            Value b = stack.pop();
+                                            Value a = stack.pop();
+                                            if( !Value::lessEqual( b, a ) ) {
+                                                AvmBranch( i->offset );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
 
-            case LookupSwitch:          {
+            AvmCase( LookupSwitch ):    {
                                             AVM2_VERBOSE( "%s : %d\n", opCode, stack.top().asInt() );
                                             int index = stack.pop().asInt();
                 
-                                            if( index >= 0 && index < i.caseCount ) {
-                                                op = i.caseOffsets[index];
+                                            if( index >= 0 && index <= i->caseCount ) {
+                                                AvmBranch( i->caseOffsets[index] );
                                             } else {
-                                                op = i.defaultOffset - 1;
+                                                AvmBranch( i->defaultOffset - 1 );
                                             }
                                         }
-                                        break;
+                                        AvmNext;
                 
-            case DebugFile:             debugFile = i.Str->toCString();
-                                        break;
+            AvmCase( DebugFile ):       debugFile = i->Str->toCString();
+                                        AvmNext;
                 
-            case DebugLine:             debugLine = i.line;
-                                        break;
+            AvmCase( DebugLine ):       debugLine = i->line;
+                                        AvmNext;
 
-            case Debug:                 break;
+            AvmCase( Debug ):           AvmNext;
                 
-            case Throw:                 {
+            AvmCase( Throw ):           {
                                             AVM2_VERBOSE( "%s : %s\n", opCode, stack.top().asCString() );
                                             frame->throwException( stack.pop() );
                                             AvmHandleException( frame );
                                         }
-                                        break;
+                                        AvmNext;
+
+            // ---------------------------------------------- Registers ----------------------------------------------- //
+
+            AvmCase( RegMove ):         AVM2_VERBOSE( "%s : r%d = r%d (%s)\n", opCode, i->dst, i->lhs, AvmOperand( i->lhs ).asCString() );
+                                        registers[i->dst] = AvmOperand( i->lhs );
+                                        AvmNext;
+
+            AvmCase( RegAdd ):          AVM2_VERBOSE( "%s : r%d = %s + %s\n", opCode, i->dst, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        registers[i->dst] = Value::add( m_domain, AvmOperand( i->lhs ), AvmOperand( i->rhs ) );
+                                        AvmNext;
+
+            AvmCase( RegSubtract ):     AVM2_VERBOSE( "%s : r%d = %s - %s\n", opCode, i->dst, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        registers[i->dst] = Value::subtract( AvmOperand( i->lhs ), AvmOperand( i->rhs ) );
+                                        AvmNext;
+
+            AvmCase( RegMultiply ):     AVM2_VERBOSE( "%s : r%d = %s * %s\n", opCode, i->dst, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        registers[i->dst] = Value::multiply( AvmOperand( i->lhs ), AvmOperand( i->rhs ) );
+                                        AvmNext;
+
+            AvmCase( RegIncrement ):    AVM2_VERBOSE( "%s : r%d = %s + 1\n", opCode, i->dst, AvmOperand( i->lhs ).asCString() );
+                                        registers[i->dst] = Value::increment( AvmOperand( i->lhs ), 1 );
+                                        AvmNext;
+
+            AvmCase( RegIncrementI ):   AVM2_VERBOSE( "%s : r%d = %s + 1\n", opCode, i->dst, AvmOperand( i->lhs ).asCString() );
+                                        registers[i->dst] = int( Uint32( AvmOperand( i->lhs ).asInt() ) + 1 );
+                                        AvmNext;
+
+            AvmCase( RegDecrement ):    AVM2_VERBOSE( "%s : r%d = %s - 1\n", opCode, i->dst, AvmOperand( i->lhs ).asCString() );
+                                        registers[i->dst] = Value::increment( AvmOperand( i->lhs ), -1 );
+                                        AvmNext;
+
+            AvmCase( RegIfLess ):       AVM2_VERBOSE( "%s : %s < %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( !Value::lessEqual( AvmOperand( i->rhs ), AvmOperand( i->lhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfGreater ):    AVM2_VERBOSE( "%s : %s > %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( Value::less( AvmOperand( i->rhs ), AvmOperand( i->lhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfLessEqual ):  AVM2_VERBOSE( "%s : %s <= %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( Value::lessEqual( AvmOperand( i->lhs ), AvmOperand( i->rhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfNotLess ):    AVM2_VERBOSE( "%s : %s >= %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( Value::lessEqual( AvmOperand( i->rhs ), AvmOperand( i->lhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfNotEqual ):   AVM2_VERBOSE( "%s : %s != %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( AvmOperand( i->lhs ) != AvmOperand( i->rhs ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
 
-            default:        printf( "AVM::ExecuteMethod : unhandled instruction %s(0x%x)\n", opCode, i.opCode );
-                            assert( false );
+            AvmCase( RegIfTrue ):       AVM2_VERBOSE( "%s : %s\n", opCode, AvmOperand( i->lhs ).asCString() );
+                                        if( AvmOperand( i->lhs ).asBool() ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfFalse ):      AVM2_VERBOSE( "%s : %s\n", opCode, AvmOperand( i->lhs ).asCString() );
+                                        if( AvmOperand( i->lhs ).asBool() == false ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegPushScope ):    AVM2_VERBOSE( "%s : %s\n", opCode, AvmOperand( i->lhs ).asCString() );
+                                        scopeStack.push( AvmOperand( i->lhs ).asObject(), opCode );
+                                        AVM2_DEBUG_ONLY( dumpScopeStack( "scope", scopeStack ) );
+                                        AvmNext;
+
+            AvmCase( RegGetProperty ):  {
+                                            AVM2_VERBOSE( "%s : r%d = '%s' at %s\n", opCode, i->dst, i->Identifier->name().c_str(), AvmOperand( i->lhs ).asCString() );
+
+                                            object = AvmOperand( i->lhs );
+                                            lookupProperty( object, value, i->Identifier, i->cache, !( i->flags & Instruction::UnboundCallee ) );
+
+                                            if( !( i->flags & Instruction::NonNullReceiver ) ) {
+                                                if( object.isNull() ) {
+                                                    AvmTypeError( "Cannot access a property or method of a null object reference." );
+                                                }
+
+                                                if( object.isUndefined() ) {
+                                                    AvmTypeError( "A term is undefined and has no properties." );
+                                                }
+                                            }
+
+                                            registers[i->dst] = value;
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfEquals ):     AVM2_VERBOSE( "%s : %s == %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( Value::compare( AvmOperand( i->lhs ), AvmOperand( i->rhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmCase( RegIfNotEquals ):  AVM2_VERBOSE( "%s : %s != %s\n", opCode, AvmOperand( i->lhs ).asCString(), AvmOperand( i->rhs ).asCString() );
+                                        if( !Value::compare( AvmOperand( i->lhs ), AvmOperand( i->rhs ) ) ) {
+                                            AvmBranch( i->offset );
+                                        }
+                                        AvmNext;
+
+            AvmDefault: printf( "AVM::ExecuteMethod : unhandled instruction %s(0x%x)\n", Dump::formatOpCode( i->opCode ), i->opCode );
+                        assert( false );
+                        AvmNext;
         }
-        
-        AVM2_VERBOSE( "\n" );
     }
 }
 
+#if AVM2_JIT
+
+// ** Avm::tierUp
+JitCode Avm::tierUp( const FunctionScript* function, int entry ) const
+{
+    if( !function->m_tieredUp ) {
+        function->m_tieredUp = true;
+
+        if( Jit::compile( function, m_domain->codeArena(), function->m_jitEntries ) ) {
+            function->m_jitEntry = function->m_jitEntries[0];
+        }
+    }
+
+    return function->m_jitEntries.size() ? function->m_jitEntries[entry] : NULL;
+}
+
+// ** Avm::canEnterLoop
+bool Avm::canEnterLoop( const FunctionScript* function, int header ) const
+{
+    if( !function->m_tieredUp ) {
+        return true;
+    }
+
+    return function->m_jitEntries.size() && function->m_jitEntries[header] != NULL;
+}
+
+// ** Avm::enterCompiled
+int Avm::enterCompiled( JitCode code, const FunctionScript* function, Frame* frame, Value* registers, int& runAway )
+{
+    JitContext context;
+    context.m_avm       = this;
+    context.m_domain    = m_domain;
+    context.m_function  = function;
+    context.m_frame     = frame;
+    context.m_registers = registers;
+    context.m_constants = function->m_constants.empty() ? NULL : &function->m_constants[0];
+    context.m_result    = &frame->m_result;
+    context.m_backEdges = &function->m_backEdges[0];
+    context.m_stack     = &frame->m_stack;
+    context.m_scope     = &frame->m_scope;
+    context.m_runAway   = runAway;
+
+    int resume = code( &context );
+    runAway    = context.m_runAway;
+
+    return resume;
+}
+
+#endif  /*  AVM2_JIT    */
+
 // ** Avm::throwError
 void Avm::throwError( Frame* frame, ErrorId errorId, const char *message, ... ) const
 {
@@ -957,31 +1525,33 @@ void Avm::throwError( Frame* frame, ErrorId errorId, const char *message, ... )
 
     char szBuf[kFormatBufferSize];
 
+    // ** The message is formatted once right after its prefix, the stack trace is formatted only if it's read
+    int length = snprintf( szBuf, kFormatBufferSize, "%s: Error #%d: ", errorName[errorId], errorId * 100 );
+
     va_list ap;
     va_start( ap, message );
-    vsnprintf( szBuf, kFormatBufferSize, message, ap );
+    vsnprintf( szBuf + length, kFormatBufferSize - length, message, ap );
     va_end( ap );
 
-    Error* error = Error::create( m_domain, "%s: Error #%d: %s", errorName[errorId], errorId * 100, szBuf );
-    error->setStackTrace( new String( frame->domain(), frame->captureStackTrace() ) );
+    Error* error = new Error( m_domain, new String( m_domain, szBuf ) );
+    error->captureStackTrace( frame, false );
     frame->throwException( error );
 }
 
 // ** Avm::handleException
-bool Avm::handleException( const Exceptions& exceptions, Frame* frame, int& index, const char* opCode ) const
+bool Avm::handleException( const ExceptionTable& exceptions, Frame* frame, int& index, const char* opCode ) const
 {
     Stack&       stack              = frame->m_stack;
     ScopeStack&  scope              = frame->m_scope;
     const Value& exception          = frame->m_exception;
     bool         continueExecution  = false;
 
-    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
-        Exception* e = exceptions[i].get();
+    // ** Only handlers that cover the instruction are checked
+    int                     count    = 0;
+    const Exception* const* handlers = exceptions.find( index, count );
 
-        // ** Check exception bounds
-        if( index < e->from() || index > e->to() ) {
-            continue;
-        }
+    for( int i = 0; i < count; i++ ) {
+        const Exception* e = handlers[i];
 
         // ** Skip finally blocks
         if( e->isFinally() ) {
@@ -1009,18 +1579,30 @@ bool Avm::handleException( const Exceptions& exceptions, Frame* frame, int& inde
 }
 
 // ** Avm::resolveProperty
-bool Avm::resolveProperty( Value& object, Value& value, Name* identifier, Frame* frame, bool needsClosure ) const
+bool Avm::resolveProperty( Value& object, Value& value, Name* identifier, PropertyCache* cache, Frame* frame, bool needsClosure ) const
 {
     Stack& stack = frame->m_stack;
 
+    // ** Runtime names are looked up by a key popped from the stack, a shared name instance is never renamed
     if( identifier->hasRuntimeName() ) {
-        identifier->setName( stack.pop().asString() );
+        Value key = stack.pop();
+        object    = stack.pop();
+
+        return lookupRuntimeProperty( object, value, identifier, key, needsClosure );
     }
 
 //  const Namespace* ns = identifier->hasRuntimeNamespace() ? stack.pop().to_namespace() : NULL;
 
-    // ** Pop object from stack and ensure it's a valid reference
+    // ** Pop object from stack
     object = stack.pop();
+
+    return lookupProperty( object, value, identifier, cache, needsClosure );
+}
+
+// ** Avm::lookupProperty
+bool Avm::lookupProperty( const Value& object, Value& value, Name* identifier, PropertyCache* cache, bool needsClosure ) const
+{
+    // ** Ensure object is a valid reference
     if( object.isNullOrUndefined() ) {
         value = Value::undefined;
         return false;
@@ -1028,12 +1610,66 @@ bool Avm::resolveProperty( Value& object, Value& value, Name* identifier, Frame*
 
     // ** Resolve property
     if( Object* o = object.asObject() ) {
-        if( !o->resolveProperty( identifier, &value ) ) {
+        const Traits*               traits = o->m_traits.get();
+        const PropertyCache::Entry* entry  = cache && traits ? cache->find( traits ) : NULL;
+
+        // ** Methods are found by a dispatch index on any receiver derived from the class that introduced them
+        if( cache && cache->m_base && traits && traits->dispatchBase( cache->m_dispId ) == cache->m_base ) {
+            value = traits->method( cache->m_dispId );
+        }
+        else if( entry && entry->m_slot ) {
+            value = o->m_slots[entry->m_slot];
+        }
+        else if( !o->resolveProperty( identifier, &value ) ) {
             value = Value::undefined;
             return false;
         }
+        else if( cache && traits && !entry ) {
+            int slot   = imax( o->resolveCacheableSlot( identifier ), 0 );
+            int dispId = traits->dispatchId( slot );
+
+            cache->add( traits, slot );
+
+            if( dispId ) {
+                cache->m_base   = traits->dispatchBase( dispId );
+                cache->m_dispId = dispId;
+            }
+        }
+    }
+
+    completeLookup( object, value, needsClosure );
+
+    return true;
+}
+
+// ** Avm::lookupRuntimeProperty
+bool Avm::lookupRuntimeProperty( const Value& object, Value& value, const Name* identifier, const Value& key, bool needsClosure ) const
+{
+    // ** Ensure object is a valid reference
+    if( object.isNullOrUndefined() ) {
+        value = Value::undefined;
+        return false;
     }
 
+    // ** Numeric keys go straight to the element storage without a round trip through a string
+    if( Object* o = object.asObject() ) {
+        int  index;
+        bool found = key.asIndex( &index ) ? o->getElement( identifier, index, &value ) : o->resolveProperty( identifier, key.asStringCopy(), &value );
+
+        if( !found ) {
+            value = Value::undefined;
+            return false;
+        }
+    }
+
+    completeLookup( object, value, needsClosure );
+
+    return true;
+}
+
+// ** Avm::completeLookup
+void Avm::completeLookup( const Value& object, Value& value, bool needsClosure ) const
+{
     if( Property* property = value.asProperty() ) {
         property->get( object, &value );
     }
@@ -1042,8 +1678,6 @@ bool Avm::resolveProperty( Value& object, Value& value, Name* identifier, Frame*
     if( needsClosure ) {
         createClosure( object.asObject(), &value );
     }
-
-    return true;
 }
 
 // ** Avm::isType
@@ -1059,12 +1693,13 @@ bool Avm::isType( const Value& value, const Class* type ) const
 }
 
 // ** Avm::setProperty
-bool Avm::setProperty( Name* identifier, Frame* frame, const Value& value )
+bool Avm::setProperty( Name* identifier, PropertyCache* cache, Frame* frame, const Value& value )
 {
     Stack& stack = frame->m_stack;
 
     if( identifier->hasRuntimeName() ) {
-        identifier->setName( stack.pop().asString() );
+        Value key = stack.pop();
+        return setRuntimeProperty( stack.pop().asObject(), identifier, key, value );
     }
 
 //  const Namespace* ns = identifier->hasRuntimeNamespace() ? stack.pop().to_namespace() : NULL;
@@ -1074,11 +1709,39 @@ bool Avm::setProperty( Name* identifier, Frame* frame, const Value& value )
         return false;
     }
 
+    const Traits*               traits = object->m_traits.get();
+    const PropertyCache::Entry* entry  = cache && traits ? cache->find( traits ) : NULL;
+
+    if( entry && entry->m_slot ) {
+        object->setSlot( entry->m_slot, value );
+        return true;
+    }
+
+    if( cache && traits && !entry ) {
+        cache->add( traits, imax( object->resolveCacheableSlot( identifier ), 0 ) );
+    }
+
     return object->setProperty( identifier, value );
 }
 
+// ** Avm::setRuntimeProperty
+bool Avm::setRuntimeProperty( Object* object, const Name* identifier, const Value& key, const Value& value )
+{
+    if( !object ) {
+        return false;
+    }
+
+    int index;
+
+    if( key.asIndex( &index ) ) {
+        return object->setElement( identifier, index, value );
+    }
+
+    return object->setProperty( identifier, key.asStringCopy(), value );
+}
+
 // ** Avm::findProperty
-Object* Avm::findProperty( Name* identifier, Frame* frame, Value* value, bool needsClosure ) const
+Object* Avm::findProperty( Name* identifier, LexicalCache* cache, Frame* frame, Value* value, bool needsClosure ) const
 {
     Stack&           stack = frame->m_stack;
     ScopeStack&      scope = frame->m_scope;
@@ -1089,8 +1752,40 @@ Object* Avm::findProperty( Name* identifier, Frame* frame, Value* value, bool ne
         identifier->setName( stack.pop().asString() );
     }
 
+    // ** Runtime names change with each lookup, so they are never cached
+    if( identifier->hasRuntimeName() || identifier->hasRuntimeNamespace() ) {
+        cache = NULL;
+    }
+
+    // ** Load the value from the scope that held the name last time
+    if( cache && isLexicalCacheHit( cache, scope ) ) {
+        Object* object = cache->m_level >= 0 ? scope.at( cache->m_level ) : cache->m_object;
+
+        if( value ) {
+            if( cache->m_slot ) {
+                *value = object->slot( cache->m_slot );
+            }
+            else if( object == m_domain->global() ) {
+                *value = cache->m_value;
+            }
+            else {
+                object->resolveProperty( identifier, value );
+            }
+
+            if( needsClosure ) {
+                createClosure( object, value );
+            }
+        }
+
+        return object;
+    }
+
     // ** Search inside the scope stack
     if( Object* object = scope.find( identifier, value ) ) {
+        if( cache ) {
+            fillLexicalCache( cache, scope, object, identifier, value );
+        }
+
         if( needsClosure ) {
             createClosure( object, value );
         }
@@ -1102,12 +1797,73 @@ Object* Avm::findProperty( Name* identifier, Frame* frame, Value* value, bool ne
     GlobalObject* global = m_domain->global();
 
     if( global->resolveProperty( identifier, value ) ) {
+        if( cache ) {
+            fillLexicalCache( cache, scope, global, identifier, value );
+        }
+
         return global;
     }
 
     return NULL;
 }
 
+// ** Avm::isLexicalCacheHit
+bool Avm::isLexicalCacheHit( const LexicalCache* cache, const ScopeStack& scope ) const
+{
+    if( cache->m_epoch != m_domain->bindingEpoch() || cache->m_outer != scope.outer() || cache->m_depth != scope.size() ) {
+        return false;
+    }
+
+    for( int i = 0; i < cache->m_depth; i++ ) {
+        Object* object = scope.at( i );
+
+        if( object != cache->m_keys[i] && scopeKey( object ) != cache->m_keys[i] ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// ** Avm::fillLexicalCache
+void Avm::fillLexicalCache( LexicalCache* cache, const ScopeStack& scope, Object* object, const Name* identifier, const Value* value ) const
+{
+    int depth = scope.size();
+
+    if( depth > LexicalCache::MaxLevels ) {
+        return;
+    }
+
+    cache->m_epoch  = m_domain->bindingEpoch();
+    cache->m_outer  = scope.outer();
+    cache->m_depth  = depth;
+    cache->m_level  = -1;
+    cache->m_object = object;
+    cache->m_slot   = imax( object->resolveCacheableSlot( identifier ), 0 );
+    cache->m_value  = value && !cache->m_slot ? *value : Value::undefined;
+
+    // ** The topmost frame scope is the one that was searched first
+    for( int i = depth - 1; i >= 0; i-- ) {
+        cache->m_keys[i] = scopeKey( scope.at( i ) );
+
+        if( cache->m_level < 0 && scope.at( i ) == object ) {
+            cache->m_level  = i;
+            cache->m_object = NULL;
+        }
+    }
+}
+
+// ** Avm::scopeKey
+const void* Avm::scopeKey( const Object* scope )
+{
+    // ** Instances of a sealed class with the same traits resolve the same names
+    if( scope && scope->type() && scope->type()->isSealed() && scope->traits() ) {
+        return scope->traits();
+    }
+
+    return scope;
+}
+
 // ** Avm::createClosure
 void Avm::createClosure( Object *instance, Value *value ) const
 {
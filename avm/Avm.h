@@ -31,10 +31,14 @@
 #include "Instructions.h"
 #include "Exception.h"
 
+//! Number of backward branches a single call may take before it's considered a runaway loop.
+#define AvmRunAwayLimit             (1000000)
+
 namespace avm2
 {
     // ** class Avm
     class Avm {
+    friend struct JitHelpers;
     public:
 
         // ** enum ErrorId
@@ -55,24 +59,44 @@ namespace avm2
 
         void                    execute( const FunctionScript* function, Frame* frame );
 
+        //! Binds each instruction to its handler inside Avm::execute, called by Linker once per function.
+        static void             resolveHandlers( Instructions& instructions );
+
         static void             dumpStack( const char* id, const Stack& stack );
         static void             dumpScopeStack( const char* id, const ScopeStack& stack );
 
     private:
 
-        bool                    resolveProperty( Value& object, Value& value, Name* identifier, Frame* frame, bool needsClosure = false ) const;
+        bool                    resolveProperty( Value& object, Value& value, Name* identifier, PropertyCache* cache, Frame* frame, bool needsClosure = false ) const;
+        bool                    lookupProperty( const Value& object, Value& value, Name* identifier, PropertyCache* cache, bool needsClosure ) const;
+        bool                    lookupRuntimeProperty( const Value& object, Value& value, const Name* identifier, const Value& key, bool needsClosure ) const;
+        void                    completeLookup( const Value& object, Value& value, bool needsClosure ) const;
         void                    createClosure( Object* instance, Value* value ) const;
-        bool                    setProperty( Name* identifier, Frame* frame, const Value& value );
-        Object*                 findProperty( Name* identifier, Frame* frame, Value* value = NULL, bool needsClosure = false ) const;
+        bool                    setProperty( Name* identifier, PropertyCache* cache, Frame* frame, const Value& value );
+        bool                    setRuntimeProperty( Object* object, const Name* identifier, const Value& key, const Value& value );
+        Object*                 findProperty( Name* identifier, LexicalCache* cache, Frame* frame, Value* value = NULL, bool needsClosure = false ) const;
+        bool                    isLexicalCacheHit( const LexicalCache* cache, const ScopeStack& scope ) const;
+        void                    fillLexicalCache( LexicalCache* cache, const ScopeStack& scope, Object* object, const Name* identifier, const Value* value ) const;
+        static const void*      scopeKey( const Object* scope );
         bool                    isType( const Value& value, const Class* type ) const;
 
-        bool                    handleException( const Exceptions& exceptions, Frame* frame, int& index, const char* opCode ) const;
+        bool                    handleException( const ExceptionTable& exceptions, Frame* frame, int& index, const char* opCode ) const;
+    #if AVM2_JIT
+        JitCode                 tierUp( const FunctionScript* function, int entry ) const;
+        //! Returns true if a loop header may move to compiled code, headers compiled without an entry stay interpreted.
+        bool                    canEnterLoop( const FunctionScript* function, int header ) const;
+        int                     enterCompiled( JitCode code, const FunctionScript* function, Frame* frame, Value* registers, int& runAway );
+    #endif
         void                    throwError( Frame* frame, ErrorId errorId, const char* message, ... ) const;
 
     private:
 
         const FunctionScript*   m_function;
         Domain*                 m_domain;
+
+    #if AVM2_THREADED_DISPATCH
+        static const void**     s_handlers;
+    #endif
     };
 }
 
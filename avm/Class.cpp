@@ -91,7 +91,7 @@ Value Class::createInstance( void ) const
     Class* thiz = const_cast<Class*>( this );
 
     assert( m_createInstance );
-    Object* instance = m_createInstance( thiz->m_domain );
+    Object* instance = m_createInstance( thiz->m_domain, m_instanceTraits != NULL ? m_instanceTraits->slotCount() + 1 : 0 );
     instance->setType( thiz );
     instance->setTraits( m_instanceTraits.get() );
 
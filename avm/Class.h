@@ -46,6 +46,8 @@ namespace avm2 {
 
 	public:
 
+                                AvmDeclareType( AS_CLASS, Function );
+
                                 Class( Domain* domain, TypeId typeId, Class* superClass, QName* name, Uint8 flags, CreateInstanceThunk createInstance = NULL, Function* init = NULL, Function* staticInit = NULL );
 
         // ** Object
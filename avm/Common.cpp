@@ -30,6 +30,53 @@
 
 namespace avm2
 {
+    // ** struct PointerHash
+    //! Spreads aligned object addresses over hash buckets without hashing them byte by byte.
+    struct PointerHash {
+        int operator()( const ref_counted* pointer ) const { return int( Uint32( size_t( pointer ) >> 4 ) * 2654435761u ); }
+    };
+
+    typedef hash<const ref_counted*, weak_proxy*, PointerHash> WeakProxies;
+
+    // ** weakProxies
+    //! Weak reference proxies of objects, never destroyed so objects released during a static destruction can still unregister.
+    static WeakProxies& weakProxies( void )
+    {
+        static WeakProxies* proxies = new WeakProxies;
+        return *proxies;
+    }
+
+    // ** ref_counted::~ref_counted
+    ref_counted::~ref_counted( void )
+    {
+        weak_proxy* proxy = NULL;
+
+        if( !m_hasWeakProxy || !weakProxies().get( this, &proxy ) ) {
+            return;
+        }
+
+        weakProxies().erase( this );
+        proxy->notify_object_died();
+        proxy->drop_ref();
+    }
+
+    // ** ref_counted::get_weak_proxy
+    weak_proxy* ref_counted::get_weak_proxy( void ) const
+    {
+        weak_proxy* proxy = NULL;
+
+        if( m_hasWeakProxy && weakProxies().get( this, &proxy ) ) {
+            return proxy;
+        }
+
+        proxy = new weak_proxy;
+        proxy->add_ref();
+        weakProxies().set( this, proxy );
+        m_hasWeakProxy = true;
+
+        return proxy;
+    }
+
     bool	s_verbose_action = false;
     bool	s_verbose_parse = false;
     bool	s_use_cached_movie_instance = false;
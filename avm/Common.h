@@ -46,8 +46,18 @@ namespace avm2 {
     SPECIALIZE_GC_CONTAINER(gc_array, array);
 
     // For things that should be automatically garbage-collected.
-    struct ref_counted : public gc_object, public weak_pointee_mixin
+    // Weak reference proxies live in a side table, so objects that are never weakly referenced don't pay for them.
+    struct ref_counted : public gc_object
     {
+                            ref_counted( void ) : m_hasWeakProxy( false ) {}
+        virtual             ~ref_counted( void );
+
+        //! Returns a weak reference proxy of this object, allocated on the first call.
+        weak_proxy*         get_weak_proxy( void ) const;
+
+    private:
+
+        mutable bool        m_hasWeakProxy;     //!< Fits into a tail padding of the reference counter.
     };
 
 #if TU_CONFIG_VERBOSE
@@ -77,15 +87,88 @@ namespace avm2 {
     void set_verbose_parse(bool verbose);
 
     // ** AVM2
-#define AVM2_DEBUG  (1)
+#ifndef AVM2_DEBUG
+    #define AVM2_DEBUG  (1)
+#endif
+
 #define AVM2_INTERNAL_BUILTIN (1)
-#define AVM2_VERBOSE_INSTRUCTIONS (1)
-#define AVM2_VERBOSE( ... ) IF_VERBOSE_ACTION( logger::msg( __VA_ARGS__ ) )
 
+#ifndef AVM2_VERBOSE_INSTRUCTIONS
+    #define AVM2_VERBOSE_INSTRUCTIONS AVM2_DEBUG
+#endif
+
+    // ** Direct-threaded interpreter dispatch relies on the labels-as-values GCC extension
+#ifndef AVM2_THREADED_DISPATCH
+    #if defined( __GNUC__ )
+        #define AVM2_THREADED_DISPATCH (1)
+    #else
+        #define AVM2_THREADED_DISPATCH (0)
+    #endif
+#endif
+
+    // ** NaN-boxing packs a Value into a single 64-bit word instead of a fat tagged struct
+#ifndef AVM2_NAN_BOXING
+    #define AVM2_NAN_BOXING (0)
+#endif
+
+#if AVM2_NAN_BOXING && !defined( __x86_64__ ) && !defined( _M_X64 ) && !defined( __aarch64__ )
+    #error "AVM2_NAN_BOXING requires a 64-bit target with 48-bit pointers"
+#endif
+
+    // ** Dynamic object properties are stored inline and described by shared shapes (hidden classes)
+#ifndef AVM2_HIDDEN_CLASSES
+    #define AVM2_HIDDEN_CLASSES (1)
+#endif
+
+    // ** Linker translates operand stack shuffling between locals into register instructions
+#ifndef AVM2_REGISTER_IR
+    #define AVM2_REGISTER_IR (1)
+#endif
+
+    // ** Linker verifies function bodies and marks instructions with runtime checks proven redundant
+#ifndef AVM2_VERIFIER
+    #define AVM2_VERIFIER (1)
+#endif
+
+    // ** Linker counts adjacent opcode pairs, the report is printed by Dump::dumpOpCodePairs
+#ifndef AVM2_OPCODE_STATS
+    #define AVM2_OPCODE_STATS (0)
+#endif
+
+    // ** Functions called often enough are compiled to x86-64 machine code by a baseline template JIT
+#ifndef AVM2_JIT
+    #define AVM2_JIT (0)
+#endif
+
+    // ** Default number of calls and loop back-edges after which a function tiers up, see Domain::setTierUpThresholds
+#ifndef AVM2_JIT_THRESHOLD
+    #define AVM2_JIT_THRESHOLD (16)
+#endif
+
+#ifndef AVM2_JIT_LOOP_THRESHOLD
+    #define AVM2_JIT_LOOP_THRESHOLD (1000)
+#endif
+
+#if AVM2_JIT && !defined( __x86_64__ ) && !defined( _M_X64 )
+    #error "AVM2_JIT generates x86-64 machine code only"
+#endif
+
+    // ** Storage class of per-thread interpreter state
+#if defined( _MSC_VER )
+    #define AVM2_THREAD_LOCAL __declspec( thread )
+#else
+    #define AVM2_THREAD_LOCAL __thread
+#endif
+
+    // ** Release builds (AVM2_DEBUG=0) compile all interpreter tracing out
 #if AVM2_DEBUG
+#define AVM2_VERBOSE( ... ) IF_VERBOSE_ACTION( logger::msg( __VA_ARGS__ ) )
 #define AVM2_DEBUG_ONLY( x ) IF_VERBOSE_ACTION( x )
+#define AVM2_DEBUG_TRACE( x ) x
 #else
+#define AVM2_VERBOSE( ... )
 #define AVM2_DEBUG_ONLY( x )
+#define AVM2_DEBUG_TRACE( x )
 #endif
 
 #if AVM2_VERBOSE_INSTRUCTIONS
@@ -100,7 +183,7 @@ public:
 public:                     \
 AvmDeclareNew( type )
 #define AvmEndClass                             };
-#define AvmDeclareNew( type )                   static Object*  newOp( Domain* domain ) { return new type( domain ); }
+#define AvmDeclareNew( type )                   static Object*  newOp( Domain* domain, int slotCount ) { return Object::createWithSlots<type>( domain, slotCount ); }
 #define AvmDeclareMethod( name )                static void     name( Frame* frame );
 #define AvmDeclareProperty( getter, setter )    AvmDeclareMethod( getter )  \
 AvmDeclareMethod( setter )
@@ -125,6 +208,7 @@ typedef array<type##Weak>       container##Weak;
     class AbcInfo;
     class Domain;
     class Name;
+    struct Atom;
     class Typename;
     class Multiname;
     class QName;
@@ -133,11 +217,12 @@ typedef array<type##Weak>       container##Weak;
     class MultinameL;
     class Namespace;
     class Traits;
+    class Shape;
+    class ScopeChain;
     class Script;
     class Arguments;
     class Exception;
     class Frame;
-    class Iterator;
     class ObjectInterface;
         class Object;
             class GlobalObject;
@@ -149,14 +234,22 @@ typedef array<type##Weak>       container##Weak;
                 class FunctionNative;
                 class FunctionScript;
 
+#if AVM2_JIT
+    struct JitContext;
+
+    //! Compiled function body, returns an instruction index the interpreter resumes at or -1 after a return.
+    typedef int ( *JitCode )( JitContext* context );
+#endif
+
     AvmDeclarePtrs( Object, Objects )
-    AvmDeclarePtrs( Iterator, Iterators )
     AvmDeclarePtrs( Class, Classes )
     AvmDeclarePtrs( Function, Functions )
     AvmDeclarePtrs( Namespace, Namespaces )
     AvmDeclarePtrs( Name, Names )
     AvmDeclarePtrs( QName, QNames );
     AvmDeclarePtrs( Traits, TraitsContainer )
+    AvmDeclarePtrs( Shape, Shapes )
+    AvmDeclarePtrs( ScopeChain, ScopeChains )
     AvmDeclarePtrs( GlobalObject, GlobalObjects )
     AvmDeclarePtrs( Script, Scripts )
 
@@ -199,6 +292,7 @@ typedef array<type##Weak>       container##Weak;
         AS_FUNCTION_CLOSURE,
         AS_C_FUNCTION,
         AS_3_FUNCTION,	// action script 3 function
+        AS_CLASS,
         AS_ACTIVATION_SCOPE,
         AS_CATCH_SCOPE,
         AS_ARRAY,
@@ -265,11 +359,20 @@ typedef array<type##Weak>       container##Weak;
         return 0;
     }
 
+    // ** struct ClosureKey
+    //! Identifies a closure of a function bound to an instance.
+    struct ClosureKey {
+        const Object*   m_instance;
+        const Function* m_function;
+
+        bool            operator == ( const ClosureKey& other ) const { return m_instance == other.m_instance && m_function == other.m_function; }
+    };
+
     typedef weak_ptr<FunctionClosure>               FunctionClosureWeak;
-    typedef hash<Function*, FunctionClosureWeak>    FunctionClosures;
+    typedef hash<ClosureKey, FunctionClosureWeak>   FunctionClosures;
 
     typedef void (*FunctionNativeThunk)( Frame* frame );
-    typedef Object* (*CreateInstanceThunk)( Domain* domain );
+    typedef Object* (*CreateInstanceThunk)( Domain* domain, int slotCount );
 
 } // namespace avm2
 
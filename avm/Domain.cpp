@@ -42,9 +42,10 @@ void as_global_trace( Frame* frame );
 // ------------------------------------------------ Domain ------------------------------------------------ //
 
 // ** Domain::Domain
-Domain::Domain( void )
+Domain::Domain( void ) : m_closureSweepSize( 64 ), m_optimizations( Optimizer::DefaultPasses ), m_callThreshold( AVM2_JIT_THRESHOLD ), m_loopThreshold( AVM2_JIT_LOOP_THRESHOLD ), m_bindingEpoch( 1 )
 {
-    m_global = new GlobalObject( this );
+    m_rootShape = new Shape;
+    m_global    = new GlobalObject( this );
 }
 
 // ** Domain::name
@@ -71,12 +72,119 @@ void Domain::setFunctions( const FunctionScripts& value )
     m_functions = value;
 }
 
+// ** Domain::optimizations
+int Domain::optimizations( void ) const
+{
+    return m_optimizations;
+}
+
+// ** Domain::setOptimizations
+void Domain::setOptimizations( int value )
+{
+    m_optimizations = value;
+}
+
+// ** Domain::functions
+const FunctionScripts& Domain::functions( void ) const
+{
+    return m_functions;
+}
+
+// ** Domain::setTierUpThresholds
+void Domain::setTierUpThresholds( int calls, int loops )
+{
+    m_callThreshold = calls;
+    m_loopThreshold = loops;
+}
+
+// ** Domain::callThreshold
+int Domain::callThreshold( void ) const
+{
+    return m_callThreshold;
+}
+
+// ** Domain::loopThreshold
+int Domain::loopThreshold( void ) const
+{
+    return m_loopThreshold;
+}
+
+// ** Domain::bindingEpoch
+int Domain::bindingEpoch( void ) const
+{
+    return m_bindingEpoch;
+}
+
+// ** Domain::invalidateBindings
+void Domain::invalidateBindings( void )
+{
+    m_bindingEpoch++;
+}
+
+// ** Domain::enclose
+FunctionClosure* Domain::enclose( Object* instance, Function* function )
+{
+    ClosureKey          key = { instance, function };
+    FunctionClosureWeak cached;
+
+    // ** Search for a cached closure
+    if( m_closures.get( key, &cached ) && cached != NULL ) {
+        return cached.get_ptr();
+    }
+
+    if( m_closures.size() >= m_closureSweepSize ) {
+        sweepClosures();
+    }
+
+    // ** Create a new function closure
+    FunctionClosure* closure = new FunctionClosure( this, instance, function );
+    m_closures.set( key, closure );
+
+    return closure;
+}
+
+// ** Domain::sweepClosures
+void Domain::sweepClosures( void )
+{
+    array<ClosureKey> dead;
+
+    // ** A closure holds its instance, so a key of a dead closure may only be reused by a new object at the same address
+    for( FunctionClosures::iterator i = m_closures.begin(), end = m_closures.end(); i != end; ++i ) {
+        if( i->second == NULL ) {
+            dead.push_back( i->first );
+        }
+    }
+
+    for( int i = 0, n = dead.size(); i < n; i++ ) {
+        m_closures.erase( dead[i] );
+    }
+
+    // ** Sweep again once the table doubles, so the cost is amortized over created closures
+    m_closureSweepSize = imax( 64, m_closures.size() * 2 );
+}
+
+#if AVM2_JIT
+
+// ** Domain::codeArena
+CodeArena* Domain::codeArena( void )
+{
+    return &m_codeArena;
+}
+
+#endif  /*  AVM2_JIT    */
+
 // ** Domain::global
 GlobalObject* Domain::global( void ) const
 {
     return m_global.get();
 }
 
+// ** Domain::rootShape
+Shape* Domain::rootShape( void ) const
+{
+    return m_rootShape.get();
+}
+
 // ** Domain::registerClass
 Class* Domain::registerClass( TypeId typeId, const Str& className, const Str& superClass, CreateInstanceThunk createInstance, FunctionNative* init )
 {
@@ -29,6 +29,8 @@
 
 #include "Function.h"
 #include "Multiname.h"
+#include "Optimizer.h"
+#include "Jit.h"
 
 namespace avm2 {
 
@@ -36,7 +38,7 @@ namespace avm2 {
     class GlobalObject : public Object {
     public:
 
-                            GlobalObject( Domain* domain ) : Object( domain ) {}
+                            GlobalObject( Domain* domain ) : Object( domain ) { m_isScope = true; }
 
         // ** Object
         virtual const char* to_string( void ) { return "[object global]"; }
@@ -53,6 +55,22 @@ namespace avm2 {
         void                setStrings( const Strings& value );
         void                setFunctions( const FunctionScripts& value );
         GlobalObject*       global( void ) const;
+        Shape*              rootShape( void ) const;
+        int                 optimizations( void ) const;
+        void                setOptimizations( int value );
+        const FunctionScripts& functions( void ) const;
+        void                setTierUpThresholds( int calls, int loops );
+        int                 callThreshold( void ) const;
+        int                 loopThreshold( void ) const;
+        //! Returns a counter of changes to property names of scope objects, cached name lookups are valid until it changes.
+        int                 bindingEpoch( void ) const;
+        //! Invalidates all cached name lookups.
+        void                invalidateBindings( void );
+        //! Returns a closure of a function bound to an instance, reusing the closure while it's alive.
+        FunctionClosure*    enclose( Object* instance, Function* function );
+    #if AVM2_JIT
+        CodeArena*          codeArena( void );
+    #endif
 
         virtual void        registerPackages( void );
         Class*              registerClass( TypeId typeId, const Str& name, const Str& superClass, CreateInstanceThunk createInstance = NULL, FunctionNative* init = NULL );
@@ -63,12 +81,27 @@ namespace avm2 {
 
     protected:
 
+        //! Drops cache entries of closures that are no longer alive.
+        void                sweepClosures( void );
+
+    protected:
+
+        FunctionClosures    m_closures;         //!< Side table of bound method closures, only objects that had a method read as a value have entries.
+        int                 m_closureSweepSize; //!< Closure table size that triggers the next sweep of dead entries.
+        ShapePtr            m_rootShape;
         GlobalObjectPtr     m_global;
         Names               m_names;
         Strings             m_strings;
         FunctionScripts     m_functions;
 
         Names               m_nameCache;
+        int                 m_optimizations;    //!< Optimizer passes that the Linker runs over function bodies.
+        int                 m_callThreshold;    //!< Calls after which a function tiers up.
+        int                 m_loopThreshold;    //!< Backward branches to a loop header after which a function tiers up.
+        int                 m_bindingEpoch;     //!< Bumped each time a scope object gains or loses a property.
+    #if AVM2_JIT
+        CodeArena           m_codeArena;        //!< Executable memory for compiled functions.
+    #endif
     };
 
 #if 0
@@ -27,6 +27,10 @@
 #include "Dump.h"
 #include "Instructions.h"
 #include "Abc.h"
+#include "Domain.h"
+#include "Function.h"
+
+#include <algorithm>
 
 namespace avm2
 {
@@ -361,6 +365,24 @@ const char* Dump::formatOpCode( int opcode )
         case StrictEquals: return "StrictEquals";
         case URightShift: return "URightShift";
         case ApplyType: return "ApplyType";
+        case RegMove: return "RegMove";
+        case RegAdd: return "RegAdd";
+        case RegSubtract: return "RegSubtract";
+        case RegMultiply: return "RegMultiply";
+        case RegIncrement: return "RegIncrement";
+        case RegIncrementI: return "RegIncrementI";
+        case RegDecrement: return "RegDecrement";
+        case RegIfLess: return "RegIfLess";
+        case RegIfGreater: return "RegIfGreater";
+        case RegIfLessEqual: return "RegIfLessEqual";
+        case RegIfNotLess: return "RegIfNotLess";
+        case RegIfNotEqual: return "RegIfNotEqual";
+        case RegIfTrue: return "RegIfTrue";
+        case RegIfFalse: return "RegIfFalse";
+        case RegPushScope: return "RegPushScope";
+        case RegGetProperty: return "RegGetProperty";
+        case RegIfEquals: return "RegIfEquals";
+        case RegIfNotEquals: return "RegIfNotEquals";
         default: AVM2_VERBOSE( "Dump::formatOpCode : unhandled opcode %x\n", opcode );
     }
     
@@ -374,4 +396,85 @@ const char* Dump::formatString( const AbcInfo* abc, int str )
     return abc->m_string[str].c_str();
 }
 
+// ** Dump::dumpProfile
+void Dump::dumpProfile( const Domain* domain )
+{
+    const FunctionScripts& functions = domain->functions();
+    array<long long>       sorted;
+
+    // ** Pack a call count above a function index, so sorting numbers sorts functions
+    for( int i = 0, n = functions.size(); i < n; i++ ) {
+        if( functions[i] != NULL && functions[i]->callCount() ) {
+            sorted.push_back( ( ( long long )functions[i]->callCount() << 32 ) | i );
+        }
+    }
+
+    std::sort( sorted.begin(), sorted.end() );
+
+    for( int i = ( int )sorted.size() - 1; i >= 0; i-- ) {
+        const FunctionScript* function = functions[int( sorted[i] & 0xffffffff )].get_ptr();
+        printf( "%8d %s\n", function->callCount(), function->name().c_str() );
+
+        for( int header = 0, n = function->instructions().size(); header <= n; header++ ) {
+            if( function->backEdgeCount( header ) ) {
+                printf( "%8d     loop at %d\n", function->backEdgeCount( header ), header );
+            }
+        }
+    }
+}
+
+#if AVM2_OPCODE_STATS
+
+// ** opCodePairs
+static hash<int, int>& opCodePairs( bool translated )
+{
+    static hash<int, int> pairs[2];
+    return pairs[translated ? 1 : 0];
+}
+
+// ** printOpCodePairs
+static void printOpCodePairs( hash<int, int>& pairs, int count )
+{
+    array<long long> sorted;
+
+    // ** Pack a frequency above a pair, so sorting numbers sorts pairs
+    for( hash<int, int>::iterator i = pairs.begin(); i != pairs.end(); ++i ) {
+        sorted.push_back( ( ( long long )i->second << 16 ) | i->first );
+    }
+
+    std::sort( sorted.begin(), sorted.end() );
+
+    for( int i = ( int )sorted.size() - 1, n = 0; i >= 0 && n < count; i--, n++ ) {
+        int pair = int( sorted[i] & 0xffff );
+        printf( "%8d %s; %s\n", int( sorted[i] >> 16 ), Dump::formatOpCode( pair >> 8 ), Dump::formatOpCode( pair & 0xff ) );
+    }
+}
+
+// ** Dump::countOpCodePairs
+void Dump::countOpCodePairs( const Instructions& instructions, bool translated )
+{
+    hash<int, int>& pairs = opCodePairs( translated );
+
+    for( int i = 1, n = ( int )instructions.size(); i < n; i++ ) {
+        int key   = ( instructions[i - 1].opCode << 8 ) | instructions[i].opCode;
+        int count = 0;
+
+        pairs.get( key, &count );
+        pairs.set( key, count + 1 );
+    }
+}
+
+// ** Dump::dumpOpCodePairs
+void Dump::dumpOpCodePairs( int count )
+{
+    printf( "stack form:\n" );
+    printOpCodePairs( opCodePairs( false ), count );
+
+    // ** Pairs left here were not fused by RegisterTranslator
+    printf( "register form:\n" );
+    printOpCodePairs( opCodePairs( true ), count );
+}
+
+#endif  /*  AVM2_OPCODE_STATS   */
+
 } // namespace avm2
\ No newline at end of file
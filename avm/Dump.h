@@ -29,6 +29,10 @@
 
 #include "Common.h"
 
+#if AVM2_OPCODE_STATS
+    #include "Instructions.h"
+#endif
+
 namespace avm2 {
 
     // ** class Dump
@@ -49,6 +53,16 @@ namespace avm2 {
         static const char*      formatMultinameKind( int kind );
         static const char*      formatNamespaceKind( int kind );
         static const char*      formatString( const AbcInfo* abc, int str );
+
+        //! Prints call and loop back-edge counters of executed functions, the hottest first.
+        static void             dumpProfile( const Domain* domain );
+
+    #if AVM2_OPCODE_STATS
+        //! Accumulates frequencies of adjacent opcode pairs, used to pick superinstructions.
+        static void             countOpCodePairs( const Instructions& instructions, bool translated = false );
+        //! Prints the most frequent opcode pairs counted so far, before and after register translation.
+        static void             dumpOpCodePairs( int count );
+    #endif
         
     private:
         
@@ -33,7 +33,7 @@ namespace avm2
 // ------------------------------------------------------ Error ------------------------------------------------------ //
 
 // ** Error::Error
-Error::Error( Domain* domain, String* message, int errorId ) : Object( domain ), m_message( message ), m_errorId( errorId )
+Error::Error( Domain* domain, String* message, int errorId ) : Object( domain ), m_message( message ), m_withMessage( false ), m_errorId( errorId )
 {
 
 }
@@ -45,8 +45,9 @@ const char* Error::to_string( void )
         return "Error";
     }
 
-    static char buf[64];
-    sprintf( buf, "Error: %s", m_message->toCString() );
+    // ** Longer messages are truncated instead of overflowing the buffer
+    static char buf[256];
+    snprintf( buf, sizeof( buf ), "Error: %s", m_message->toCString() );
 
     return buf;
 }
@@ -90,6 +91,21 @@ void Error::setErrorId( int value )
 // ** Error::stackTrace
 String* Error::stackTrace( void ) const
 {
+    if( m_callees.size() == 0 ) {
+        return m_stackTrace.get();
+    }
+
+    // ** Most errors are caught without ever reading a stack trace, so it's formatted here
+    Str str = m_withMessage ? Str( const_cast<Error*>( this )->to_string() ) + "\n" : Str( "" );
+
+    for( int i = 0, n = ( int )m_callees.size(); i < n; i++ ) {
+        str += i ? "\n\t at " : "\t at ";
+        str += m_callees[i]->name();
+    }
+
+    m_stackTrace = new String( m_domain, str );
+    m_callees.clear();
+
     return m_stackTrace.get();
 }
 
@@ -97,6 +113,17 @@ String* Error::stackTrace( void ) const
 void Error::setStackTrace( String* value )
 {
     m_stackTrace = value;
+    m_callees.clear();
+}
+
+// ** Error::captureStackTrace
+void Error::captureStackTrace( const Frame* frame, bool withMessage )
+{
+    m_stackTrace  = NULL;
+    m_withMessage = withMessage;
+    m_callees.clear();
+
+    frame->captureStackTrace( m_callees );
 }
 
 // ** Error::create
@@ -128,7 +155,7 @@ void ErrorClosure::init( Frame* frame )
     e->setErrorId( errorId );
 
     if( const Frame* parent = frame->parent() ) {
-        e->setStackTrace( new String( parent->domain(), Str( e->to_string() ) + "\n" + parent->captureStackTrace() ) );
+        e->captureStackTrace( parent, true );
     }
 }
 
@@ -51,6 +51,7 @@ namespace avm2 {
         void                setErrorId( int value );
         String*             stackTrace( void ) const;
         void                setStackTrace( String* value );
+        void                captureStackTrace( const Frame* frame, bool withMessage );
 
         static Error*       create( Domain* domain, const char* message, ... );
 
@@ -58,7 +59,9 @@ namespace avm2 {
 
         StringPtr           m_message;
         StringPtr           m_name;
-        StringPtr           m_stackTrace;
+        mutable StringPtr   m_stackTrace;   //!< Formatted from m_callees on the first read.
+        mutable Functions   m_callees;      //!< Functions on the call stack when the stack trace was captured.
+        bool                m_withMessage;  //!< The formatted stack trace starts with the error string.
         int                 m_errorId;
     };
 
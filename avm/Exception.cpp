@@ -28,6 +28,8 @@
 
 #include "Class.h"
 
+#include <algorithm>
+
 namespace avm2
 {
 
@@ -91,4 +93,73 @@ bool Exception::isFinally( void ) const
     return m_isFinally;
 }
 
+// ** ExceptionTable::build
+void ExceptionTable::build( const Exceptions& exceptions )
+{
+    m_ranges.clear();
+    m_handlers.clear();
+
+    // ** Ranges are split at every point where some handler starts or stops covering instructions
+    array<int> points;
+
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        points.push_back( exceptions[i]->from() );
+        points.push_back( exceptions[i]->to() + 1 );
+    }
+
+    std::sort( points.begin(), points.end() );
+
+    for( int i = 0, n = ( int )points.size() - 1; i < n; i++ ) {
+        if( points[i] == points[i + 1] ) {
+            continue;
+        }
+
+        Range range;
+        range.m_from  = points[i];
+        range.m_to    = points[i + 1] - 1;
+        range.m_first = m_handlers.size();
+        range.m_count = 0;
+
+        // ** Handlers keep their declaration order, so inner ones are still tried first
+        for( int j = 0, count = ( int )exceptions.size(); j < count; j++ ) {
+            const Exception* e = exceptions[j].get();
+
+            if( e->from() <= range.m_from && range.m_to <= e->to() ) {
+                m_handlers.push_back( e );
+                range.m_count++;
+            }
+        }
+
+        if( range.m_count ) {
+            m_ranges.push_back( range );
+        }
+    }
+}
+
+// ** ExceptionTable::find
+const Exception* const* ExceptionTable::find( int index, int& count ) const
+{
+    int lo = 0;
+    int hi = ( int )m_ranges.size() - 1;
+
+    while( lo <= hi ) {
+        int          mid   = ( lo + hi ) / 2;
+        const Range& range = m_ranges[mid];
+
+        if( index < range.m_from ) {
+            hi = mid - 1;
+        }
+        else if( index > range.m_to ) {
+            lo = mid + 1;
+        }
+        else {
+            count = range.m_count;
+            return &m_handlers[range.m_first];
+        }
+    }
+
+    count = 0;
+    return NULL;
+}
+
 }
\ No newline at end of file
@@ -59,6 +59,33 @@ namespace avm2
 
     typedef gc_ptr<Exception>   ExceptionPtr;
     typedef array<ExceptionPtr> Exceptions;
+
+    // ** class ExceptionTable
+    //! Exception handlers of a function body split into sorted disjoint instruction ranges.
+    /*! The table is built once a body is linked, so a throw finds handlers that cover an instruction with
+     *  a binary search instead of scanning all handlers, and calls that never throw pay nothing for it.
+     */
+    class ExceptionTable {
+    public:
+
+        //! Rebuilds the table from handlers listed in the order they are tried.
+        void                    build( const Exceptions& exceptions );
+        //! Returns handlers that cover a given instruction in the order they are tried, count is zero if there are none.
+        const Exception* const* find( int index, int& count ) const;
+
+    private:
+
+        // ** struct Range
+        struct Range {
+            int                 m_from;
+            int                 m_to;       //!< The last instruction of a range, inclusive.
+            int                 m_first;    //!< The first handler of a range inside m_handlers.
+            int                 m_count;
+        };
+
+        array<Range>            m_ranges;
+        array<const Exception*> m_handlers; //!< Handlers of all ranges, owned by a function body.
+    };
 }
 
 #endif /* defined(__avm2__Exception__) */
@@ -199,10 +199,14 @@ void FunctionNative::execute( Frame* frame ) const
 // ------------------------------------------------ FunctionScript ------------------------------------------------ //
 
 // ** FunctionScript::FunctionScript
-FunctionScript::FunctionScript( Domain* domain, int maxStack, int maxScope )
-    : Function( domain ), m_maxStack( maxStack ), m_maxScope( maxScope ), m_argCheck( false )
+FunctionScript::FunctionScript( Domain* domain, int maxStack, int maxScope, int localCount )
+    : Function( domain ), m_maxStack( maxStack ), m_maxScope( maxScope ), m_localCount( localCount ), m_registerCount( localCount ), m_argCheck( false )
 {
-
+    m_callCount = 0;
+#if AVM2_JIT
+    m_tieredUp  = false;
+    m_jitEntry  = NULL;
+#endif
 }
 
 // ** FunctionScript::to_string
@@ -226,6 +230,18 @@ void FunctionScript::setSuper( Function* value )
     m_super = value;
 }
 
+// ** FunctionScript::superTraits
+const Traits* FunctionScript::superTraits( void ) const
+{
+    return m_superTraits.get_ptr();
+}
+
+// ** FunctionScript::setSuperTraits
+void FunctionScript::setSuperTraits( const Traits* value )
+{
+    m_superTraits = value;
+}
+
 // ** FunctionScript::instructions
 const Instructions& FunctionScript::instructions( void ) const
 {
@@ -236,6 +252,77 @@ const Instructions& FunctionScript::instructions( void ) const
 void FunctionScript::setInstructions( const Instructions& value )
 {
     m_instructions = value;
+
+    // ** Exception ranges are final once the instructions are linked
+    m_exceptionTable.build( m_exceptions );
+
+    // ** Each instruction may be a loop header
+    m_backEdges.resize( m_instructions.size() + 1 );
+
+    for( int i = 0, n = ( int )m_backEdges.size(); i < n; i++ ) {
+        m_backEdges[i] = 0;
+    }
+
+    // ** Count property access and name lookup instructions
+    int count   = 0;
+    int lookups = 0;
+
+    for( int i = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        if( hasPropertyCache( m_instructions[i].opCode ) ) {
+            count++;
+        }
+        else if( hasLexicalCache( m_instructions[i].opCode ) ) {
+            lookups++;
+        }
+    }
+
+    // ** Bind each of them to an empty inline cache
+    m_propertyCaches.resize( count );
+    m_lexicalCaches.resize( lookups );
+
+    for( int i = 0, j = 0, k = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        if( hasPropertyCache( m_instructions[i].opCode ) ) {
+            m_propertyCaches[j].m_size = 0;
+            m_propertyCaches[j].m_base = NULL;
+            m_instructions[i].cache    = &m_propertyCaches[j++];
+        }
+        else if( hasLexicalCache( m_instructions[i].opCode ) ) {
+            m_lexicalCaches[k].m_epoch      = 0;
+            m_instructions[i].lexicalCache  = &m_lexicalCaches[k++];
+        }
+    }
+}
+
+// ** FunctionScript::hasPropertyCache
+bool FunctionScript::hasPropertyCache( OpCode opCode )
+{
+    switch( opCode ) {
+    case GetProperty:
+    case RegGetProperty:
+    case SetProperty:
+    case InitProperty:
+    case CallProperty:
+    case CallPropVoid:
+    case CallSuper:
+    case CallSuperVoid:
+    case ConstructProp: return true;
+    default:            break;
+    }
+
+    return false;
+}
+
+// ** FunctionScript::hasLexicalCache
+bool FunctionScript::hasLexicalCache( OpCode opCode )
+{
+    switch( opCode ) {
+    case FindProperty:
+    case FindPropertyStrict:
+    case GetLex:        return true;
+    default:            break;
+    }
+
+    return false;
 }
 
 // ** FunctionScript::checkArguments
@@ -281,6 +368,31 @@ void FunctionScript::execute( Frame* frame ) const
     }
 }
 
+// ** FunctionScript::setRegisters
+void FunctionScript::setRegisters( int count, const ValueArray& constants )
+{
+    m_registerCount = count;
+    m_constants     = constants;
+}
+
+// ** FunctionScript::constants
+const ValueArray& FunctionScript::constants( void ) const
+{
+    return m_constants;
+}
+
+// ** FunctionScript::callCount
+int FunctionScript::callCount( void ) const
+{
+    return m_callCount;
+}
+
+// ** FunctionScript::backEdgeCount
+int FunctionScript::backEdgeCount( int header ) const
+{
+    return m_backEdges[header];
+}
+
 // ** FunctionScript::addException
 void FunctionScript::addException( Exception* e )
 {
@@ -293,6 +405,12 @@ const Exceptions& FunctionScript::exceptions( void ) const
     return m_exceptions;
 }
 
+// ** FunctionScript::exceptionTable
+const ExceptionTable& FunctionScript::exceptionTable( void ) const
+{
+    return m_exceptionTable;
+}
+
 // ** FunctionScript::returnType
 Class* FunctionScript::returnType( void ) const
 {
@@ -339,7 +457,7 @@ int FunctionScript::nargs( void ) const
 // ------------------------------------------------ FunctionScope ------------------------------------------------ //
 
 // ** FunctionWithScope::FunctionWithScope
-FunctionWithScope::FunctionWithScope( Domain* domain, Function* function, const ScopeStack& scope ) : Function( domain ), m_function( function ), m_scope( scope )
+FunctionWithScope::FunctionWithScope( Domain* domain, Function* function, ScopeChain* scope ) : Function( domain ), m_function( function ), m_scope( scope )
 {
 
 }
@@ -362,7 +480,7 @@ int FunctionWithScope::nargs( void ) const
 // ** FunctionWithScope::call
 void FunctionWithScope::execute( Frame* frame ) const
 {
-    frame->setOuterScope( &m_scope );
+    frame->setOuterScope( m_scope.get() );
     m_function->execute( frame );
 }
 
@@ -370,11 +488,31 @@ void FunctionWithScope::execute( Frame* frame ) const
 
 // ** Frame::Frame
 Frame::Frame( const Function* callee, Domain* domain, const Frame* parent, Object* instance, const Arguments* args )
-    : m_domain( domain ), m_callee( callee ), m_parent( parent ), m_arguments( args ), m_instance( instance ), m_hasException( false )
+    : m_domain( domain ), m_callee( callee ), m_parent( parent ), m_arguments( args ), m_instance( instance ), m_hasException( false ), m_storage( NULL ), m_storageSize( 0 ), m_arenaMark( -1 )
 {
 
 }
 
+// ** Frame::~Frame
+Frame::~Frame( void )
+{
+    if( m_storage == NULL ) {
+        return;
+    }
+
+    // ** Frames are nested on the native stack, so the arena is released in LIFO order
+    m_stack.unbind();
+    m_scope.m_stack.unbind();
+
+    // ** The caller's argument window was reset along with the registers
+    if( m_arenaMark >= 0 ) {
+        FrameArena::instance().rewind( m_storage, m_storageSize, m_arenaMark );
+        m_arguments->consume();
+    } else {
+        FrameArena::instance().release( m_storage, m_storageSize );
+    }
+}
+
 // ** Frame::domain
 Domain* Frame::domain( void ) const
 {
@@ -442,7 +580,7 @@ void Frame::setInstance( Object* value )
 }
 
 // ** Frame::setOuterScope
-void Frame::setOuterScope( const ScopeStack* value )
+void Frame::setOuterScope( ScopeChain* value )
 {
     m_scope.setOuter( value );
 }
@@ -479,11 +617,58 @@ const Value& Frame::exception( void ) const
     return m_exception;
 }
 
-// ** Frame::fillLocalRegisters
-void Frame::fillLocalRegisters( ValueArray& registers, int maxSize )
+// ** Frame::allocateRegisters
+Value* Frame::allocateRegisters( int count, int maxStack, int maxScope )
+{
+    assert( m_storage == NULL );
+
+    FrameArena& arena = FrameArena::instance();
+    m_storageSize = count + maxScope + maxStack;
+
+    // ** Arguments are still on the caller's operand stack, so registers start right at the popped receiver slot
+    if( m_parent && m_parent->isArgumentWindow( m_arguments ) && m_arguments->count() < count ) {
+        m_arenaMark = arena.mark();
+        m_storage   = arena.allocateAt( const_cast<Value*>( m_arguments->values() ) - 1, m_storageSize );
+
+        if( !m_storage ) {
+            m_arenaMark = -1;
+        }
+    }
+
+    if( m_storage ) {
+        int nargs = m_arguments->count();
+
+        m_storage[0] = m_instance != NULL ? m_instance.get() : m_domain->global();
+
+        for( int i = 0; i < nargs; i++ ) {
+            Value::coerceInPlace( m_storage[i + 1], m_callee->argType( i ) );
+        }
+
+        // ** Operand stack slots above the window may hold values left by native calls
+        for( int i = nargs + 1; i < count; i++ ) {
+            m_storage[i].setUndefined();
+        }
+    } else {
+        m_storage = arena.allocate( m_storageSize );
+        fillLocalRegisters( m_storage, count );
+    }
+
+    // ** The operand stack goes last, so a callee block can overlap its unused tail
+    m_scope.m_stack.bind( m_storage + count, maxScope );
+    m_stack.bind( m_storage + count + maxScope, maxStack );
+
+    return m_storage;
+}
+
+// ** Frame::isArgumentWindow
+bool Frame::isArgumentWindow( const Arguments* args ) const
 {
-    registers.resize( maxSize );
+    return args && m_storage && m_stack.isDetached( args->values(), args->count() );
+}
 
+// ** Frame::fillLocalRegisters
+void Frame::fillLocalRegisters( Value* registers, int maxSize )
+{
     registers[0] = m_instance != NULL ? m_instance.get() : m_domain->global();
 
     if( !m_arguments ) {
@@ -499,65 +684,98 @@ void Frame::fillLocalRegisters( ValueArray& registers, int maxSize )
 }
 
 // ** Frame::captureStackTrace
-Str Frame::captureStackTrace( void ) const
+void Frame::captureStackTrace( Functions& callees ) const
 {
-    Str str = Str( "\t at " ) + m_callee->name();
-    return m_parent ? str + "\n" + m_parent->captureStackTrace() : str;
+    for( const Frame* frame = this; frame; frame = frame->m_parent ) {
+        callees.push_back( const_cast<Function*>( frame->m_callee ) );
+    }
 }
 
 // --------------------------------------------------- Arguments ---------------------------------------------------- //
 
 // ** Arguments::Arguments
-Arguments::Arguments( const Value* args, int count )
+Arguments::Arguments( const Value* args, int count ) : m_values( args ), m_count( count ), m_consumed( false )
+{
+
+}
+
+// ** Arguments::Arguments
+Arguments::Arguments( const Arguments& other ) : m_values( other.m_values ), m_count( other.m_count ), m_storage( other.m_storage ), m_consumed( other.m_consumed )
 {
-    for( int i = count - 1; i >= 0; i-- ) {
-        m_args.push_back( args[i] );
+    if( !m_storage.empty() ) {
+        m_values = &m_storage[0];
     }
 }
 
-// ** Arguments::clear
-void Arguments::clear( void )
+// ** Arguments::assign
+void Arguments::assign( const Value* args, int count )
+{
+    m_values   = args;
+    m_count    = count;
+    m_consumed = false;
+    m_storage.clear();
+}
+
+// ** Arguments::consume
+void Arguments::consume( void ) const
 {
-    m_args.clear();
+    m_consumed = true;
+}
+
+// ** Arguments::isConsumed
+bool Arguments::isConsumed( void ) const
+{
+    return m_consumed;
 }
 
 // ** Arguments::setDefaults
 void Arguments::setDefaults( int maxArgs, const ValueArray& values )
 {
+    assert( !m_consumed );
+
     int nargs  = count();
     int offset = maxArgs - values.size();
 
+    if( nargs >= maxArgs ) {
+        return;
+    }
+
+    // ** Copy a view to the owned storage and append the missing arguments
+    if( m_storage.empty() ) {
+        m_storage.reserve( maxArgs );
+        for( int i = 0; i < nargs; i++ ) {
+            m_storage.push_back( m_values[i] );
+        }
+    }
+
     for( int i = nargs; i < maxArgs; i++ ) {
-        const Value& value = values[i - offset];
-        m_args.insert( m_args.begin(), value );
+        m_storage.push_back( values[i - offset] );
     }
-}
 
-// ** Arguments::push
-void Arguments::push( const Value& value )
-{
-    m_args.push_back( value );
+    m_values = &m_storage[0];
+    m_count  = ( int )m_storage.size();
 }
 
 // ** Arguments::count
 int Arguments::count( void ) const
 {
-    return ( int )m_args.size();
+    return m_count;
 }
 
 // ** Arguments::values
-const ValueArray& Arguments::values( void ) const
+const Value* Arguments::values( void ) const
 {
-    return m_args;
+    assert( !m_consumed );
+    return m_values;
 }
 
 // ** Arguments::arg
 const Value& Arguments::arg( int index ) const
 {
-    int nargs = count();
+    assert( !m_consumed );
 
-    if( index >= 0 && index < nargs ) {
-        return m_args[nargs - index - 1];
+    if( index >= 0 && index < m_count ) {
+        return m_values[index];
     }
 
     return Value::undefined;
@@ -35,22 +35,40 @@
 namespace avm2 {
 
     // ** class Arguments
+    //! A read-only view of call arguments, usually a window of the caller's operand stack.
     class Arguments {
     public:
 
                                     Arguments( const Value* args = NULL, int count = 0 );
-
-        void                        clear( void );
-        void                        push( const Value& value );
+                                    Arguments( const Arguments& other );
+
+        //! Points the view to a given range of Values.
+        /*! A script callee may take a window of the caller's operand stack over as its registers. The window
+         *  is reset to undefined when the callee returns and its frame marks the view consumed, so a caller
+         *  assigns the view again before each call and never reads the arguments back after it.
+         */
+        void                        assign( const Value* args, int count );
+        //! Marks the view consumed by a callee frame that used it as registers.
+        void                        consume( void ) const;
+        //! Returns true if the view was consumed and should not be read any more.
+        bool                        isConsumed( void ) const;
         int                         count( void ) const;
-        const ValueArray&           values( void ) const;
+        const Value*                values( void ) const;
         ValueArray                  args( int startIndex ) const;
         const Value&                arg( int index ) const;
+        //! Appends default values for missing arguments, the view is copied to an owned storage first.
         void                        setDefaults( int maxArgs, const ValueArray& values );
 
     private:
 
-        ValueArray                  m_args;
+        void                        operator = ( const Arguments& );
+
+    private:
+
+        const Value*                m_values;
+        int                         m_count;
+        ValueArray                  m_storage;  //!< Materialized arguments, used only when defaults are appended.
+        mutable bool                m_consumed; //!< The view was reused as callee registers and released.
     };
 
     // ** class Function
@@ -140,7 +158,7 @@ namespace avm2 {
 
                                     AvmDeclareType( AS_3_FUNCTION, Function );
 
-                                    FunctionScript( Domain* domain, int maxStack = 0, int maxScope = 0 );
+                                    FunctionScript( Domain* domain, int maxStack = 0, int maxScope = 0, int localCount = 0 );
 
         // ** Object
         virtual const char*         to_string( void );
@@ -150,13 +168,20 @@ namespace avm2 {
         // ** FunctionScript
         Function*                   super( void ) const;
         void                        setSuper( Function* value );
+        const Traits*               superTraits( void ) const;
+        void                        setSuperTraits( const Traits* value );
         const Instructions&         instructions( void ) const;
         void                        setInstructions( const Instructions& value );
+        void                        setRegisters( int count, const ValueArray& constants );
+        const ValueArray&           constants( void ) const;
         const Exceptions&           exceptions( void ) const;
+        const ExceptionTable&       exceptionTable( void ) const;
         void                        addException( Exception* e );
         void                        setArguments( const ClassesWeak& types, const ValueArray& defaults );
         Class*                      returnType( void ) const;
         void                        setReturnType( const ClassWeak& value );
+        int                         callCount( void ) const;
+        int                         backEdgeCount( int header ) const;
 
     private:
 
@@ -165,18 +190,34 @@ namespace avm2 {
 
         // ** FunctionScript
         bool                        checkArguments( Frame* frame ) const;
+        static bool                 hasPropertyCache( OpCode opCode );
+        static bool                 hasLexicalCache( OpCode opCode );
 
     private:
 
         Instructions                m_instructions;
+        PropertyCaches              m_propertyCaches;
+        LexicalCaches               m_lexicalCaches;
         FunctionWeak                m_super;
+        TraitsWeakConst             m_superTraits;      //!< Instance traits of a base class, super calls of a method are dispatched through them.
         Exceptions                  m_exceptions;
+        ExceptionTable              m_exceptionTable;   //!< Handlers of linked instructions, looked up when an exception is thrown.
         int                         m_maxStack;
         int                         m_maxScope;
+        int                         m_localCount;
+        int                         m_registerCount;    //!< Locals followed by registers of translated instructions.
+        ValueArray                  m_constants;        //!< Constants read by register instructions, never copied to registers.
         ClassWeak                   m_returnType;
         ClassesWeak                 m_argTypes;
         ValueArray                  m_argDefaults;
         bool                        m_argCheck;
+        mutable int                 m_callCount;        //!< Number of times this function was called.
+        mutable array<int>          m_backEdges;        //!< Backward branches taken to each loop header instruction.
+    #if AVM2_JIT
+        mutable bool                m_tieredUp;         //!< The function was handed to the JIT, successfully or not.
+        mutable array<JitCode>      m_jitEntries;       //!< Machine code entry for the first instruction and each loop header.
+        mutable JitCode             m_jitEntry;         //!< Machine code entered by calls, NULL while calls are interpreted.
+    #endif
     };
 
     typedef gc_ptr<FunctionScript>      FunctionScriptPtr;
@@ -186,7 +227,7 @@ namespace avm2 {
     class FunctionWithScope : public Function {
     public:
 
-                                    FunctionWithScope( Domain* domain, Function* function, const ScopeStack& scope );
+                                    FunctionWithScope( Domain* domain, Function* function, ScopeChain* scope );
 
         // ** Object
         virtual const char*         to_string( void );
@@ -200,7 +241,7 @@ namespace avm2 {
     private:
 
         FunctionPtr                 m_function;
-        ScopeStack                  m_scope;
+        ScopeChainPtr               m_scope;
     };
 
     // ** class ActivationScope
@@ -233,6 +274,7 @@ namespace avm2 {
     public:
 
                                     Frame( const Function* callee, Domain* domain, const Frame* parent, Object* instance, const Arguments* args );
+                                    ~Frame( void );
 
         Domain*                     domain( void ) const;
         const Frame*                parent( void ) const;
@@ -244,18 +286,20 @@ namespace avm2 {
         const Value&                result( void ) const;
         void                        setResult( const Value& value );
         void                        setInstance( Object* value );
-        void                        setOuterScope( const ScopeStack* value );
+        void                        setOuterScope( ScopeChain* value );
         void                        setDefaultArgs( int maxArgs, const ValueArray& values );
 
         void                        throwException( const Value& error );
         bool                        hasUnhandledException( void ) const;
         void                        handleException( void );
         const Value&                exception( void ) const;
-        Str                         captureStackTrace( void ) const;
+        void                        captureStackTrace( Functions& callees ) const;
 
     private:
 
-        void                        fillLocalRegisters( ValueArray& registers, int maxSize );
+        Value*                      allocateRegisters( int count, int maxStack, int maxScope );
+        void                        fillLocalRegisters( Value* registers, int maxSize );
+        bool                        isArgumentWindow( const Arguments* args ) const;
 
     private:
 
@@ -269,6 +313,9 @@ namespace avm2 {
         Value                       m_result;
         Stack                       m_stack;
         ScopeStack                  m_scope;
+        Value*                      m_storage;      //!< Registers, operand and scope stacks allocated from the FrameArena.
+        int                         m_storageSize;
+        int                         m_arenaMark;    //!< An arena mark to rewind to, when registers overlap the caller's operand stack.
     };
 
     AvmBeginClass( FunctionScript )
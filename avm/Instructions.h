@@ -28,6 +28,7 @@
 #define avm2_Instructions_h
 
 #include    "Common.h"
+#include    "Value.h"
 
 namespace avm2
 {
@@ -179,14 +180,119 @@ namespace avm2
 
         // ** Undcoumented
         ApplyType           = 0x53,
-        
-        OpCodeTotal
+
+        // ** Register instructions, emitted by RegisterTranslator and never found in ABC files
+        RegMove             = 0xd8, // dst, lhs
+        RegAdd              = 0xd9, // dst, lhs, rhs
+        RegSubtract         = 0xda, // dst, lhs, rhs
+        RegMultiply         = 0xdb, // dst, lhs, rhs
+        RegIncrement        = 0xdc, // dst, lhs
+        RegIncrementI       = 0xdd, // dst, lhs
+        RegDecrement        = 0xde, // dst, lhs
+        RegIfLess           = 0xdf, // offset, lhs, rhs
+        RegIfGreater        = 0xe0, // offset, lhs, rhs
+        RegIfLessEqual      = 0xe1, // offset, lhs, rhs
+        RegIfNotLess        = 0xe2, // offset, lhs, rhs
+        RegIfNotEqual       = 0xe3, // offset, lhs, rhs
+        RegIfTrue           = 0xe4, // offset, lhs
+        RegIfFalse          = 0xe5, // offset, lhs
+
+        // ** Superinstructions, fused by RegisterTranslator from frequent sequences
+        RegPushScope        = 0xe6, // lhs                  GetLocal; PushScope
+        RegGetProperty      = 0xe7, // dst, lhs, index      GetLocal; GetProperty
+        RegIfEquals         = 0xe8, // offset, lhs, rhs     Equals; IfTrue
+        RegIfNotEquals      = 0xe9, // offset, lhs, rhs     Equals; IfFalse
+
+        // ** Opcodes are encoded as u8
+        OpCodeTotal         = 0x100
+    };
+
+    // ** struct PropertyCache
+    //! Polymorphic inline cache of a property access instruction, maps receiver Traits to a resolved slot.
+    struct PropertyCache
+    {
+        enum {
+            MaxEntries = 4      //!< Sites that see more receiver types are megamorphic and always do a full lookup.
+        };
+
+        // ** struct Entry
+        struct Entry {
+            const Traits*   m_traits;
+            int             m_slot;     //!< Resolved slot index, zero if this receiver type can't be cached.
+        };
+
+        //! Returns a cache entry for a given receiver traits.
+        const Entry*        find( const Traits* traits ) const
+        {
+            for( int i = 0; i < m_size; i++ ) {
+                if( m_entries[i].m_traits == traits ) {
+                    return &m_entries[i];
+                }
+            }
+
+            return NULL;
+        }
+
+        //! Adds a new cache entry, does nothing once the cache is full.
+        void                add( const Traits* traits, int slot )
+        {
+            if( m_size == MaxEntries ) {
+                return;
+            }
+
+            m_entries[m_size].m_traits = traits;
+            m_entries[m_size].m_slot   = slot;
+            m_size++;
+        }
+
+        Entry               m_entries[MaxEntries];
+        int                 m_size;
+        const Traits*       m_base;     //!< Class that introduced a called method, receivers derived from it share the dispatch index.
+        int                 m_dispId;   //!< Dispatch table index of a called method, valid only with a non-null m_base.
     };
 
+    typedef array<PropertyCache> PropertyCaches;
+
+    // ** struct LexicalCache
+    //! Inline cache of a name lookup through the scope chain, valid until the Domain binding epoch changes.
+    /*! Frame scopes change with each call, so they are checked on each hit by their traits if they are instances
+     *  of a sealed class, or by an identity otherwise. Outer scopes are shared by pointer with the enclosing closure.
+     */
+    struct LexicalCache
+    {
+        enum {
+            MaxLevels = 4       //!< Lookups that pass more frame scopes are never cached.
+        };
+
+        int                 m_epoch;                //!< Domain binding epoch the cache was filled at, zero for an empty cache.
+        const ScopeChain*   m_outer;                //!< Scope chain of an enclosing closure.
+        int                 m_depth;                //!< Number of frame scopes.
+        const void*         m_keys[MaxLevels];      //!< Traits or an identity of each frame scope.
+        int                 m_level;                //!< Frame scope that holds the name, or -1 if it's held by m_object.
+        Object*             m_object;               //!< Outer scope or the global object that holds the name.
+        int                 m_slot;                 //!< Trait slot of the value, zero if the value is read dynamically.
+        Value               m_value;                //!< Value of a dynamic property of the global object.
+    };
+
+    typedef array<LexicalCache> LexicalCaches;
+
     // ** struct Instruction
     struct Instruction
     {
+        // ** enum Flags
+        //! Facts proven at link time that let instruction handlers skip runtime checks and allocations.
+        enum Flags {
+            NonNullReceiver     = 1 << 0,   //!< An object operand is never null or undefined.
+            CalleeIsFunction    = 1 << 1,   //!< A called or constructed value is always a function.
+            ValueHasType        = 1 << 2,   //!< An operand already has a type the instruction converts or coerces to.
+            UnboundCallee       = 1 << 3,   //!< A read method is only called with the object it was read from, so no closure is bound.
+        };
+
         OpCode     opCode;
+
+    #if AVM2_THREADED_DISPATCH
+        const void*         handler;    //!< Handler address inside Avm::execute, resolved once by Avm::resolveHandlers.
+    #endif
         
         union {
             struct {
@@ -206,6 +312,14 @@ namespace avm2
                 int     objectReg;
                 int     indexReg;
             };
+
+            //! Register instruction operands, branches keep their target in offset instead of dst.
+            //! A negative lhs or rhs reads constant ~index of the function's constant pool.
+            struct {
+                int     dst;
+                int     lhs;
+                int     rhs;
+            };
             
             int             offset;
             int             line;
@@ -225,6 +339,12 @@ namespace avm2
             int             ArgCount;
             int             Integer;
         };
+
+        int                 flags;      //!< A combination of Flags set by the Verifier.
+        union {
+            PropertyCache*  cache;      //!< Inline cache of a property access, owned by FunctionScript.
+            LexicalCache*   lexicalCache;   //!< Inline cache of a name lookup through the scope chain, owned by FunctionScript.
+        };
     };
     
     typedef array<Instruction> Instructions;
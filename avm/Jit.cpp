@@ -0,0 +1,1246 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "Jit.h"
+
+#if AVM2_JIT
+
+#include "Avm.h"
+#include "Object.h"
+#include "Multiname.h"
+#include "Class.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+namespace avm2
+{
+
+// ------------------------------------------------ JitHelpers ------------------------------------------------ //
+
+// ** struct JitHelpers
+//! Instruction templates, each one repeats the semantics of an interpreter handler.
+struct JitHelpers {
+
+    // ** Locals
+    static bool getLocal0( JitContext* c, const Instruction* i )        { c->m_stack->push( c->m_registers[0] ); return true; }
+    static bool getLocal1( JitContext* c, const Instruction* i )        { c->m_stack->push( c->m_registers[1] ); return true; }
+    static bool getLocal2( JitContext* c, const Instruction* i )        { c->m_stack->push( c->m_registers[2] ); return true; }
+    static bool getLocal3( JitContext* c, const Instruction* i )        { c->m_stack->push( c->m_registers[3] ); return true; }
+    static bool getLocal( JitContext* c, const Instruction* i )         { c->m_stack->push( c->m_registers[i->Integer] ); return true; }
+    static bool setLocal1( JitContext* c, const Instruction* i )        { c->m_registers[1] = c->m_stack->pop(); return true; }
+    static bool setLocal2( JitContext* c, const Instruction* i )        { c->m_registers[2] = c->m_stack->pop(); return true; }
+    static bool setLocal3( JitContext* c, const Instruction* i )        { c->m_registers[3] = c->m_stack->pop(); return true; }
+    static bool setLocal( JitContext* c, const Instruction* i )         { c->m_registers[i->Integer] = c->m_stack->pop(); return true; }
+    static bool kill( JitContext* c, const Instruction* i )             { c->m_registers[i->Integer] = Value::undefined; return true; }
+
+    // ** Scope
+    static bool pushScope( JitContext* c, const Instruction* i )        { c->m_scope->push( c->m_stack->pop().asObject() ); return true; }
+    static bool popScope( JitContext* c, const Instruction* i )         { c->m_scope->pop(); return true; }
+    static bool getScopeObject( JitContext* c, const Instruction* i )   { c->m_stack->push( c->m_scope->at( i->Integer ) ); return true; }
+    static bool getGlobalScope( JitContext* c, const Instruction* i )   { c->m_stack->push( c->m_scope->globalScope() ); return true; }
+
+    // ** Operand stack
+    static bool pushNull( JitContext* c, const Instruction* i )         { c->m_stack->push( Value::null ); return true; }
+    static bool pushUndefined( JitContext* c, const Instruction* i )    { c->m_stack->push( Value::undefined ); return true; }
+    static bool pushInteger( JitContext* c, const Instruction* i )      { c->m_stack->push( Value( i->Integer ) ); return true; }
+    static bool pushDouble( JitContext* c, const Instruction* i )       { c->m_stack->push( Value( i->Number ) ); return true; }
+    static bool pushString( JitContext* c, const Instruction* i )       { c->m_stack->push( Value( ( Object* )i->Str ) ); return true; }
+    static bool pushTrue( JitContext* c, const Instruction* i )         { c->m_stack->push( Value( true ) ); return true; }
+    static bool pushFalse( JitContext* c, const Instruction* i )        { c->m_stack->push( Value( false ) ); return true; }
+    static bool pop( JitContext* c, const Instruction* i )              { c->m_stack->pop(); return true; }
+    static bool dup( JitContext* c, const Instruction* i )              { c->m_stack->push( c->m_stack->top() ); return true; }
+    static bool swap( JitContext* c, const Instruction* i )             { c->m_stack->swap(); return true; }
+
+    // ** Arithmetic
+    static bool add( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        c->m_stack->push( Value::add( c->m_domain, a, b ) );
+        return true;
+    }
+
+    static bool subtract( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        c->m_stack->push( Value::subtract( a, b ) );
+        return true;
+    }
+
+    static bool multiply( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        c->m_stack->push( Value::multiply( a, b ) );
+        return true;
+    }
+
+    static bool negate( JitContext* c, const Instruction* i )           { c->m_stack->push( Value::negate( c->m_stack->pop() ) ); return true; }
+    static bool increment( JitContext* c, const Instruction* i )        { c->m_stack->push( Value::increment( c->m_stack->pop(), 1 ) ); return true; }
+    static bool decrement( JitContext* c, const Instruction* i )        { c->m_stack->push( Value::increment( c->m_stack->pop(), -1 ) ); return true; }
+    static bool incLocal( JitContext* c, const Instruction* i )         { c->m_registers[i->Integer] = Value::increment( c->m_registers[i->Integer], 1 ); return true; }
+    static bool decLocal( JitContext* c, const Instruction* i )         { c->m_registers[i->Integer] = Value::increment( c->m_registers[i->Integer], -1 ); return true; }
+    static bool equals( JitContext* c, const Instruction* i )           { c->m_stack->push( Value::compare( c->m_stack->pop(), c->m_stack->pop() ) ); return true; }
+
+    // ** Int arithmetic, wraps around on overflow
+    static bool addI( JitContext* c, const Instruction* i )             { Uint32 b = c->m_stack->pop().asInt(); Uint32 a = c->m_stack->pop().asInt(); c->m_stack->push( int( a + b ) ); return true; }
+    static bool subtractI( JitContext* c, const Instruction* i )        { Uint32 b = c->m_stack->pop().asInt(); Uint32 a = c->m_stack->pop().asInt(); c->m_stack->push( int( a - b ) ); return true; }
+    static bool multiplyI( JitContext* c, const Instruction* i )        { Uint32 b = c->m_stack->pop().asInt(); Uint32 a = c->m_stack->pop().asInt(); c->m_stack->push( int( a * b ) ); return true; }
+    static bool negateI( JitContext* c, const Instruction* i )          { c->m_stack->push( int( 0u - Uint32( c->m_stack->pop().asInt() ) ) ); return true; }
+    static bool incrementI( JitContext* c, const Instruction* i )       { c->m_stack->push( int( Uint32( c->m_stack->pop().asInt() ) + 1 ) ); return true; }
+    static bool decrementI( JitContext* c, const Instruction* i )       { c->m_stack->push( int( Uint32( c->m_stack->pop().asInt() ) - 1 ) ); return true; }
+    static bool incLocalI( JitContext* c, const Instruction* i )        { c->m_registers[i->Integer] = int( Uint32( c->m_registers[i->Integer].asInt() ) + 1 ); return true; }
+    static bool decLocalI( JitContext* c, const Instruction* i )        { c->m_registers[i->Integer] = int( Uint32( c->m_registers[i->Integer].asInt() ) - 1 ); return true; }
+    static bool convertToInt( JitContext* c, const Instruction* i )     { c->m_stack->push( Value( c->m_stack->pop().asInt() ) ); return true; }
+    static bool convertToUInt( JitContext* c, const Instruction* i )    { c->m_stack->push( Value( c->m_stack->pop().asUInt() ) ); return true; }
+    static bool convertToDouble( JitContext* c, const Instruction* i )  { c->m_stack->push( Value( c->m_stack->pop().asNumber() ) ); return true; }
+    static bool pushUInt( JitContext* c, const Instruction* i )         { c->m_stack->push( Value( i->UInt ) ); return true; }
+
+    // ** Bitwise
+    static bool bitAnd( JitContext* c, const Instruction* i )           { int b = c->m_stack->pop().asInt(); int a = c->m_stack->pop().asInt(); c->m_stack->push( a & b ); return true; }
+    static bool bitOr( JitContext* c, const Instruction* i )            { int b = c->m_stack->pop().asInt(); int a = c->m_stack->pop().asInt(); c->m_stack->push( a | b ); return true; }
+    static bool bitXOR( JitContext* c, const Instruction* i )           { int b = c->m_stack->pop().asInt(); int a = c->m_stack->pop().asInt(); c->m_stack->push( a ^ b ); return true; }
+    static bool bitNot( JitContext* c, const Instruction* i )           { c->m_stack->push( ~c->m_stack->pop().asInt() ); return true; }
+    static bool leftShift( JitContext* c, const Instruction* i )        { Uint32 b = c->m_stack->pop().asUInt() & 31; Uint32 a = c->m_stack->pop().asUInt(); c->m_stack->push( int( a << b ) ); return true; }
+    static bool rightShift( JitContext* c, const Instruction* i )       { Uint32 b = c->m_stack->pop().asUInt() & 31; int a = c->m_stack->pop().asInt(); c->m_stack->push( a >> b ); return true; }
+    static bool uRightShift( JitContext* c, const Instruction* i )      { Uint32 b = c->m_stack->pop().asUInt() & 31; Uint32 a = c->m_stack->pop().asUInt(); c->m_stack->push( Value( a >> b ) ); return true; }
+
+    // ** Comparison
+    static bool lessThan( JitContext* c, const Instruction* i )         { Value b = c->m_stack->pop(); Value a = c->m_stack->pop(); c->m_stack->push( Value( Value::less( a, b ) ) ); return true; }
+    static bool lessEquals( JitContext* c, const Instruction* i )       { Value b = c->m_stack->pop(); Value a = c->m_stack->pop(); c->m_stack->push( Value( Value::lessEqual( a, b ) ) ); return true; }
+    static bool greaterThan( JitContext* c, const Instruction* i )      { Value b = c->m_stack->pop(); Value a = c->m_stack->pop(); c->m_stack->push( Value( Value::less( b, a ) ) ); return true; }
+    static bool greaterEquals( JitContext* c, const Instruction* i )    { Value b = c->m_stack->pop(); Value a = c->m_stack->pop(); c->m_stack->push( Value( Value::lessEqual( b, a ) ) ); return true; }
+
+    // ** Branches
+    static bool ifTrue( JitContext* c, const Instruction* i )           { return c->m_stack->pop().asBool(); }
+    static bool ifFalse( JitContext* c, const Instruction* i )          { return c->m_stack->pop().asBool() == false; }
+    static bool ifNotEqual( JitContext* c, const Instruction* i )       { return c->m_stack->pop() != c->m_stack->pop(); }
+
+    static bool ifLess( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        return !Value::lessEqual( b, a );
+    }
+
+    static bool ifGreater( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        return Value::less( b, a );
+    }
+
+    static bool ifLessEqual( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        return Value::lessEqual( a, b );
+    }
+
+    static bool ifNotLess( JitContext* c, const Instruction* i ) {
+        Value b = c->m_stack->pop();
+        Value a = c->m_stack->pop();
+        return Value::lessEqual( b, a );
+    }
+
+    //! Called by a backward branch that exceeded the loop runaway limit.
+    static bool runAway( JitContext* c, const Instruction* i ) {
+        c->m_avm->throwError( c->m_frame, Avm::ReferenceError, "Loop runaway error" );
+        return false;
+    }
+
+    // ** Properties
+    static bool findProperty( JitContext* c, const Instruction* i ) {
+        if( Object* object = c->m_avm->findProperty( i->Identifier, i->lexicalCache, c->m_frame ) ) {
+            c->m_stack->push( Value( object ) );
+        } else {
+            c->m_stack->push( c->m_scope->globalScope() );
+        }
+        return true;
+    }
+
+    static bool findPropertyStrict( JitContext* c, const Instruction* i ) {
+        if( Object* object = c->m_avm->findProperty( i->Identifier, i->lexicalCache, c->m_frame ) ) {
+            c->m_stack->push( object );
+            return true;
+        }
+
+        c->m_avm->throwError( c->m_frame, Avm::ReferenceError, "The property '%s' could not be resolved.", i->Identifier->name().c_str() );
+        return false;
+    }
+
+    static bool getLex( JitContext* c, const Instruction* i ) {
+        if( c->m_avm->findProperty( i->Identifier, i->lexicalCache, c->m_frame, &c->m_value, true ) ) {
+            c->m_stack->push( c->m_value );
+            return true;
+        }
+
+        c->m_avm->throwError( c->m_frame, Avm::ReferenceError, "The property '%s' could not be resolved.", i->Identifier->name().c_str() );
+        return false;
+    }
+
+    static bool getProperty( JitContext* c, const Instruction* i ) {
+        c->m_avm->resolveProperty( c->m_object, c->m_value, i->Identifier, i->cache, c->m_frame, !( i->flags & Instruction::UnboundCallee ) );
+        return pushProperty( c, i, c->m_value );
+    }
+
+    static bool regGetProperty( JitContext* c, const Instruction* i ) {
+        c->m_object = operand( c, i->lhs );
+        c->m_avm->lookupProperty( c->m_object, c->m_value, i->Identifier, i->cache, !( i->flags & Instruction::UnboundCallee ) );
+
+        if( !checkObject( c, i ) ) {
+            return false;
+        }
+
+        c->m_registers[i->dst] = c->m_value;
+        return true;
+    }
+
+    static bool setProperty( JitContext* c, const Instruction* i ) {
+        if( c->m_avm->setProperty( i->Identifier, i->cache, c->m_frame, c->m_stack->pop() ) ) {
+            return true;
+        }
+
+        c->m_avm->throwError( c->m_frame, Avm::ReferenceError, "The property '%s' could not be set.", i->Identifier->name().c_str() );
+        return false;
+    }
+
+    static bool getSlot( JitContext* c, const Instruction* i )          { c->m_stack->push( c->m_stack->pop().asObject()->slot( i->Integer ) ); return true; }
+
+    static bool setSlot( JitContext* c, const Instruction* i ) {
+        Value   value  = c->m_stack->pop();
+        Object* object = c->m_stack->pop().asObject();
+
+        object->setSlot( i->Integer, value );
+        return true;
+    }
+
+    // ** Calls
+    static bool callPropVoid( JitContext* c, const Instruction* i ) {
+        return invoke( c, i, false );
+    }
+
+    static bool callProperty( JitContext* c, const Instruction* i ) {
+        return invoke( c, i, true );
+    }
+
+    static bool returnVoid( JitContext* c, const Instruction* i ) {
+        *c->m_result = Value::Undefined;
+        return true;
+    }
+
+    static bool returnValue( JitContext* c, const Instruction* i ) {
+        *c->m_result = c->m_stack->pop();
+
+        if( !( i->flags & Instruction::ValueHasType ) && !Value::coerceInPlace( *c->m_result, c->m_function->returnType() ) ) {
+            c->m_avm->throwError( c->m_frame, Avm::TypeError, "Failed to coerce return type to %s.", c->m_function->returnType()->qualifiedName().c_str() );
+            return false;
+        }
+
+        return true;
+    }
+
+    // ** Registers
+    static const Value& operand( JitContext* c, int index )             { return index >= 0 ? c->m_registers[index] : c->m_constants[~index]; }
+    static bool regMove( JitContext* c, const Instruction* i )          { c->m_registers[i->dst] = operand( c, i->lhs ); return true; }
+    static bool regSubtract( JitContext* c, const Instruction* i )      { c->m_registers[i->dst] = Value::subtract( operand( c, i->lhs ), operand( c, i->rhs ) ); return true; }
+    static bool regMultiply( JitContext* c, const Instruction* i )      { c->m_registers[i->dst] = Value::multiply( operand( c, i->lhs ), operand( c, i->rhs ) ); return true; }
+    static bool regIncrement( JitContext* c, const Instruction* i )     { c->m_registers[i->dst] = Value::increment( operand( c, i->lhs ), 1 ); return true; }
+    static bool regIncrementI( JitContext* c, const Instruction* i )    { c->m_registers[i->dst] = int( Uint32( operand( c, i->lhs ).asInt() ) + 1 ); return true; }
+    static bool regDecrement( JitContext* c, const Instruction* i )     { c->m_registers[i->dst] = Value::increment( operand( c, i->lhs ), -1 ); return true; }
+    static bool regPushScope( JitContext* c, const Instruction* i )     { c->m_scope->push( operand( c, i->lhs ).asObject() ); return true; }
+
+    static bool regAdd( JitContext* c, const Instruction* i ) {
+        c->m_registers[i->dst] = Value::add( c->m_domain, operand( c, i->lhs ), operand( c, i->rhs ) );
+        return true;
+    }
+
+    static bool regIfLess( JitContext* c, const Instruction* i )        { return !Value::lessEqual( operand( c, i->rhs ), operand( c, i->lhs ) ); }
+    static bool regIfGreater( JitContext* c, const Instruction* i )     { return Value::less( operand( c, i->rhs ), operand( c, i->lhs ) ); }
+    static bool regIfLessEqual( JitContext* c, const Instruction* i )   { return Value::lessEqual( operand( c, i->lhs ), operand( c, i->rhs ) ); }
+    static bool regIfNotLess( JitContext* c, const Instruction* i )     { return Value::lessEqual( operand( c, i->rhs ), operand( c, i->lhs ) ); }
+    static bool regIfNotEqual( JitContext* c, const Instruction* i )    { return operand( c, i->lhs ) != operand( c, i->rhs ); }
+    static bool regIfTrue( JitContext* c, const Instruction* i )        { return operand( c, i->lhs ).asBool(); }
+    static bool regIfFalse( JitContext* c, const Instruction* i )       { return operand( c, i->lhs ).asBool() == false; }
+    static bool regIfEquals( JitContext* c, const Instruction* i )      { return Value::compare( operand( c, i->lhs ), operand( c, i->rhs ) ); }
+    static bool regIfNotEquals( JitContext* c, const Instruction* i )   { return !Value::compare( operand( c, i->lhs ), operand( c, i->rhs ) ); }
+
+private:
+
+    static bool checkObject( JitContext* c, const Instruction* i ) {
+        if( i->flags & Instruction::NonNullReceiver ) {
+            return true;
+        }
+
+        if( c->m_object.isNull() ) {
+            c->m_avm->throwError( c->m_frame, Avm::TypeError, "Cannot access a property or method of a null object reference." );
+            return false;
+        }
+
+        if( c->m_object.isUndefined() ) {
+            c->m_avm->throwError( c->m_frame, Avm::TypeError, "A term is undefined and has no properties." );
+            return false;
+        }
+
+        return true;
+    }
+
+    static bool pushProperty( JitContext* c, const Instruction* i, const Value& value ) {
+        if( !checkObject( c, i ) ) {
+            return false;
+        }
+
+        c->m_stack->push( value );
+        return true;
+    }
+
+    static bool invoke( JitContext* c, const Instruction* i, bool pushResult ) {
+        c->m_stack->arguments( c->m_args, i->ArgCount );
+
+        bool resolved = c->m_avm->resolveProperty( c->m_object, c->m_value, i->Identifier, i->cache, c->m_frame );
+
+        if( !( i->flags & Instruction::NonNullReceiver ) && c->m_object.isNullOrUndefined() ) {
+            c->m_avm->throwError( c->m_frame, Avm::TypeError, pushResult ? "%s, cannot access a property or method of a null object reference." : "Failed to call property '%s', a term is undefined and has no properties.\n", i->Identifier->name().c_str() );
+            return false;
+        }
+
+        if( !resolved ) {
+            c->m_avm->throwError( c->m_frame, pushResult ? Avm::ReferenceError : Avm::TypeError, "Property %s not found on %s and there is no default value.\n", i->Identifier->name().c_str(), c->m_object.type() );
+            return false;
+        }
+
+        if( !c->m_value.isFunction() ) {
+            c->m_avm->throwError( c->m_frame, Avm::TypeError, "%s, value is not a function.", i->Identifier->name().c_str() );
+            return false;
+        }
+
+        Value result = c->m_value.asFunction()->executeWithInstance( c->m_object.asObject(), c->m_args, c->m_frame );
+
+        if( c->m_frame->hasUnhandledException() ) {
+            return false;
+        }
+
+        if( pushResult ) {
+            c->m_stack->push( result );
+        }
+
+        return true;
+    }
+};
+
+// ------------------------------------------------ CodeArena ------------------------------------------------ //
+
+// ** CodeArena::CodeArena
+CodeArena::CodeArena( int chunkSize ) : m_chunkSize( chunkSize )
+{
+
+}
+
+// ** CodeArena::~CodeArena
+CodeArena::~CodeArena( void )
+{
+    for( int i = 0, n = ( int )m_chunks.size(); i < n; i++ ) {
+    #ifdef _WIN32
+        VirtualFree( m_chunks[i].m_data, 0, MEM_RELEASE );
+    #else
+        munmap( m_chunks[i].m_data, m_chunks[i].m_size );
+    #endif
+    }
+}
+
+// ** CodeArena::commit
+void* CodeArena::commit( const Uint8* code, int size )
+{
+    Chunk* chunk = m_chunks.size() ? &m_chunks.back() : NULL;
+
+    if( chunk == NULL || chunk->m_size - chunk->m_used < size ) {
+        chunk = allocateChunk( size );
+    }
+
+    if( chunk == NULL || !protect( chunk, true ) ) {
+        return NULL;
+    }
+
+    Uint8* result = chunk->m_data + chunk->m_used;
+    memcpy( result, code, size );
+
+    // ** Keep the next function aligned to a cache line
+    chunk->m_used += ( size + 63 ) & ~63;
+    if( chunk->m_used > chunk->m_size ) {
+        chunk->m_used = chunk->m_size;
+    }
+
+    if( !protect( chunk, false ) ) {
+        return NULL;
+    }
+
+    return result;
+}
+
+// ** CodeArena::allocateChunk
+CodeArena::Chunk* CodeArena::allocateChunk( int size )
+{
+    Chunk chunk;
+    chunk.m_size = size > m_chunkSize ? ( size + 4095 ) & ~4095 : m_chunkSize;
+    chunk.m_used = 0;
+
+#ifdef _WIN32
+    chunk.m_data = ( Uint8* )VirtualAlloc( NULL, chunk.m_size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE );
+#else
+    void* data   = mmap( NULL, chunk.m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0 );
+    chunk.m_data = data == MAP_FAILED ? NULL : ( Uint8* )data;
+#endif
+
+    if( chunk.m_data == NULL ) {
+        return NULL;
+    }
+
+    m_chunks.push_back( chunk );
+    return &m_chunks.back();
+}
+
+// ** CodeArena::protect
+bool CodeArena::protect( Chunk* chunk, bool writable )
+{
+#ifdef _WIN32
+    DWORD previous;
+    return VirtualProtect( chunk->m_data, chunk->m_size, writable ? PAGE_READWRITE : PAGE_EXECUTE_READ, &previous ) != 0;
+#else
+    return mprotect( chunk->m_data, chunk->m_size, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC ) == 0;
+#endif
+}
+
+// ------------------------------------------------ Jit ------------------------------------------------ //
+
+// ** Jit::Jit
+Jit::Jit( const FunctionScript* function ) : m_instructions( function->instructions() ), m_constants( function->constants() ), m_inline( canInline() ), m_epilogue( -1 ), m_hasEntry( true )
+{
+
+}
+
+// ** Jit::compile
+bool Jit::compile( const FunctionScript* function, CodeArena* arena, array<JitCode>& entries )
+{
+    Jit jit( function );
+
+    entries.resize( function->instructions().size() + 1 );
+
+    for( int i = 0, n = ( int )entries.size(); i < n; i++ ) {
+        entries[i] = NULL;
+    }
+
+    // ** A function that leaves to the interpreter right away is not worth compiling
+    if( jit.emitBody() == 0 ) {
+        return false;
+    }
+
+    jit.emitEntries();
+
+    if( jit.m_entries.size() == 0 ) {
+        return false;
+    }
+
+    Uint8* code = ( Uint8* )arena->commit( &jit.m_code[0], jit.m_code.size() );
+
+    if( code == NULL ) {
+        return false;
+    }
+
+    for( int i = 0, n = ( int )jit.m_entries.size(); i < n; i += 2 ) {
+        entries[jit.m_entries[i]] = ( JitCode )( code + jit.m_entries[i + 1] );
+    }
+
+    return true;
+}
+
+// ** Jit::classify
+Jit::Kind Jit::classify( OpCode opCode, Helper& helper )
+{
+    helper = NULL;
+
+    switch( opCode ) {
+    case Label:
+    case Nop:
+    case Debug:
+    case DebugLine:
+    case DebugFile:
+    case Coerce:
+    case CoerceToAny:           return Skip;
+
+    case Jump:                  return Unconditional;
+
+    case GetLocal0:             helper = JitHelpers::getLocal0;             return Plain;
+    case GetLocal1:             helper = JitHelpers::getLocal1;             return Plain;
+    case GetLocal2:             helper = JitHelpers::getLocal2;             return Plain;
+    case GetLocal3:             helper = JitHelpers::getLocal3;             return Plain;
+    case GetLocal:              helper = JitHelpers::getLocal;              return Plain;
+    case SetLocal1:             helper = JitHelpers::setLocal1;             return Plain;
+    case SetLocal2:             helper = JitHelpers::setLocal2;             return Plain;
+    case SetLocal3:             helper = JitHelpers::setLocal3;             return Plain;
+    case SetLocal:              helper = JitHelpers::setLocal;              return Plain;
+    case Kill:                  helper = JitHelpers::kill;                  return Plain;
+
+    case PushScope:             helper = JitHelpers::pushScope;             return Plain;
+    case PopScope:              helper = JitHelpers::popScope;              return Plain;
+    case GetScopeObject:        helper = JitHelpers::getScopeObject;        return Plain;
+    case GetGlobalScope:        helper = JitHelpers::getGlobalScope;        return Plain;
+
+    case PushNull:              helper = JitHelpers::pushNull;              return Plain;
+    case PushUndefined:         helper = JitHelpers::pushUndefined;         return Plain;
+    case PushByte:
+    case PushShort:
+    case PushInt:               helper = JitHelpers::pushInteger;           return Plain;
+    case PushUInt:              helper = JitHelpers::pushUInt;              return Plain;
+    case PushDouble:            helper = JitHelpers::pushDouble;            return Plain;
+    case PushString:            helper = JitHelpers::pushString;            return Plain;
+    case PushTrue:              helper = JitHelpers::pushTrue;              return Plain;
+    case PushFalse:             helper = JitHelpers::pushFalse;             return Plain;
+    case Pop:                   helper = JitHelpers::pop;                   return Plain;
+    case Dup:                   helper = JitHelpers::dup;                   return Plain;
+    case Swap:                  helper = JitHelpers::swap;                  return Plain;
+
+    case Add:                   helper = JitHelpers::add;                   return Plain;
+    case Subtract:              helper = JitHelpers::subtract;              return Plain;
+    case Multiply:              helper = JitHelpers::multiply;              return Plain;
+    case Negate:                helper = JitHelpers::negate;                return Plain;
+    case Increment:             helper = JitHelpers::increment;             return Plain;
+    case Decrement:             helper = JitHelpers::decrement;             return Plain;
+    case IncLocal:              helper = JitHelpers::incLocal;              return Plain;
+    case DecLocal:              helper = JitHelpers::decLocal;              return Plain;
+    case AddI:                  helper = JitHelpers::addI;                  return Plain;
+    case SubtractI:             helper = JitHelpers::subtractI;             return Plain;
+    case MultiplyI:             helper = JitHelpers::multiplyI;             return Plain;
+    case NegateI:               helper = JitHelpers::negateI;               return Plain;
+    case IncrementI:            helper = JitHelpers::incrementI;            return Plain;
+    case DecrementI:            helper = JitHelpers::decrementI;            return Plain;
+    case IncLocalI:             helper = JitHelpers::incLocalI;             return Plain;
+    case DecLocalI:             helper = JitHelpers::decLocalI;             return Plain;
+    case ConvertToInt:          helper = JitHelpers::convertToInt;          return Plain;
+    case ConvertToUInt:         helper = JitHelpers::convertToUInt;         return Plain;
+    case ConvertToDouble:       helper = JitHelpers::convertToDouble;       return Plain;
+    case BitAnd:                helper = JitHelpers::bitAnd;                return Plain;
+    case BitOr:                 helper = JitHelpers::bitOr;                 return Plain;
+    case BitXOR:                helper = JitHelpers::bitXOR;                return Plain;
+    case BitNot:                helper = JitHelpers::bitNot;                return Plain;
+    case LeftShift:             helper = JitHelpers::leftShift;             return Plain;
+    case RightShift:            helper = JitHelpers::rightShift;            return Plain;
+    case URightShift:           helper = JitHelpers::uRightShift;           return Plain;
+    case LessThan:              helper = JitHelpers::lessThan;              return Plain;
+    case LessEquals:            helper = JitHelpers::lessEquals;            return Plain;
+    case GreaterThan:           helper = JitHelpers::greaterThan;           return Plain;
+    case GreaterEquals:         helper = JitHelpers::greaterEquals;         return Plain;
+    case Equals:
+    case StrictEquals:          helper = JitHelpers::equals;                return Plain;
+
+    case IfTrue:                helper = JitHelpers::ifTrue;                return Conditional;
+    case IfFalse:               helper = JitHelpers::ifFalse;               return Conditional;
+    case IfLess:                helper = JitHelpers::ifLess;                return Conditional;
+    case IfGreater:
+    case IfNotLessEqual:        helper = JitHelpers::ifGreater;             return Conditional;
+    case IfLessEqual:
+    case IfNotGreater:          helper = JitHelpers::ifLessEqual;           return Conditional;
+    case IfNotLess:
+    case IfGreaterEqual:        helper = JitHelpers::ifNotLess;             return Conditional;
+    case IfNotGreaterEqual:     helper = JitHelpers::ifLess;                return Conditional;
+    case IfNotEqual:
+    case IfStictNotEqual:       helper = JitHelpers::ifNotEqual;            return Conditional;
+
+    case FindProperty:          helper = JitHelpers::findProperty;          return Plain;
+    case FindPropertyStrict:    helper = JitHelpers::findPropertyStrict;    return Fallible;
+    case GetLex:                helper = JitHelpers::getLex;                return Fallible;
+    case GetProperty:           helper = JitHelpers::getProperty;           return Fallible;
+    case SetProperty:
+    case InitProperty:          helper = JitHelpers::setProperty;           return Fallible;
+    case GetSlot:               helper = JitHelpers::getSlot;               return Plain;
+    case SetSlot:               helper = JitHelpers::setSlot;               return Plain;
+    case CallPropVoid:          helper = JitHelpers::callPropVoid;          return Fallible;
+    case CallProperty:          helper = JitHelpers::callProperty;          return Fallible;
+    case ReturnVoid:            helper = JitHelpers::returnVoid;            return Return;
+    case ReturnValue:           helper = JitHelpers::returnValue;           return Return;
+
+    case RegMove:               helper = JitHelpers::regMove;               return Plain;
+    case RegAdd:                helper = JitHelpers::regAdd;                return Plain;
+    case RegSubtract:           helper = JitHelpers::regSubtract;           return Plain;
+    case RegMultiply:           helper = JitHelpers::regMultiply;           return Plain;
+    case RegIncrement:          helper = JitHelpers::regIncrement;          return Plain;
+    case RegIncrementI:         helper = JitHelpers::regIncrementI;         return Plain;
+    case RegDecrement:          helper = JitHelpers::regDecrement;          return Plain;
+    case RegPushScope:          helper = JitHelpers::regPushScope;          return Plain;
+    case RegGetProperty:        helper = JitHelpers::regGetProperty;        return Fallible;
+    case RegIfLess:             helper = JitHelpers::regIfLess;             return Conditional;
+    case RegIfGreater:          helper = JitHelpers::regIfGreater;          return Conditional;
+    case RegIfLessEqual:        helper = JitHelpers::regIfLessEqual;        return Conditional;
+    case RegIfNotLess:          helper = JitHelpers::regIfNotLess;          return Conditional;
+    case RegIfNotEqual:         helper = JitHelpers::regIfNotEqual;         return Conditional;
+    case RegIfTrue:             helper = JitHelpers::regIfTrue;             return Conditional;
+    case RegIfFalse:            helper = JitHelpers::regIfFalse;            return Conditional;
+    case RegIfEquals:           helper = JitHelpers::regIfEquals;           return Conditional;
+    case RegIfNotEquals:        helper = JitHelpers::regIfNotEquals;        return Conditional;
+
+    default:                    break;
+    }
+
+    return Unsupported;
+}
+
+// ** Jit::emitBody
+int Jit::emitBody( void )
+{
+    int     count     = ( int )m_instructions.size();
+    int     supported = 0;
+    Helper  helper;
+
+    m_labels.resize( count + 1 );
+    m_kinds.resize( count );
+
+    emitPrologue();
+
+    for( int i = 0; i < count; i++ ) {
+        const Instruction& instr = m_instructions[i];
+        Kind               kind  = classify( instr.opCode, helper );
+        int                at;
+
+        // ** Conversions the Verifier proved redundant emit no code
+        if( kind == Plain && ( instr.flags & Instruction::ValueHasType ) ) {
+            kind = Skip;
+        }
+
+        m_labels[i] = m_code.size();
+        m_kinds[i]  = kind;
+
+        // ** The function entry is useless if it leaves to the interpreter right away
+        if( kind == Unsupported && supported == 0 ) {
+            m_hasEntry = false;
+        }
+
+        // ** Int arithmetic, compares and plain Value copies run inline, the helper is called when their checks fail
+        if( ( kind == Plain || kind == Conditional ) && emitInline( instr, i, helper ) ) {
+            supported++;
+            continue;
+        }
+
+        switch( kind ) {
+        case Unsupported:   emitExit( i );
+                            break;
+
+        case Skip:          break;
+
+        case Plain:         emitCall( helper, &instr );
+                            supported++;
+                            break;
+
+        case Fallible:      emitCall( helper, &instr );
+                            m_exits.push_back( emitJcc( 0x84 ) );
+                            m_exits.push_back( i );
+                            supported++;
+                            break;
+
+        case Conditional:   emitCall( helper, &instr );
+                            supported++;
+
+                            if( instr.offset + 1 > i ) {
+                                m_fixups.push_back( emitJcc( 0x85 ) );
+                                m_fixups.push_back( instr.offset + 1 );
+                                break;
+                            }
+
+                            at = emitJcc( 0x84 );
+                            emitBackEdge( instr, i );
+                            patch( at, m_code.size() );
+                            break;
+
+        case Unconditional: if( instr.offset + 1 <= i ) {
+                                emitBackEdge( instr, i );
+                            } else {
+                                emitJump( instr.offset + 1 );
+                            }
+                            break;
+
+        case Return:        emitCall( helper, &instr );
+                            m_exits.push_back( emitJcc( 0x84 ) );
+                            m_exits.push_back( i );
+                            emitExit( -1 );
+                            supported++;
+                            break;
+        }
+    }
+
+    // ** Falling off the end finishes the call in the interpreter too
+    m_labels[count] = m_code.size();
+    emitExit( count );
+
+    // ** Exception exits resume the interpreter at the instruction that has thrown
+    for( int i = 0, n = ( int )m_exits.size(); i < n; i += 2 ) {
+        patch( m_exits[i], m_code.size() );
+        emitExit( m_exits[i + 1] );
+    }
+
+    m_epilogue = m_code.size();
+    emitEpilogue();
+
+    return supported;
+}
+
+// ** Jit::emitInline
+bool Jit::emitInline( const Instruction& instr, int index, Helper helper )
+{
+    if( !m_inline ) {
+        return false;
+    }
+
+    array<int> slow;
+    Uint8      condition = 0;
+
+    switch( instr.opCode ) {
+    case RegMove:           if( !isInt( instr.lhs ) ) {
+                                return false;
+                            }
+
+                            emitLoadRegisters();
+                            emitCheckPlain( R8, registerOffset( instr.dst ), slow );
+
+                            if( instr.lhs < 0 ) {
+                                emitLoadInt( Rax, instr.lhs, slow );
+                                emitStoreInt( instr.dst );
+                            } else {
+                                emitCheckPlain( R8, registerOffset( instr.lhs ), slow );
+                                emitCopy( R8, registerOffset( instr.lhs ), R8, registerOffset( instr.dst ) );
+                            }
+                            break;
+
+    case RegAdd:
+    case RegSubtract:       if( !isInt( instr.lhs ) || !isInt( instr.rhs ) ) {
+                                return false;
+                            }
+
+                            emitLoadRegisters();
+                            emitLoadInt( Rax, instr.lhs, slow );
+                            emitLoadInt( Rcx, instr.rhs, slow );
+                            emitCheckPlain( R8, registerOffset( instr.dst ), slow );
+                            emitOp( instr.opCode == RegAdd ? 0x01 : 0x29, Rcx, Rax, false );   // add/sub eax, ecx
+                            slow.push_back( emitBranch( 0x80 ) );                           // jo slow
+                            emitStoreInt( instr.dst );
+                            break;
+
+    case RegIncrement:
+    case RegIncrementI:
+    case RegDecrement:      if( !isInt( instr.lhs ) ) {
+                                return false;
+                            }
+
+                            emitLoadRegisters();
+                            emitLoadInt( Rax, instr.lhs, slow );
+                            emitCheckPlain( R8, registerOffset( instr.dst ), slow );
+                            emitOp( 0x83, instr.opCode == RegDecrement ? 5 : 0, Rax, false );  // add/sub eax, 1
+                            emitByte( 1 );
+
+                            // ** Numeric increments turn into a double on overflow, the int one wraps around
+                            if( instr.opCode != RegIncrementI ) {
+                                slow.push_back( emitBranch( 0x80 ) );                       // jo slow
+                            }
+                            emitStoreInt( instr.dst );
+                            break;
+
+    case RegIfLess:         condition = 0x8c;   break;                                      // jl
+    case RegIfGreater:      condition = 0x8f;   break;                                      // jg
+    case RegIfLessEqual:    condition = 0x8e;   break;                                      // jle
+    case RegIfNotLess:      condition = 0x8d;   break;                                      // jge
+    case RegIfEquals:       condition = 0x84;   break;                                      // je
+    case RegIfNotEqual:
+    case RegIfNotEquals:    condition = 0x85;   break;                                      // jne
+
+    default:                if( !emitStackInline( instr, slow ) ) {
+                                return false;
+                            }
+    }
+
+    if( condition ) {
+        if( !isInt( instr.lhs ) || !isInt( instr.rhs ) ) {
+            return false;
+        }
+
+        emitLoadRegisters();
+        emitLoadInt( Rax, instr.lhs, slow );
+        emitLoadInt( Rcx, instr.rhs, slow );
+        emitOp( 0x39, Rcx, Rax, false );                                                    // cmp eax, ecx
+    }
+
+    int  target  = instr.offset + 1;
+    bool forward = target > index;
+    int  taken   = -1;
+
+    if( condition && forward ) {
+        m_fixups.push_back( emitBranch( condition ) );
+        m_fixups.push_back( target );
+    }
+    else if( condition ) {
+        taken = emitBranch( condition );
+    }
+
+    int done = emitSkip();
+
+    // ** Slow path repeats the whole instruction in a helper, nothing was written before the checks passed
+    for( int i = 0, n = ( int )slow.size(); i < n; i++ ) {
+        patch( slow[i], m_code.size() );
+    }
+
+    emitCall( helper, &instr );
+
+    if( condition && forward ) {
+        m_fixups.push_back( emitJcc( 0x85 ) );
+        m_fixups.push_back( target );
+    }
+    else if( condition ) {
+        int notTaken = emitJcc( 0x84 );
+        patch( taken, m_code.size() );
+        emitBackEdge( instr, index );
+        patch( notTaken, m_code.size() );
+    }
+
+    patch( done, m_code.size() );
+    return true;
+}
+
+// ** Jit::emitStackInline
+bool Jit::emitStackInline( const Instruction& instr, array<int>& slow )
+{
+#if AVM2_DEBUG
+    // ** Debug builds record an instruction that pushed each Value, so the stack is only changed by helpers
+    return false;
+#else
+    int  local = instr.Integer;
+    bool push  = false;
+
+    switch( instr.opCode ) {
+    case GetLocal0:     local = 0;  push = true;    break;
+    case GetLocal1:     local = 1;  push = true;    break;
+    case GetLocal2:     local = 2;  push = true;    break;
+    case GetLocal3:     local = 3;  push = true;    break;
+    case GetLocal:                  push = true;    break;
+    case SetLocal1:     local = 1;                  break;
+    case SetLocal2:     local = 2;                  break;
+    case SetLocal3:     local = 3;                  break;
+    case SetLocal:                                  break;
+    default:            return false;
+    }
+
+    const Stack* stack    = reinterpret_cast<const Stack*>( 0x1000 );
+    int          storage  = int( reinterpret_cast<const char*>( static_cast<const ValueStorage*>( stack ) ) - reinterpret_cast<const char*>( stack ) );
+    int          values   = storage + offsetOf( &ValueStorage::m_values );
+    int          size     = storage + offsetOf( &ValueStorage::m_size );
+    int          capacity = storage + offsetOf( &ValueStorage::m_capacity );
+
+    emitLoadRegisters();
+    emitOp( 0x8b, R9, Rbx, offsetOf( &JitContext::m_stack ), true );                       // mov r9, [rbx + stack]
+    emitOp( 0x8b, Rax, R9, size, false );                                                   // mov eax, [r9 + size]
+
+    if( push ) {
+        emitOp( 0x3b, Rax, R9, capacity, false );                                           // cmp eax, [r9 + capacity]
+        slow.push_back( emitBranch( 0x8d ) );                                               // jge slow
+    } else {
+        emitOp( 0x83, 5, Rax, false );                                                      // sub eax, 1
+        emitByte( 1 );
+    }
+
+    emitOp( 0x69, Rcx, Rax, true );                                                         // imul rcx, rax, sizeof( Value )
+    emitInt32( sizeof( Value ) );
+    emitOp( 0x03, Rcx, R9, values, true );                                                  // add rcx, [r9 + values]
+
+    // ** Slots above the stack top may still hold Values of a dropped argument window
+    emitCheckPlain( Rcx, 0, slow );
+    emitCheckPlain( R8, registerOffset( local ), slow );
+
+    if( push ) {
+        emitOp( 0xff, 0, R9, size, false );                                                 // inc dword [r9 + size]
+        emitCopy( R8, registerOffset( local ), Rcx, 0 );
+        return true;
+    }
+
+    emitOp( 0x89, Rax, R9, size, false );                                                   // mov [r9 + size], eax
+    emitCopy( Rcx, 0, R8, registerOffset( local ) );
+
+#if AVM2_NAN_BOXING
+    emitMove( Rdx, Uint64( Value::TagUndefined ) << 48 );
+    emitOp( 0x89, Rdx, Rcx, 0, true );                                                      // mov [rcx], rdx
+#else
+    emitOp( 0xc7, 0, Rcx, 0, false );                                                       // mov dword [rcx], Undefined
+    emitInt32( Value::Undefined );
+#endif
+
+    return true;
+#endif  /*  AVM2_DEBUG  */
+}
+
+// ** Jit::isInt
+bool Jit::isInt( int operand ) const
+{
+    // ** Registers are checked by the emitted code, constants are known at compile time
+    return operand >= 0 || m_constants[~operand].isInt();
+}
+
+// ** Jit::emitLoadInt
+void Jit::emitLoadInt( Register destination, int operand, array<int>& slow )
+{
+    if( operand < 0 ) {
+        emitByte( 0xb8 + destination );                                                    // mov r32, constant
+        emitInt32( m_constants[~operand].asInt() );
+        return;
+    }
+
+    int offset = registerOffset( operand );
+
+#if AVM2_NAN_BOXING
+    emitOp( 0x8b, destination, R8, offset, true );                                         // mov r64, [r8 + offset]
+    emitOp( 0x89, destination, Rdx, true );                                                 // mov rdx, r64
+    emitOp( 0xc1, 5, Rdx, true );                                                           // shr rdx, 32
+    emitByte( 32 );
+    emitOp( 0x81, 7, Rdx, false );                                                          // cmp edx, TagInt << 16
+    emitInt32( Value::TagInt << 16 );
+    slow.push_back( emitBranch( 0x85 ) );                                                   // jne slow
+#else
+    emitMove( Rdx, ( Uint64( Value::NumberInt ) << 32 ) | Value::Number );
+    emitOp( 0x39, Rdx, R8, offset, true );                                                  // cmp [r8 + offset], rdx
+    slow.push_back( emitBranch( 0x85 ) );                                                   // jne slow
+    emitOp( 0x8b, destination, R8, offset + 8, false );                                     // mov r32, [r8 + offset + 8]
+#endif
+}
+
+// ** Jit::emitStoreInt
+void Jit::emitStoreInt( int operand )
+{
+    int offset = registerOffset( operand );
+
+#if AVM2_NAN_BOXING
+    emitOp( 0x89, Rax, Rax, false );                                                        // mov eax, eax
+    emitMove( Rdx, Uint64( Value::TagInt ) << 48 );
+    emitOp( 0x09, Rdx, Rax, true );                                                         // or rax, rdx
+    emitOp( 0x89, Rax, R8, offset, true );                                                  // mov [r8 + offset], rax
+#else
+    emitMove( Rdx, ( Uint64( Value::NumberInt ) << 32 ) | Value::Number );
+    emitOp( 0x89, Rdx, R8, offset, true );                                                  // mov [r8 + offset], rdx
+    emitOp( 0x89, Rax, R8, offset + 8, false );                                             // mov [r8 + offset + 8], eax
+#endif
+}
+
+// ** Jit::emitCheckPlain
+void Jit::emitCheckPlain( Register base, int offset, array<int>& slow )
+{
+    // ** Values that hold a reference are released and retained by helpers
+#if AVM2_NAN_BOXING
+    emitOp( 0x8b, Rdx, base, offset, true );                                                // mov rdx, [base + offset]
+    emitOp( 0xc1, 5, Rdx, true );                                                           // shr rdx, 48
+    emitByte( 48 );
+    emitOp( 0x81, 7, Rdx, false );                                                          // cmp edx, TagString
+    emitInt32( Value::TagString );
+    slow.push_back( emitBranch( 0x83 ) );                                                   // jae slow
+#else
+    emitOp( 0x83, 7, base, offset, false );                                                 // cmp dword [base + offset], Number
+    emitByte( Value::Number );
+    slow.push_back( emitBranch( 0x87 ) );                                                   // ja slow
+#endif
+}
+
+// ** Jit::emitCopy
+void Jit::emitCopy( Register from, int fromOffset, Register to, int toOffset )
+{
+#if AVM2_NAN_BOXING
+    int size = 8;
+#else
+    int size = 16;  // ** A type and a payload, members that hold references are unused by plain Values
+#endif
+
+    for( int i = 0; i < size; i += 8 ) {
+        emitOp( 0x8b, Rax, from, fromOffset + i, true );                                    // mov rax, [from + i]
+        emitOp( 0x89, Rax, to, toOffset + i, true );                                        // mov [to + i], rax
+    }
+}
+
+// ** Jit::emitLoadRegisters
+void Jit::emitLoadRegisters( void )
+{
+    emitOp( 0x8b, R8, Rbx, offsetOf( &JitContext::m_registers ), true );                   // mov r8, [rbx + registers]
+}
+
+// ** Jit::emitBackEdge
+void Jit::emitBackEdge( const Instruction& instr, int index )
+{
+    int header  = instr.offset + 1;
+    int runAway = offsetOf( &JitContext::m_runAway );
+
+    // ** Backward branches count towards the runaway limit, as in the interpreter
+    m_headers.push_back( header );
+
+    emitOp( 0x8b, Rax, Rbx, offsetOf( &JitContext::m_backEdges ), true );                  // mov rax, [rbx + backEdges]
+    emitOp( 0xff, 0, Rax, header * sizeof( int ), false );                                  // inc dword [rax + header]
+    emitOp( 0x8b, Rax, Rbx, runAway, false );                                               // mov eax, [rbx + runAway]
+    emitOp( 0x83, 0, Rax, false );                                                          // add eax, 1
+    emitByte( 1 );
+    emitOp( 0x89, Rax, Rbx, runAway, false );                                               // mov [rbx + runAway], eax
+    emitOp( 0x81, 7, Rax, false );                                                          // cmp eax, AvmRunAwayLimit
+    emitInt32( AvmRunAwayLimit );
+    m_fixups.push_back( emitBranch( 0x8e ) );                                               // jle header
+    m_fixups.push_back( header );
+
+    emitCall( JitHelpers::runAway, &instr );
+    emitExit( index );
+}
+
+// ** Jit::canInline
+bool Jit::canInline( void )
+{
+#if AVM2_NAN_BOXING
+    return sizeof( Value ) == 8 && offsetOf( &Value::m_bits ) == 0;
+#else
+    return sizeof( Value::eType ) == 4 && offsetOf( &Value::m_type ) == 0 && offsetOf( &Value::m_numberType ) == 4 && offsetOf( &Value::m_int ) == 8;
+#endif
+}
+
+// ** Jit::registerOffset
+int Jit::registerOffset( int index )
+{
+    return index * sizeof( Value );
+}
+
+// ** Jit::emitEntries
+void Jit::emitEntries( void )
+{
+    array<int> entered( m_labels.size() );
+
+    for( int i = 0, n = ( int )entered.size(); i < n; i++ ) {
+        entered[i] = 0;
+    }
+
+    // ** A call of a function without loops runs too few instructions to repay entering compiled code
+    if( m_headers.size() == 0 ) {
+        m_hasEntry = false;
+    }
+
+    // ** The function entry falls through to the first instruction
+    if( m_hasEntry ) {
+        m_entries.push_back( 0 );
+        m_entries.push_back( 0 );
+        entered[0] = 1;
+    }
+
+    // ** Loop headers are entered from the interpreter in the middle of a call
+    for( int i = 0, n = ( int )m_headers.size(); i < n; i++ ) {
+        int header = m_headers[i];
+
+        // ** An entry that leaves right away would bounce the interpreter back on each iteration
+        if( entered[header] || leavesAt( header ) ) {
+            continue;
+        }
+
+        entered[header] = 1;
+        m_entries.push_back( header );
+        m_entries.push_back( m_code.size() );
+
+        emitPrologue();
+        emitJump( header );
+    }
+
+    for( int i = 0, n = ( int )m_fixups.size(); i < n; i += 2 ) {
+        int target = m_fixups[i + 1];
+        patch( m_fixups[i], target < 0 ? m_epilogue : m_labels[target] );
+    }
+}
+
+// ** Jit::leavesAt
+bool Jit::leavesAt( int index ) const
+{
+    // ** Skipped instructions emit no code, so control reaches the next one
+    while( index < ( int )m_kinds.size() && m_kinds[index] == Skip ) {
+        index++;
+    }
+
+    return index == ( int )m_kinds.size() || m_kinds[index] == Unsupported;
+}
+
+// ** Jit::emitPrologue
+void Jit::emitPrologue( void )
+{
+    emitByte( 0x53 );                                   // push rbx
+#ifdef _WIN64
+    emitByte( 0x48 ); emitByte( 0x83 ); emitByte( 0xec ); emitByte( 0x20 );  // sub rsp, 32
+    emitByte( 0x48 ); emitByte( 0x89 ); emitByte( 0xcb );                   // mov rbx, rcx
+#else
+    emitByte( 0x48 ); emitByte( 0x89 ); emitByte( 0xfb );                   // mov rbx, rdi
+#endif
+}
+
+// ** Jit::emitEpilogue
+void Jit::emitEpilogue( void )
+{
+#ifdef _WIN64
+    emitByte( 0x48 ); emitByte( 0x83 ); emitByte( 0xc4 ); emitByte( 0x20 );  // add rsp, 32
+#endif
+    emitByte( 0x5b );                                   // pop rbx
+    emitByte( 0xc3 );                                   // ret
+}
+
+// ** Jit::emitCall
+void Jit::emitCall( Helper helper, const Instruction* instruction )
+{
+#ifdef _WIN64
+    emitByte( 0x48 ); emitByte( 0x89 ); emitByte( 0xd9 );                   // mov rcx, rbx
+    emitByte( 0x48 ); emitByte( 0xba );                                     // mov rdx, instruction
+#else
+    emitByte( 0x48 ); emitByte( 0x89 ); emitByte( 0xdf );                   // mov rdi, rbx
+    emitByte( 0x48 ); emitByte( 0xbe );                                     // mov rsi, instruction
+#endif
+    emitInt64( ( Uint64 )instruction );
+    emitByte( 0x48 ); emitByte( 0xb8 );                                     // mov rax, helper
+    emitInt64( ( Uint64 )helper );
+    emitByte( 0xff ); emitByte( 0xd0 );                                     // call rax
+}
+
+// ** Jit::emitExit
+void Jit::emitExit( int index )
+{
+    emitByte( 0xb8 );                                   // mov eax, index
+    emitInt32( index );
+    emitByte( 0xe9 );                                   // jmp epilogue
+    m_fixups.push_back( m_code.size() );
+    m_fixups.push_back( -1 );
+    emitInt32( 0 );
+}
+
+// ** Jit::emitJump
+void Jit::emitJump( int target )
+{
+    emitByte( 0xe9 );                                   // jmp target
+    m_fixups.push_back( m_code.size() );
+    m_fixups.push_back( target );
+    emitInt32( 0 );
+}
+
+// ** Jit::emitJcc
+int Jit::emitJcc( Uint8 condition )
+{
+    emitByte( 0x84 );                                   // test al, al
+    emitByte( 0xc0 );
+    return emitBranch( condition );
+}
+
+// ** Jit::emitBranch
+int Jit::emitBranch( Uint8 condition )
+{
+    emitByte( 0x0f );                                   // jcc rel32
+    emitByte( condition );
+
+    int at = m_code.size();
+    emitInt32( 0 );
+    return at;
+}
+
+// ** Jit::emitSkip
+int Jit::emitSkip( void )
+{
+    emitByte( 0xe9 );                                   // jmp rel32
+
+    int at = m_code.size();
+    emitInt32( 0 );
+    return at;
+}
+
+// ** Jit::emitOp
+void Jit::emitOp( Uint8 opCode, int reg, Register base, int offset, bool wide )
+{
+    // ** rsp and r12 need a SIB byte and are never used as a base
+    assert( ( base & 7 ) != Rsp );
+
+    Uint8 rex = 0x40 | ( wide ? 0x08 : 0 ) | ( reg & 8 ? 0x04 : 0 ) | ( base & 8 ? 0x01 : 0 );
+
+    if( rex != 0x40 ) {
+        emitByte( rex );
+    }
+
+    emitByte( opCode );
+
+    if( offset >= -128 && offset <= 127 ) {
+        emitByte( 0x40 | ( ( reg & 7 ) << 3 ) | ( base & 7 ) );   // [base + disp8]
+        emitByte( offset & 0xff );
+    } else {
+        emitByte( 0x80 | ( ( reg & 7 ) << 3 ) | ( base & 7 ) );   // [base + disp32]
+        emitInt32( offset );
+    }
+}
+
+// ** Jit::emitOp
+void Jit::emitOp( Uint8 opCode, int reg, Register rm, bool wide )
+{
+    Uint8 rex = 0x40 | ( wide ? 0x08 : 0 ) | ( reg & 8 ? 0x04 : 0 ) | ( rm & 8 ? 0x01 : 0 );
+
+    if( rex != 0x40 ) {
+        emitByte( rex );
+    }
+
+    emitByte( opCode );
+    emitByte( 0xc0 | ( ( reg & 7 ) << 3 ) | ( rm & 7 ) );
+}
+
+// ** Jit::emitMove
+void Jit::emitMove( Register destination, Uint64 value )
+{
+    emitByte( destination & 8 ? 0x49 : 0x48 );          // mov r64, imm64
+    emitByte( 0xb8 + ( destination & 7 ) );
+    emitInt64( value );
+}
+
+// ** Jit::emitByte
+void Jit::emitByte( Uint8 value )
+{
+    m_code.push_back( value );
+}
+
+// ** Jit::emitInt32
+void Jit::emitInt32( int value )
+{
+    for( int i = 0; i < 4; i++ ) {
+        emitByte( ( value >> ( i * 8 ) ) & 0xff );
+    }
+}
+
+// ** Jit::emitInt64
+void Jit::emitInt64( Uint64 value )
+{
+    for( int i = 0; i < 8; i++ ) {
+        emitByte( ( value >> ( i * 8 ) ) & 0xff );
+    }
+}
+
+// ** Jit::patch
+void Jit::patch( int at, int target )
+{
+    int rel = target - ( at + 4 );
+
+    for( int i = 0; i < 4; i++ ) {
+        m_code[at + i] = ( rel >> ( i * 8 ) ) & 0xff;
+    }
+}
+
+} // namespace avm2
+
+#endif  /*  AVM2_JIT    */
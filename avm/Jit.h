@@ -0,0 +1,199 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __avm2__Jit__
+#define __avm2__Jit__
+
+#include "Instructions.h"
+#include "Function.h"
+
+#if AVM2_JIT
+
+namespace avm2
+{
+    class Avm;
+
+    // ** class CodeArena
+    //! Executable memory that holds machine code of compiled functions, owned by a Domain.
+    /*! Code is never freed on its own, chunks are released with the arena. Chunks are writable only while
+     *  new code is copied to them and executable otherwise.
+     */
+    class CodeArena {
+    public:
+
+                                CodeArena( int chunkSize = 65536 );
+                                ~CodeArena( void );
+
+        //! Copies machine code to executable memory and returns its address, or NULL if memory can't be allocated.
+        void*                   commit( const Uint8* code, int size );
+
+    private:
+
+        // ** struct Chunk
+        struct Chunk {
+            Uint8*              m_data;
+            int                 m_size;
+            int                 m_used;
+        };
+
+        Chunk*                  allocateChunk( int size );
+        static bool             protect( Chunk* chunk, bool writable );
+
+    private:
+
+        array<Chunk>            m_chunks;
+        int                     m_chunkSize;
+    };
+
+    // ** struct JitContext
+    //! Interpreter state that compiled code and its helpers work on.
+    struct JitContext {
+        Avm*                    m_avm;
+        Domain*                 m_domain;
+        const FunctionScript*   m_function;
+        Frame*                  m_frame;
+        Value*                  m_registers;
+        const Value*            m_constants;    //!< Constant pool read by negative register operands.
+        Value*                  m_result;
+        int*                    m_backEdges;    //!< Per instruction counters of backward branches, shared with the interpreter.
+        Stack*                  m_stack;
+        ScopeStack*             m_scope;
+        Arguments               m_args;
+        Value                   m_object;
+        Value                   m_value;
+        int                     m_runAway;      //!< Backward branches taken, shared with the interpreter.
+    };
+
+    // ** class Jit
+    //! Baseline template compiler from linked instructions to x86-64 machine code.
+    /*! Each supported instruction becomes a call to a helper with the semantics of its interpreter handler,
+     *  so dispatch and decoding are gone. Register arithmetic, register compare-and-branch and local variable
+     *  instructions are emitted inline for int operands and Values that hold no references, the helper is only
+     *  called when these checks fail. Branches are native jumps, backward ones also count towards the loop
+     *  runaway limit.
+     *
+     *  Compiled code leaves to the interpreter on the first unsupported instruction and on any exception, by
+     *  returning the index of that instruction. The interpreter then continues the call, so exception handlers
+     *  and the rest of the opcodes keep a single implementation.
+     *
+     *  Each loop header gets an entry point, so the interpreter can move a running call to compiled code on a
+     *  backward branch (on-stack replacement). Calls enter compiled code only for functions with loops, others
+     *  run too few instructions per call to repay the context setup. Operand stack, scope stack and registers
+     *  are shared, so no state has to be converted on the way.
+     */
+    class Jit {
+    public:
+
+        //! Compiles a function, filling an entry point per instruction that is NULL where code can't be entered.
+        static bool             compile( const FunctionScript* function, CodeArena* arena, array<JitCode>& entries );
+
+    private:
+
+        //! Helper called for an instruction, returns false if an exception was thrown or a branch is not taken.
+        typedef bool            ( *Helper )( JitContext* context, const Instruction* instruction );
+
+        // ** enum Kind
+        enum Kind {
+            Unsupported,    //!< Leaves to the interpreter.
+            Skip,           //!< Emits nothing.
+            Plain,          //!< Calls a helper that never fails.
+            Fallible,       //!< Calls a helper and leaves to the interpreter if it fails.
+            Conditional,    //!< Calls a helper and jumps if it returns true.
+            Unconditional,  //!< Jumps to a target.
+            Return          //!< Calls a helper and returns from the compiled code.
+        };
+
+        // ** enum Register
+        enum Register {
+            Rax, Rcx, Rdx, Rbx, Rsp, Rbp, Rsi, Rdi, R8, R9
+        };
+
+                                Jit( const FunctionScript* function );
+
+        int                     emitBody( void );
+        bool                    emitInline( const Instruction& instruction, int index, Helper helper );
+        bool                    emitStackInline( const Instruction& instruction, array<int>& slow );
+        bool                    isInt( int operand ) const;
+        void                    emitLoadInt( Register destination, int operand, array<int>& slow );
+        void                    emitStoreInt( int operand );
+        void                    emitCheckPlain( Register base, int offset, array<int>& slow );
+        void                    emitCopy( Register from, int fromOffset, Register to, int toOffset );
+        void                    emitLoadRegisters( void );
+        void                    emitBackEdge( const Instruction& instruction, int index );
+        void                    emitEntries( void );
+        bool                    leavesAt( int index ) const;
+        void                    emitPrologue( void );
+        void                    emitEpilogue( void );
+        void                    emitCall( Helper helper, const Instruction* instruction );
+        void                    emitExit( int index );
+        void                    emitJump( int target );
+        int                     emitJcc( Uint8 condition );
+        int                     emitBranch( Uint8 condition );
+        int                     emitSkip( void );
+        void                    emitOp( Uint8 opCode, int reg, Register base, int offset, bool wide );
+        void                    emitOp( Uint8 opCode, int reg, Register rm, bool wide );
+        void                    emitMove( Register destination, Uint64 value );
+        void                    emitByte( Uint8 value );
+        void                    emitInt32( int value );
+        void                    emitInt64( Uint64 value );
+        void                    patch( int at, int target );
+
+        static Kind             classify( OpCode opCode, Helper& helper );
+        static bool             canInline( void );
+        static int              registerOffset( int index );
+
+        //! Returns an offset of a data member, offsetof is not defined for classes that hold Values.
+        template<typename TClass, typename TMember>
+        static int              offsetOf( TMember TClass::* member );
+
+    private:
+
+        const Instructions&     m_instructions;
+        const ValueArray&       m_constants;
+        bool                    m_inline;       //!< Value layout is the one the inline code expects.
+        array<Uint8>            m_code;
+        array<int>              m_labels;       //!< Machine code offset of each instruction.
+        array<int>              m_kinds;        //!< Kind of code emitted for each instruction.
+        array<int>              m_fixups;       //!< Pairs of a rel32 offset and a target instruction, -1 for the epilogue.
+        array<int>              m_exits;        //!< Pairs of a rel32 offset and an instruction to leave at.
+        array<int>              m_entries;      //!< Pairs of an instruction and a machine code offset to enter it at.
+        array<int>              m_headers;      //!< Targets of backward branches.
+        int                     m_epilogue;
+        bool                    m_hasEntry;     //!< The first instruction is worth entering compiled code at.
+    };
+
+    // ** Jit::offsetOf
+    template<typename TClass, typename TMember>
+    int Jit::offsetOf( TMember TClass::* member )
+    {
+        const TClass* instance = reinterpret_cast<const TClass*>( 0x1000 );
+        return int( reinterpret_cast<const char*>( &( instance->*member ) ) - reinterpret_cast<const char*>( instance ) );
+    }
+}
+
+#endif  /*  AVM2_JIT    */
+
+#endif /* defined(__avm2__Jit__) */
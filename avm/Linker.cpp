@@ -33,6 +33,9 @@
 #include "Avm.h"
 #include "Dump.h"
 #include "Function.h"
+#include "RegisterTranslator.h"
+#include "Optimizer.h"
+#include "Verifier.h"
 
 namespace avm2 {
 
@@ -45,7 +48,8 @@ Linker::Linker( Domain* domain, const AbcInfo* abc ) : m_domain( domain ), m_abc
 // ** Linker::link
 bool Linker::link( void )
 {
-    bool errors = false;
+    bool errors   = false;
+    bool verified = true;
 
     linkStrings();
     linkNamespaces();
@@ -86,13 +90,7 @@ bool Linker::link( void )
         scripts.push_back( linkScript( m_abc->m_script[i].get() ) );
     }
 
-    // ** Link instructions
-    for( int i = 0, n = ( int )m_functions.size(); i < n; i++ ) {
-        Instructions instructions = linkInstructions( m_functions[i].get(), &m_abc->m_method[i]->m_body );
-        m_functions[i]->setInstructions( instructions );
-    }
-
-    // ** Link exception/argument types
+    // ** Link exception/argument types, the Verifier relies on argument and return types
     for( int i = 0, n = ( int )m_functions.size(); i < n; i++ ) {
         FunctionScript*   function   = m_functions[i].get();
         const MethodInfo& signature  = *m_abc->m_method[i];
@@ -137,6 +135,47 @@ bool Linker::link( void )
         function->setArguments( args, defaults );
     }
 
+    // ** Link instructions
+    for( int i = 0, n = ( int )m_functions.size(); i < n; i++ ) {
+        const BodyInfo& body         = m_abc->m_method[i]->m_body;
+        Instructions    instructions = linkInstructions( m_functions[i].get(), &body );
+
+        Optimizer optimizer( m_domain->optimizations() );
+        optimizer.optimize( instructions, m_functions[i]->exceptions() );
+
+    #if AVM2_VERIFIER
+        // ** Runs on the stack form, so register instructions inherit flags of instructions they replace
+        Verifier verifier( m_functions[i].get(), body.m_local_count, body.m_max_stack, body.m_max_scope_depth - body.m_init_scope_depth );
+
+        if( !verifier.verify( instructions, m_functions[i]->exceptions() ) ) {
+            verified = false;
+        }
+    #endif
+
+    #if AVM2_OPCODE_STATS
+        Dump::countOpCodePairs( instructions );
+    #endif
+
+    #if AVM2_REGISTER_IR
+        RegisterTranslator translator( body.m_local_count, body.m_max_stack );
+
+        translator.translate( instructions, m_functions[i]->exceptions() );
+        m_functions[i]->setRegisters( translator.registerCount(), translator.constants() );
+
+        #if AVM2_OPCODE_STATS
+            Dump::countOpCodePairs( instructions, true );
+        #endif
+    #endif
+
+        Avm::resolveHandlers( instructions );
+        m_functions[i]->setInstructions( instructions );
+    }
+
+    // ** Code that failed verification never runs
+    if( !verified ) {
+        return true;
+    }
+
     // ** Run script initializers
     for( int i = 0, n = ( int )m_abc->m_script.size(); i < n; i++ ) {
         Script*  script  = scripts[i].get();
@@ -242,7 +281,7 @@ FunctionScript* Linker::linkFunction( const MethodInfo* methodInfo )
     const BodyInfo& body = methodInfo->m_body;
 
     Traits*         traits     = linkTraits( "", body.m_trait );
-    FunctionScript* function   = new FunctionScript( m_domain, body.m_max_stack, body.m_max_scope_depth );
+    FunctionScript* function   = new FunctionScript( m_domain, body.m_max_stack, body.m_max_scope_depth, body.m_local_count );
     function->setTraits( traits );
 
     // ** Link exceptions
@@ -351,7 +390,7 @@ Traits* Linker::linkTraits( const Str& owner, const TraitsArray& traits )
         default: assert( false );
         }
 
-        result->addTrait( owner, m_names[trait->m_name]->isQName(), valueType, value, type, slot, trait->m_attr );
+        result->addTrait( owner, m_names[trait->m_name]->isQName(), valueType, value, type, slot, trait->m_attr, type == Traits::Method ? trait->m_method.m_disp_id : 0 );
     }
 
     return result;
@@ -567,6 +606,10 @@ Instructions Linker::linkInstructions( const FunctionScript* function, const Bod
                 i += U30( instr.Integer );
                 break; // index : u30
 
+            case DecLocalI:
+                i += U30( instr.Integer );
+                break; // index : u30
+
             case DeleteProperty:
             {
                 int index;
@@ -711,7 +754,8 @@ Instructions Linker::linkInstructions( const FunctionScript* function, const Bod
                 i += S24( instr.defaultOffset );
                 i += U30( instr.caseCount );
 
-                instr.caseOffsets = new int[instr.caseCount];
+                // ** case_count is the index of the last case, so there are case_count + 1 offsets
+                instr.caseOffsets = new int[instr.caseCount + 1];
                 for( int j = 0; j <= instr.caseCount; j++ ) {
                     i += S24( instr.caseOffsets[j] );
                 }
@@ -857,7 +901,6 @@ Instructions Linker::linkInstructions( const FunctionScript* function, const Bod
             case ConvertToObject:   break;
             case ConvertToUInt:     break;
             case ConvertToString:   break;
-            case DecLocalI:         break;
             case Decrement:         break;
             case DecrementI:        break;
             case Divide:            break;
@@ -905,6 +948,10 @@ Instructions Linker::linkInstructions( const FunctionScript* function, const Bod
             case SubtractI:         break;
             case StrictEquals:      break;
             case URightShift:       break;
+
+            // ** Register instructions and superinstructions are emitted by RegisterTranslator
+            //    after linking, they never appear in ABC bytecode and have no operands to read here
+            default:                break;
         }
 
         result.push_back( instr );
@@ -947,7 +994,7 @@ Instructions Linker::linkInstructions( const FunctionScript* function, const Bod
                 int currentOffset = instructionToOffset[i];
 
                 instr.defaultOffset = offsetToInstruction[currentOffset + instr.defaultOffset];
-                for( int j = 0; j < instr.caseCount + 1; j++ ) {
+                for( int j = 0; j <= instr.caseCount; j++ ) {
                     instr.caseOffsets[j] = offsetToInstruction[currentOffset + instr.caseOffsets[j]];
                 }
             }
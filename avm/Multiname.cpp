@@ -69,6 +69,14 @@ Namespace::Kind Namespace::kind( void ) const
     return m_kind;
 }
 
+// ------------------------------------------------ Atom ------------------------------------------------ //
+
+// ** Atom::Atom
+Atom::Atom( const Str& value ) : m_value( value ), m_hash( string_hash<int>::compute_hash( value ) )
+{
+
+}
+
 // ------------------------------------------------ Name ------------------------------------------------ //
 
 // ** Name::Name
@@ -137,7 +145,9 @@ bool RTQName::hasRuntimeNamespace( void ) const
 // ** RTQName::setName
 void RTQName::setName( const Str& value ) const
 {
-    const_cast<RTQName*>( this )->m_name = value;
+    RTQName* self = const_cast<RTQName*>( this );
+    self->m_name = value;
+    self->intern();
 }
 
 // ------------------------------------------------- RTQNameL ------------------------------------------------- //
@@ -163,7 +173,9 @@ bool RTQNameL::hasRuntimeNamespace( void ) const
 // ** RTQNameL::setNamespace
 void RTQNameL::setNamespace( Namespace* value ) const
 {
-    const_cast<RTQNameL*>( this )->m_namespace = value;
+    RTQNameL* self = const_cast<RTQNameL*>( this );
+    self->m_namespace = value;
+    self->intern();
 }
 
 // ------------------------------------------------ QName ------------------------------------------------ //
@@ -171,16 +183,39 @@ void RTQNameL::setNamespace( Namespace* value ) const
 // ** QName::QName
 QName::QName( const Str& name, Namespace* ns ) : Name( name ), m_namespace( ns )
 {
+    intern();
+}
+
+// ** QName::intern
+void QName::intern( void )
+{
+    if( m_namespace == NULL ) {
+        return;
+    }
+
+    const Str& ns = m_namespace->uri();
+    m_atom = Atom( ns == "" ? m_name : ns + "." + m_name );
+}
 
+// ** QName::setName
+void QName::setName( const Str& value )
+{
+    Name::setName( value );
+    intern();
 }
 
 // ** QName::qualifiedName
-Str QName::qualifiedName( void ) const
+const Str& QName::qualifiedName( void ) const
 {
     assert( m_namespace );
+    return m_atom.m_value;
+}
 
-    const Str& ns = m_namespace->uri();
-    return ns == "" ? m_name : ns + "." + m_name;
+// ** QName::atom
+const Atom& QName::atom( void ) const
+{
+    assert( m_namespace );
+    return m_atom;
 }
 
 // ** QName::isQName
@@ -200,7 +235,24 @@ const Namespace* QName::ns( void ) const
 // ** Multiname::Multiname
 Multiname::Multiname( const Str& name, const Namespaces& namespaces ) : Name( name ), m_namespaces( namespaces )
 {
+    intern();
+}
+
+// ** Multiname::intern
+void Multiname::intern( void )
+{
+    m_atoms.resize( count() );
 
+    for( int i = 0, n = count(); i < n; i++ ) {
+        m_atoms[i] = atom( i, m_name );
+    }
+}
+
+// ** Multiname::setName
+void Multiname::setName( const Str& value )
+{
+    Name::setName( value );
+    intern();
 }
 
 // ** Multiname::isMultiname
@@ -222,13 +274,25 @@ int Multiname::count( void ) const
 }
 
 // ** Multiname::qualifiedName
-Str Multiname::qualifiedName( int index ) const
+const Str& Multiname::qualifiedName( int index ) const
+{
+    return atom( index ).m_value;
+}
+
+// ** Multiname::atom
+const Atom& Multiname::atom( int index ) const
+{
+    assert( index >= 0 && index < count() );
+    return m_atoms[index];
+}
+
+// ** Multiname::atom
+Atom Multiname::atom( int index, const Str& name ) const
 {
     assert( index >= 0 && index < count() );
-    const Namespace* ns  = m_namespaces[index];
-    const Str&       uri = ns->uri();
 
-    return uri == "" ? m_name : uri + "." + m_name;
+    const Str& uri = m_namespaces[index]->uri();
+    return Atom( uri == "" ? name : uri + "." + name );
 }
 
 // -------------------------------------------------- MultinameLate ------------------------------------------------ //
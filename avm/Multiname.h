@@ -61,6 +61,17 @@ namespace avm2 {
         Kind            m_kind;
     };
 
+    // ** struct Atom
+    //! A qualified property name with a precomputed hash, built once when a name is linked.
+    struct Atom {
+                                    Atom( const Str& value = "" );
+
+        Str                         m_value;    //!< Qualified name string.
+        int                         m_hash;     //!< Hash value used by string_hash lookups.
+    };
+
+    typedef array<Atom>             Atoms;
+
     // ** class Name
     class Name : public ref_counted {
     public:
@@ -68,7 +79,7 @@ namespace avm2 {
                                     Name( const Str& name );
 
         const Str&                  name( void ) const;
-        void                        setName( const Str& value );
+        virtual void                setName( const Str& value );
 
         virtual bool                hasRuntimeName( void ) const;
         virtual bool                hasRuntimeNamespace( void ) const;
@@ -89,15 +100,23 @@ namespace avm2 {
                                     QName( const Str& name, Namespace* ns );
 
         // ** Name
+        virtual void                setName( const Str& value );
         virtual const QName*        isQName( void ) const;
 
         // ** QName
-        Str                         qualifiedName( void ) const;
+        const Str&                  qualifiedName( void ) const;
+        const Atom&                 atom( void ) const;
         const Namespace*            ns( void ) const;
 
+    protected:
+
+        //! Builds the qualified name atom for a current name and namespace.
+        void                        intern( void );
+
     protected:
 
         NamespacePtr                m_namespace;
+        Atom                        m_atom;
     };
 
     // ** class RTQName
@@ -134,16 +153,26 @@ namespace avm2 {
                                     Multiname( const Str& name, const Namespaces& namespaces );
 
         // ** Name
+        virtual void                setName( const Str& value );
         virtual const Multiname*    isMultiname( void ) const;
 
         // ** Multiname
         const Namespaces&           namespaces( void ) const;
         int                         count( void ) const;
-        Str                         qualifiedName( int index ) const;
+        const Str&                  qualifiedName( int index ) const;
+        const Atom&                 atom( int index ) const;
+        //! Returns an atom of a given runtime name qualified with a namespace at a given index.
+        Atom                        atom( int index, const Str& name ) const;
+
+    private:
+
+        //! Builds the qualified name atoms for a current name and each namespace in the set.
+        void                        intern( void );
 
     private:
 
         Namespaces                  m_namespaces;
+        Atoms                       m_atoms;
     };
 
     // ** class MultinameL
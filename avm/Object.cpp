@@ -35,7 +35,7 @@ namespace avm2
 {
 
 // ** Object::Object
-Object::Object( Domain* domain ) : m_domain( domain ), m_isInsideToString( false )
+Object::Object( Domain* domain ) : m_domain( domain ), m_dynamic( NULL ), m_isInsideToString( false ), m_isScope( false ), m_hasInlineSlots( false ), m_slotCount( 0 ), m_slots( NULL )
 {
     assert( m_domain );
     m_class = m_domain->findClass( "Object" );
@@ -43,7 +43,16 @@ Object::Object( Domain* domain ) : m_domain( domain ), m_isInsideToString( false
 
 Object::~Object()
 {
+    delete m_dynamic;
 
+    if( !m_hasInlineSlots ) {
+        delete[] m_slots;
+        return;
+    }
+
+    for( int i = 0; i < m_slotCount; i++ ) {
+        m_slots[i].~Value();
+    }
 }
 
 // ** Object::domain
@@ -67,7 +76,7 @@ void Object::setType( Class* value )
 // called from a object constructor only
 void Object::builtin_member( const Str& name, const Value& val )
 {
-    m_members.set(name, val);
+    storeMember( name, val );
 }
 
 // ** Object::setMember
@@ -84,11 +93,116 @@ bool Object::set_member( const Str& name, const Value& value )
     }
 
     // ** Set object member
-    m_members.set( name, value );
+    storeMember( name, value );
 
     return true;
 }
 
+// ** Object::findMember
+bool Object::findMember( const Str& name, Value* value ) const
+{
+    if( m_dynamic == NULL ) {
+        return false;
+    }
+
+#if AVM2_HIDDEN_CLASSES
+    if( m_dynamic->m_shape != NULL ) {
+        int index = m_dynamic->m_shape->find( name );
+
+        if( index < 0 ) {
+            return false;
+        }
+
+        if( value ) *value = m_dynamic->m_properties[index];
+        return true;
+    }
+#endif
+
+    return m_dynamic->m_members.get( name, value );
+}
+
+// ** Object::dynamicProperties
+DynamicProperties* Object::dynamicProperties( void )
+{
+    if( m_dynamic != NULL ) {
+        return m_dynamic;
+    }
+
+    m_dynamic = new DynamicProperties;
+#if AVM2_HIDDEN_CLASSES
+    m_dynamic->m_shape = m_domain->rootShape();
+#endif
+
+    return m_dynamic;
+}
+
+// ** Object::storeMember
+void Object::storeMember( const Str& name, const Value& value )
+{
+    // ** Global values are cached by name lookups, so any write to a scope object invalidates them
+    if( m_isScope ) {
+        m_domain->invalidateBindings();
+    }
+
+    DynamicProperties* dynamic = dynamicProperties();
+
+#if AVM2_HIDDEN_CLASSES
+    if( dynamic->m_shape != NULL ) {
+        int index = dynamic->m_shape->find( name );
+
+        if( index >= 0 ) {
+            dynamic->m_properties[index] = value;
+            return;
+        }
+
+        if( Shape* shape = dynamic->m_shape->transition( name ) ) {
+            dynamic->m_shape = shape;
+            dynamic->m_properties.push_back( value );
+            return;
+        }
+
+        convertToDictionary();
+    }
+#endif
+
+    dynamic->m_members.set( name, value );
+}
+
+// ** Object::reserveMembers
+void Object::reserveMembers( int count )
+{
+    DynamicProperties* dynamic = dynamicProperties();
+
+#if AVM2_HIDDEN_CLASSES
+    if( dynamic->m_shape != NULL ) {
+        dynamic->m_properties.reserve( dynamic->m_shape->size() + count );
+        return;
+    }
+#endif
+
+    dynamic->m_members.set_capacity( dynamic->m_members.size() + count );
+}
+
+// ** Object::convertToDictionary
+void Object::convertToDictionary( void )
+{
+#if AVM2_HIDDEN_CLASSES
+    if( m_dynamic == NULL || m_dynamic->m_shape == NULL ) {
+        return;
+    }
+
+    const Shape* shape = m_dynamic->m_shape.get();
+    m_dynamic->m_members.set_capacity( shape->size() );
+
+    for( int i = 0, n = shape->size(); i < n; i++ ) {
+        m_dynamic->m_members.set( shape->name( i ), m_dynamic->m_properties[i] );
+    }
+
+    m_dynamic->m_shape = NULL;
+    m_dynamic->m_properties.clear();
+#endif
+}
+
 // ** Object::resolveProperty
 bool Object::resolveProperty( const Str& name, Value* value ) const
 {
@@ -106,18 +220,33 @@ bool Object::resolveProperty( const Str& name, Value* value ) const
     return const_cast<Object*>( this )->get_member( name, value );
 }
 
+// ** Object::resolveProperty
+bool Object::resolveProperty( const Atom& name, Value* value ) const
+{
+    if( m_traits != NULL ) {
+        int  idx    = -1;
+
+        if( m_traits->resolveSlot( name, TraitRead, idx ) ) {
+            if( value ) *value = m_slots[idx];
+            return true;
+        }
+    }
+
+    return const_cast<Object*>( this )->get_member( name.m_value, value );
+}
+
 // ** Object::resolveProperty
 bool Object::resolveProperty( const Name* name, Value* value ) const
 {
     if( const Multiname* mname = name->isMultiname() ) {
         for( int i = 0, n = mname->count(); i < n; i++ ) {
-            if( resolveProperty( mname->qualifiedName( i ), value ) ) {
+            if( resolveProperty( mname->atom( i ), value ) ) {
                 return true;
             }
         }
     }
     else {
-        return resolveProperty( name->isQName()->qualifiedName(), value );
+        return resolveProperty( name->isQName()->atom(), value );
     }
 
     return false;
@@ -146,50 +275,180 @@ bool Object::setProperty( const Str& name, const Value& value )
     return set_member( name, value );
 }
 
+// ** Object::setProperty
+bool Object::setProperty( const Atom& name, const Value& value )
+{
+    if( m_traits != NULL ) {
+        int  idx    = -1;
+
+        if( m_traits->resolveSlot( name, TraitWrite, idx ) ) {
+            setSlot( idx, value );
+            return true;
+        }
+    }
+
+    if( m_class != NULL && m_class->isSealed() ) {
+        return false;
+    }
+
+    return set_member( name.m_value, value );
+}
+
 // ** Object::setProperty
 bool Object::setProperty( const Name* name, const Value& value )
 {
     if( const Multiname* mname = name->isMultiname() ) {
         for( int i = 0, n = mname->count(); i < n; i++ ) {
-            if( setProperty( mname->qualifiedName( i ), value ) ) {
+            if( setProperty( mname->atom( i ), value ) ) {
                 return true;
             }
         }
     } else {
-        return setProperty( name->isQName()->qualifiedName(), value );
+        return setProperty( name->isQName()->atom(), value );
     }
 
     return false;
 }
 
+// ** Object::resolveProperty
+bool Object::resolveProperty( const Name* name, const Str& runtimeName, Value* value ) const
+{
+    const Multiname* mname = name->isMultiname();
+
+    if( !mname ) {
+        return resolveProperty( runtimeName, value );
+    }
+
+    for( int i = 0, n = mname->count(); i < n; i++ ) {
+        if( resolveProperty( mname->atom( i, runtimeName ), value ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ** Object::setProperty
+bool Object::setProperty( const Name* name, const Str& runtimeName, const Value& value )
+{
+    const Multiname* mname = name->isMultiname();
+
+    if( !mname ) {
+        return setProperty( runtimeName, value );
+    }
+
+    for( int i = 0, n = mname->count(); i < n; i++ ) {
+        if( setProperty( mname->atom( i, runtimeName ), value ) ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ** Object::getElement
+bool Object::getElement( const Name* name, int index, Value* value ) const
+{
+    return resolveProperty( name, Value( index ).asStringCopy(), value );
+}
+
+// ** Object::setElement
+bool Object::setElement( const Name* name, int index, const Value& value )
+{
+    return setProperty( name, Value( index ).asStringCopy(), value );
+}
+
+// ** Object::resolveCacheableSlot
+int Object::resolveCacheableSlot( const Name* name ) const
+{
+    if( m_traits == NULL || name->hasRuntimeName() || name->hasRuntimeNamespace() ) {
+        return -1;
+    }
+
+    // ** Dynamic members of unsealed objects may shadow traits from the following namespaces
+    const Multiname* mname  = name->isMultiname();
+    const QName*     qname  = name->isQName();
+    bool             sealed = m_class != NULL && m_class->isSealed();
+
+    if( !mname && !qname ) {
+        return -1;
+    }
+
+    for( int i = 0, n = mname ? mname->count() : 1; i < n; i++ ) {
+        const Atom& atom = mname ? mname->atom( i ) : qname->atom();
+        int         slot = -1;
+
+        if( m_traits->resolveSlot( atom, TraitRead, slot ) ) {
+            return slot;
+        }
+
+        if( !sealed || const_cast<Object*>( this )->get_member( atom.m_value, NULL ) ) {
+            return -1;
+        }
+    }
+
+    return -1;
+}
+
 // ** Object::getMember
 bool Object::get_member( const Str& name, Value* value )
 {
-    if( m_members.get( name, value ) == false ) {
+    if( findMember( name, value ) == false ) {
         return m_class != NULL ? m_class->findBuiltIn( name, value ) : false;
     }
 
     return true;
 }
 
-// ** Object::createIterator
-IteratorPtr Object::createIterator( const Value& value )
+// ** Object::nextIndex
+int Object::nextIndex( int index ) const
 {
-    return new ObjectIterator( &m_members, value );
+    if( m_dynamic == NULL ) {
+        return 0;
+    }
+
+#if AVM2_HIDDEN_CLASSES
+    // ** Inline properties are enumerated in the order they were added
+    if( m_dynamic->m_shape != NULL ) {
+        return index < m_dynamic->m_shape->size() ? index + 1 : 0;
+    }
+#endif
+
+    return m_dynamic->m_members.next_index( index ) + 1;
 }
 
-// ** Object::nextKey
-Value Object::nextKey( const Value& key ) const
+// ** Object::nameAt
+Value Object::nameAt( int index ) const
 {
-    Members::const_iterator it = m_members.find( key.asString() );
-    return it != m_members.end() ? it->first.c_str() : "";
+    if( m_dynamic == NULL ) {
+        return "";
+    }
+
+#if AVM2_HIDDEN_CLASSES
+    if( const Shape* shape = m_dynamic->m_shape.get() ) {
+        return index > 0 && index <= shape->size() ? shape->name( index - 1 ).c_str() : "";
+    }
+#endif
+
+    const Members& members = m_dynamic->m_members;
+    return index > 0 && members.next_index( index - 1 ) == index - 1 ? members.key_at( index - 1 ).c_str() : "";
 }
 
-// ** Object::getPropertyByKey
-Value Object::getPropertyByKey( const Value& key ) const
+// ** Object::valueAt
+Value Object::valueAt( int index ) const
 {
-    Members::const_iterator it = m_members.find( key.asString() );
-    return it != m_members.end() ? it->second : Value::undefined;
+    if( m_dynamic == NULL ) {
+        return Value::undefined;
+    }
+
+#if AVM2_HIDDEN_CLASSES
+    if( m_dynamic->m_shape != NULL ) {
+        return index > 0 && index <= m_dynamic->m_shape->size() ? m_dynamic->m_properties[index - 1] : Value::undefined;
+    }
+#endif
+
+    const Members& members = m_dynamic->m_members;
+    return index > 0 && members.next_index( index - 1 ) == index - 1 ? members.value_at( index - 1 ) : Value::undefined;
 }
 
 // ** Object::deletePropertyByName
@@ -199,12 +458,17 @@ bool Object::deletePropertyByName( const Str& name )
         return false;
     }
 
-    Members::iterator it = m_members.find( name );
-    if( it == m_members.end() ) {
+    if( !findMember( name, NULL ) ) {
         return false;
     }
 
-    m_members.set( name, NULL );
+    // ** Shapes only describe growing objects, so deleting a property switches to the dictionary mode
+    convertToDictionary();
+    m_dynamic->m_members.set( name, NULL );
+
+    if( m_isScope ) {
+        m_domain->invalidateBindings();
+    }
     return true;
 }
 
@@ -241,28 +505,17 @@ const char* Object::to_string( void )
 // ** Object::enclose
 FunctionClosure* Object::enclose( Function* function ) const
 {
-    FunctionClosureWeak cached;
-
-    // ** Search for a cached closure
-    if( m_closures.get( function, &cached ) && cached != NULL ) {
-        return cached.get_ptr();
-    }
-
-    // ** Create a new function closure
-    FunctionClosure* closure = new FunctionClosure( m_domain, const_cast<Object*>( this ), function );
-    m_closures[function] = closure;
-
-    return closure;
+    return m_domain->enclose( const_cast<Object*>( this ), function );
 }
 
 // ** Object::setSlot
 void Object::setSlot( int index, const Value& value )
 {
-    if( index >= m_slots.size() ) {
-        m_slots.resize( index + 1 );
+    if( index >= m_slotCount ) {
+        reserveSlots( index + 1 );
     }
 
-    assert( index >= 0 && index < m_slots.size() );
+    assert( index >= 0 && index < m_slotCount );
 
     if( Property* property = m_slots[index].asProperty() ) {
         property->set( this, value );
@@ -274,18 +527,49 @@ void Object::setSlot( int index, const Value& value )
 // ** Object::slot
 const Value& Object::slot( int index ) const
 {
-    assert( index >= 0 && index < m_slots.size() );
+    assert( index >= 0 && index < m_slotCount );
     return m_slots[index];
 }
 
+// ** Object::reserveSlots
+void Object::reserveSlots( int count )
+{
+    if( count <= m_slotCount ) {
+        return;
+    }
+
+    // ** Slots outgrew the storage they were allocated with, so they move to the heap
+    Value* slots = new Value[count];
+
+    for( int i = 0; i < m_slotCount; i++ ) {
+        slots[i] = m_slots[i];
+    }
+
+    if( m_hasInlineSlots ) {
+        for( int i = 0; i < m_slotCount; i++ ) {
+            m_slots[i].~Value();
+        }
+    } else {
+        delete[] m_slots;
+    }
+
+    m_slots          = slots;
+    m_slotCount      = count;
+    m_hasInlineSlots = false;
+}
+
 // ** Object::setTraits
 void Object::setTraits( const Traits* value )
 {
     m_traits = const_cast<Traits*>( value );
 
     if( m_traits != NULL ) {
-        m_slots.resize( m_traits->slotCount() + 1 );
-        m_traits->setSlots( m_slots );
+        reserveSlots( m_traits->slotCount() + 1 );
+        m_traits->setSlots( m_slots, m_slotCount );
+    }
+
+    if( m_isScope ) {
+        m_domain->invalidateBindings();
     }
 }
 
@@ -295,6 +579,12 @@ const Traits* Object::traits( void ) const
     return m_traits.get();
 }
 
+// ** Object::markAsScope
+void Object::markAsScope( void )
+{
+    m_isScope = true;
+}
+
 // ** Object::prototype
 Object* Object::prototype( void ) const
 {
@@ -321,9 +611,15 @@ void Object::clear_refs( hash<Object*, bool>* visited_objects, Object* this_ptr
     }
     visited_objects->set(this, true);
 
+    if (m_dynamic == NULL)
+    {
+        return;
+    }
+    convertToDictionary();
+
     Value undefined;
-    for (string_hash<Value>::iterator it = m_members.begin();
-        it != m_members.end(); ++it)
+    for (string_hash<Value>::iterator it = m_dynamic->m_members.begin();
+        it != m_dynamic->m_members.end(); ++it)
     {
         Object* obj = it->second.asObject();
         if (obj)
@@ -346,10 +642,11 @@ void Object::copy_to(Object* target)
 {
     assert(false);
 
-    if (target)
+    if (target && m_dynamic)
     {
-        for (string_hash<Value>::const_iterator it = m_members.begin();
-            it != m_members.end(); ++it ) 
+        convertToDictionary();
+        for (string_hash<Value>::const_iterator it = m_dynamic->m_members.begin();
+            it != m_dynamic->m_members.end(); ++it ) 
         { 
             target->set_member(it->first, it->second); 
         } 
@@ -449,36 +746,6 @@ double	Object::to_number()
     return 0;
 }
 
-// ** ObjectIterator::ObjectIterator
-ObjectIterator::ObjectIterator( Members* members, const Value& key ) : m_members( members ), m_iterator( m_members->begin() )
-{
-    if( key.isNumber() ) {
-        return;
-    }
-
-    m_iterator = m_members->find( key.asCString() );
-    next();
-}
-
-// ** ObjectIterator::hasNext
-bool ObjectIterator::hasNext( void ) const
-{
-    return m_iterator != m_members->end();
-}
-
-// ** ObjectIterator::next
-void ObjectIterator::next( void )
-{
-    ++m_iterator;
-}
-
-// ** ObjectIterator::key
-Value ObjectIterator::key( void ) const
-{
-    return m_iterator->first.c_str();
-}
-
-
 // ** XML::XML
 XML::XML( Domain* domain ) : Object( domain )
 {
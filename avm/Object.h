@@ -27,7 +27,10 @@
 #ifndef avm2_OBJECT_H
 #define avm2_OBJECT_H
 
+#include <new>
+
 #include "Value.h"
+#include "Shape.h"
 
 #define AvmDeclareObjectType( id )  enum { m_class_id = id };   \
                                     virtual bool is( int classId ) const { return m_class_id == classId; }
@@ -39,32 +42,17 @@ namespace avm2
 {
     typedef string_hash<Value> Members;
 
-    // ** class Iterator
-    class Iterator : public ref_counted {
-    public:
-
-        virtual             ~Iterator( void ) {}
-
-        virtual bool        hasNext( void ) const   = 0;
-        virtual void        next( void )            = 0;
-        virtual Value       key( void ) const       = 0;
-    };
-
-    // ** class ObjectIterator
-    class ObjectIterator : public Iterator {
-    public:
-
-                            ObjectIterator( Members* members, const Value& key );
-
-        // ** Iterator
-        virtual bool        hasNext( void ) const;
-        virtual void        next( void );
-        virtual Value       key( void ) const;
-
-    private:
-
-        Members*            m_members;
-        Members::iterator   m_iterator;
+    // ** struct DynamicProperties
+    //! Dynamic properties of an object, allocated once the object gets its first one.
+    struct DynamicProperties {
+        //! Properties of an object in a dictionary mode.
+        Members                     m_members;
+    #if AVM2_HIDDEN_CLASSES
+        //! Shape of inline dynamic properties, NULL once the object has switched to a dictionary mode.
+        ShapePtr                    m_shape;
+        //! Inline dynamic property values indexed by the shape.
+        ValueArray                  m_properties;
+    #endif
     };
 
     // ** class Object
@@ -77,6 +65,10 @@ namespace avm2
 
                                     Object( Domain* domain );
 		virtual                     ~Object( void );
+
+        //! Allocates an object of a given type with a storage for a given number of slots right after it.
+        template<typename TObject>
+        static TObject*             createWithSlots( Domain* domain, int slotCount );
 		
 		virtual const char*         to_string( void );
 		virtual double              to_number( void );
@@ -86,7 +78,7 @@ namespace avm2
         virtual Value               valueOf( void ) const;
         //! Returns a parent domain.
         Domain*                     domain( void ) const;
-		//! Returns a closure of a given Function that is associated with this Object.
+		//! Returns a closure of a given Function that is associated with this Object, closures are cached by the Domain.
         FunctionClosure*            enclose( Function* function ) const;
 		//! Returns a Value of a slot at a given index.
         const Value&                slot( int index ) const;
@@ -94,6 +86,8 @@ namespace avm2
         void                        setSlot( int index, const Value& value );
 		//! Returns Traits object associated with this Object.
         const Traits*               traits( void ) const;
+        //! Marks an object that is used as a scope.
+        void                        markAsScope( void );
 		//! Sets a Traits of this object.
         void                        setTraits( const Traits* value );
 		//! Returns a Class of this object.
@@ -106,18 +100,34 @@ namespace avm2
         bool                        hasOwnProperty( const Str& name ) const;
 		//! Resolves a property inside this object by a given name and access scope.
         bool                        resolveProperty( const Str& name, Value* value ) const;
+		//! Resolves a property inside this object by a given qualified name atom.
+        bool                        resolveProperty( const Atom& name, Value* value ) const;
 		//! Resolves a property inside this object by a given multiname and access scope.
         bool                        resolveProperty( const Name* name, Value* value ) const;
 		//! Sets a property inside this object with a given name and access scope.
         bool                        setProperty( const Str& name, const Value& value );
+        //! Sets a property inside this object with a given qualified name atom.
+        bool                        setProperty( const Atom& name, const Value& value );
         //! Sets a property inside this object with a given name and access scope.
         bool                        setProperty( const Name* name, const Value& value );
-        //! Creates a new iterator instance by a given property key.
-        virtual IteratorPtr         createIterator( const Value& value );
-        //! Returns a next key for iterator.
-        virtual Value               nextKey( const Value& key ) const;
-        //! Returns a value of dynamic object property by a given key.
-        virtual Value               getPropertyByKey( const Value& key ) const;
+        //! Resolves a property by a runtime name qualified with each namespace of a given multiname.
+        bool                        resolveProperty( const Name* name, const Str& runtimeName, Value* value ) const;
+        //! Sets a property by a runtime name qualified with each namespace of a given multiname.
+        bool                        setProperty( const Name* name, const Str& runtimeName, const Value& value );
+        //! Reads an element at a given index, objects without indexed storage resolve the index as a runtime name of a given multiname.
+        virtual bool                getElement( const Name* name, int index, Value* value ) const;
+        //! Writes an element at a given index, objects without indexed storage set the index as a runtime name of a given multiname.
+        virtual bool                setElement( const Name* name, int index, const Value& value );
+
+        //! Returns a trait slot that a given name resolves to for any object sharing these traits, or -1 if the lookup can't be cached.
+        int                         resolveCacheableSlot( const Name* name ) const;
+        //! Returns an enumeration cursor of the next dynamic property after a given one, or zero if there are no more properties.
+        /*! A cursor is a 1-based position inside the property storage, so for-in loops step through it with no lookups. */
+        virtual int                 nextIndex( int index ) const;
+        //! Returns a name of dynamic property at a given enumeration cursor.
+        virtual Value               nameAt( int index ) const;
+        //! Returns a value of dynamic property at a given enumeration cursor.
+        virtual Value               valueAt( int index ) const;
         //! Deletes the dynamic object property by a given key.
         bool                        deletePropertyByName( const Str& name );
 
@@ -130,27 +140,70 @@ namespace avm2
 		virtual void                copy_to( Object* target );
 		Object*                     find_target( const Value& target );
 
+    protected:
+
+        //! Reads a dynamic property by name, returns false if there is no such property.
+        bool                        findMember( const Str& name, Value* value ) const;
+        //! Writes a dynamic property by name.
+        void                        storeMember( const Str& name, const Value& value );
+        //! Reserves a storage for a given number of dynamic properties.
+        void                        reserveMembers( int count );
+        //! Moves all inline dynamic properties to the Members hash.
+        void                        convertToDictionary( void );
+        //! Returns dynamic properties of this object, allocating them on the first call.
+        DynamicProperties*          dynamicProperties( void );
+        //! Grows the slot storage to hold at least a given number of slots.
+        void                        reserveSlots( int count );
+
     protected:
 
         //! Parent domain.
         Domain*                     m_domain;
-		//! Dynamic object properties.
-        Members                     m_members;
+        //! Dynamic object properties, NULL until the first one is added.
+        DynamicProperties*          m_dynamic;
 		//! Associated object traits.
         TraitsWeak                  m_traits;
 		//! Object class.
         ClassWeak                   m_class;
-		//! Function closure cache.
-        mutable FunctionClosures    m_closures;
 		//! The boolean flag that indicates that we are running the toString method.
 		// !!!: Is this ok?
         mutable bool                m_isInsideToString;
-		//! An array of a fixed object slots.
-        ValueArray                  m_slots;
+        //! The object was pushed to a scope stack, so changing its properties invalidates cached name lookups.
+        bool                        m_isScope;
+        //! Slots are stored right after this object, so they are released with it.
+        bool                        m_hasInlineSlots;
+        //! Number of constructed slots, slot storage never shrinks.
+        int                         m_slotCount;
+		//! Fixed object slots, indexed from 1.
+        Value*                      m_slots;
         //! Prototype object.
         mutable ObjectPtr           m_prototype;
 	};
 
+    // ** Object::createWithSlots
+    template<typename TObject>
+    TObject* Object::createWithSlots( Domain* domain, int slotCount )
+    {
+        // ** The block is released by the garbage collector as a whole, so slots share an allocation with the object
+        void*    memory = TObject::operator new( sizeof( TObject ) + slotCount * sizeof( Value ) );
+        TObject* object = ::new( memory ) TObject( domain );
+        Value*   slots  = reinterpret_cast<Value*>( static_cast<char*>( memory ) + sizeof( TObject ) );
+
+        if( slotCount == 0 || object->m_slots != NULL ) {
+            return object;
+        }
+
+        for( int i = 0; i < slotCount; i++ ) {
+            ::new( slots + i ) Value;
+        }
+
+        object->m_slots          = slots;
+        object->m_slotCount      = slotCount;
+        object->m_hasInlineSlots = true;
+
+        return object;
+    }
+
     class String : public Object {
     public:
 
@@ -0,0 +1,539 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "Optimizer.h"
+#include "Object.h"
+#include "Multiname.h"
+
+namespace avm2
+{
+
+// ** Optimizer::Optimizer
+Optimizer::Optimizer( int passes ) : m_passes( passes )
+{
+
+}
+
+// ** Optimizer::optimize
+void Optimizer::optimize( Instructions& instructions, const Exceptions& exceptions )
+{
+    if( m_passes == NoPasses ) {
+        return;
+    }
+
+    int count = ( int )instructions.size();
+
+    m_instructions = instructions;
+    m_removed.resize( count + 1 );
+    m_boundaries.resize( count + 1 );
+
+    for( int i = 0; i <= count; i++ ) {
+        m_removed[i]    = 0;
+        m_boundaries[i] = 0;
+    }
+
+    // ** Mark instructions that are entered from anywhere but the previous one
+    for( int i = 0; i < count; i++ ) {
+        const Instruction& instr = m_instructions[i];
+
+        if( isBranch( instr ) ) {
+            m_boundaries[instr.offset + 1] = 1;
+        }
+        else if( instr.opCode == LookupSwitch ) {
+            m_boundaries[instr.defaultOffset] = 1;
+            for( int j = 0; j <= instr.caseCount; j++ ) {
+                m_boundaries[instr.caseOffsets[j] + 1] = 1;
+            }
+        }
+    }
+
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        const Exception* e = exceptions[i].get();
+
+        m_boundaries[e->from()]   = 1;
+        m_boundaries[e->to() + 1] = 1;
+        m_boundaries[e->target()] = 1;
+    }
+
+    if( m_passes & StripDebug ) {
+        stripDebug();
+    }
+    if( m_passes & FoldConstants ) {
+        foldConstants();
+    }
+    if( m_passes & ThreadJumps ) {
+        threadJumps();
+    }
+    if( m_passes & RemoveDeadCode ) {
+        removeDeadCode( exceptions );
+    }
+    if( m_passes & UnbindCallees ) {
+        unbindCallees();
+    }
+
+    compact( instructions, exceptions );
+}
+
+// ** Optimizer::stripDebug
+void Optimizer::stripDebug( void )
+{
+    for( int i = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        if( isNop( m_instructions[i] ) ) {
+            m_removed[i] = 1;
+        }
+    }
+}
+
+// ** Optimizer::foldConstants
+void Optimizer::foldConstants( void )
+{
+    for( int i = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        if( m_removed[i] ) {
+            continue;
+        }
+
+        int     operandCount = 0;
+        Value   a, b, result;
+
+        switch( m_instructions[i].opCode ) {
+        case Add:
+        case Subtract:
+        case Multiply:      operandCount = 2;   break;
+        case Negate:
+        case Increment:
+        case IncrementI:
+        case Decrement:     operandCount = 1;   break;
+        default:            continue;
+        }
+
+        // ** Operands are pushed right before the operation, with no way to enter in between
+        int rhs = previous( i );
+        int lhs = operandCount == 2 ? previous( rhs ) : rhs;
+
+        if( lhs < 0 || isBoundary( lhs + 1, i ) ) {
+            continue;
+        }
+
+        if( !isConstant( m_instructions[lhs], a ) || !isConstant( m_instructions[rhs], b ) ) {
+            continue;
+        }
+
+        // ** Results match the interpreter, int operands keep producing ints
+        switch( m_instructions[i].opCode ) {
+        case Add:           result = Value::add( NULL, a, b );                      break;
+        case Subtract:      result = Value::subtract( a, b );                       break;
+        case Multiply:      result = Value::multiply( a, b );                       break;
+        case Negate:        result = Value::negate( a );                            break;
+        case Increment:     result = Value::increment( a, 1 );                      break;
+        case IncrementI:    result = int( Uint32( a.asInt() ) + 1 );                break;
+        case Decrement:     result = Value::increment( a, -1 );                     break;
+        default:            assert( false );
+        }
+
+        // ** The result replaces the operation, so branches to the first operand still reach it
+        Instruction& instr = m_instructions[i];
+        memset( &instr, 0, sizeof( instr ) );
+
+        if( result.isInt() ) {
+            instr.opCode  = PushInt;
+            instr.Integer = result.asInt();
+        } else {
+            instr.opCode  = PushDouble;
+            instr.Number  = result.asNumber();
+        }
+
+        m_removed[lhs] = 1;
+        m_removed[rhs] = 1;
+    }
+}
+
+// ** Optimizer::threadJumps
+void Optimizer::threadJumps( void )
+{
+    for( int i = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        Instruction& instr = m_instructions[i];
+
+        if( m_removed[i] || !isBranch( instr ) ) {
+            continue;
+        }
+
+        instr.offset = resolveJump( instr.offset + 1 ) - 1;
+    }
+}
+
+// ** Optimizer::removeDeadCode
+void Optimizer::removeDeadCode( const Exceptions& exceptions )
+{
+    int         count = ( int )m_instructions.size();
+    array<int>  reachable( count + 1 );
+    array<int>  queue;
+
+    for( int i = 0; i <= count; i++ ) {
+        reachable[i] = 0;
+    }
+
+    // ** Code is entered at the first instruction and at exception handlers
+    reachable[0] = 1;
+    queue.push_back( 0 );
+
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        int target = exceptions[i]->target();
+        if( !reachable[target] ) {
+            reachable[target] = 1;
+            queue.push_back( target );
+        }
+    }
+
+    while( queue.size() ) {
+        int i = queue.back();
+        queue.pop_back();
+
+        if( i >= count ) {
+            continue;
+        }
+
+        const Instruction& instr = m_instructions[i];
+        int                successors[2] = { -1, -1 };
+
+        if( m_removed[i] ) {
+            successors[0] = i + 1;
+        } else {
+            switch( instr.opCode ) {
+            case ReturnVoid:
+            case ReturnValue:
+            case Throw:         break;
+
+            case Jump:          successors[0] = instr.offset + 1;
+                                break;
+
+            case LookupSwitch:  if( !reachable[instr.defaultOffset] ) {
+                                    reachable[instr.defaultOffset] = 1;
+                                    queue.push_back( instr.defaultOffset );
+                                }
+                                for( int j = 0; j <= instr.caseCount; j++ ) {
+                                    int target = instr.caseOffsets[j] + 1;
+                                    if( !reachable[target] ) {
+                                        reachable[target] = 1;
+                                        queue.push_back( target );
+                                    }
+                                }
+                                break;
+
+            default:            successors[0] = i + 1;
+                                if( isBranch( instr ) ) {
+                                    successors[1] = instr.offset + 1;
+                                }
+            }
+        }
+
+        for( int j = 0; j < 2; j++ ) {
+            int target = successors[j];
+            if( target >= 0 && !reachable[target] ) {
+                reachable[target] = 1;
+                queue.push_back( target );
+            }
+        }
+    }
+
+    for( int i = 0; i < count; i++ ) {
+        if( !reachable[i] ) {
+            m_removed[i] = 1;
+        }
+    }
+
+    // ** Jumps over removed instructions only, walked backwards so a chain of them goes away at once
+    for( int i = count - 1; i >= 0; i-- ) {
+        const Instruction& instr = m_instructions[i];
+
+        if( m_removed[i] || instr.opCode != Jump || instr.offset < i ) {
+            continue;
+        }
+
+        int next = i + 1;
+        while( next <= instr.offset && m_removed[next] ) {
+            next++;
+        }
+
+        if( next == instr.offset + 1 ) {
+            m_removed[i] = 1;
+        }
+    }
+}
+
+// ** Optimizer::unbindCallees
+void Optimizer::unbindCallees( void )
+{
+    for( int i = 0, n = ( int )m_instructions.size(); i < n; i++ ) {
+        Instruction& instr = m_instructions[i];
+
+        if( m_removed[i] || instr.opCode != GetProperty || instr.Identifier->hasRuntimeName() || instr.Identifier->hasRuntimeNamespace() ) {
+            continue;
+        }
+
+        // ** The object is read from a local right before the property and the same local is the receiver right after it
+        int object   = previous( i );
+        int receiver = next( i );
+
+        if( object < 0 || receiver < 0 || isBoundary( object + 1, receiver ) ) {
+            continue;
+        }
+
+        int local = localIndex( m_instructions[object] );
+
+        if( local < 0 || localIndex( m_instructions[receiver] ) != local ) {
+            continue;
+        }
+
+        // ** A method called with the object it was read from behaves the same as its closure
+        if( findCall( receiver + 1 ) >= 0 ) {
+            instr.flags |= Instruction::UnboundCallee;
+        }
+    }
+}
+
+// ** Optimizer::compact
+void Optimizer::compact( Instructions& instructions, const Exceptions& exceptions )
+{
+    int         count = ( int )m_instructions.size();
+    array<int>  indices( count + 1 );
+    Instructions output;
+
+    // ** A removed instruction maps to the next instruction that is kept
+    for( int i = 0; i < count; i++ ) {
+        indices[i] = output.size();
+
+        if( !m_removed[i] ) {
+            output.push_back( m_instructions[i] );
+        }
+    }
+
+    indices[count] = output.size();
+
+    // ** Remap branch targets, stored as a target index minus one
+    for( int i = 0, n = ( int )output.size(); i < n; i++ ) {
+        Instruction& instr = output[i];
+
+        if( isBranch( instr ) ) {
+            instr.offset = indices[instr.offset + 1] - 1;
+        }
+        else if( instr.opCode == LookupSwitch ) {
+            instr.defaultOffset = indices[instr.defaultOffset];
+            for( int j = 0; j <= instr.caseCount; j++ ) {
+                instr.caseOffsets[j] = indices[instr.caseOffsets[j] + 1] - 1;
+            }
+        }
+    }
+
+    // ** Remap exception ranges, the last instruction of a range is inclusive
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        Exception* e = exceptions[i].get();
+
+        int from   = indices[e->from()];
+        int to     = indices[e->to() + 1] - 1;
+        int target = indices[e->target()];
+
+        e->setFrom( from );
+        e->setTo( to );
+        e->setTarget( target );
+    }
+
+    instructions = output;
+}
+
+// ** Optimizer::previous
+int Optimizer::previous( int index ) const
+{
+    // ** Instructions without any effect on the operand stack are skipped, even when they're not stripped
+    for( int i = index - 1; i >= 0; i-- ) {
+        if( !m_removed[i] && !isNop( m_instructions[i] ) ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// ** Optimizer::next
+int Optimizer::next( int index ) const
+{
+    for( int i = index + 1, n = ( int )m_instructions.size(); i < n; i++ ) {
+        if( !m_removed[i] && !isNop( m_instructions[i] ) ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// ** Optimizer::findCall
+int Optimizer::findCall( int from ) const
+{
+    // ** Number of values pushed above a receiver, a Call that takes exactly them as arguments consumes the receiver and the callee
+    int depth = 0;
+
+    for( int i = from, n = ( int )m_instructions.size(); i < n; i++ ) {
+        const Instruction& instr = m_instructions[i];
+
+        if( m_boundaries[i] ) {
+            return -1;
+        }
+
+        if( m_removed[i] || isNop( instr ) ) {
+            continue;
+        }
+
+        int pops = 0;
+
+        switch( instr.opCode ) {
+        case Call:              return instr.ArgCount == depth ? i : -1;
+
+        case GetLocal0:         case GetLocal1:         case GetLocal2:         case GetLocal3:         case GetLocal:
+        case PushByte:          case PushShort:         case PushInt:           case PushUInt:          case PushDouble:
+        case PushString:        case PushNull:          case PushUndefined:     case PushTrue:          case PushFalse:
+        case PushNaN:           break;
+
+        case GetProperty:       if( instr.Identifier->hasRuntimeName() || instr.Identifier->hasRuntimeNamespace() ) {
+                                    return -1;
+                                }
+                                pops = 1;
+                                break;
+
+        case Negate:            case Increment:         case Decrement:         case IncrementI:        case DecrementI:
+        case ConvertToInt:      case ConvertToUInt:     case ConvertToDouble:   case ConvertToBool:     case ConvertToString:
+        case Coerce:            case CoerceToAny:       case CoerceToString:    pops = 1;
+                                break;
+
+        case Add:               case Subtract:          case Multiply:          case Divide:            case Modulo:
+        case AddI:              case SubtractI:         case MultiplyI:         pops = 2;
+                                break;
+
+        default:                return -1;
+        }
+
+        if( depth < pops ) {
+            return -1;
+        }
+
+        depth += 1 - pops;
+    }
+
+    return -1;
+}
+
+// ** Optimizer::resolveJump
+int Optimizer::resolveJump( int target ) const
+{
+    int count = ( int )m_instructions.size();
+
+    // ** Each step follows a Jump, so a cycle of jumps is cut after visiting every instruction once
+    for( int steps = 0; steps < count; steps++ ) {
+        while( target < count && m_removed[target] ) {
+            target++;
+        }
+
+        if( target >= count || m_instructions[target].opCode != Jump ) {
+            break;
+        }
+
+        target = m_instructions[target].offset + 1;
+    }
+
+    return target;
+}
+
+// ** Optimizer::isBoundary
+bool Optimizer::isBoundary( int from, int to ) const
+{
+    for( int i = from; i <= to; i++ ) {
+        if( m_boundaries[i] ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ** Optimizer::isBranch
+bool Optimizer::isBranch( const Instruction& instruction )
+{
+    switch( instruction.opCode ) {
+    case IfEqual:       case IfFalse:           case IfGreaterEqual:    case IfGreater:         case IfLessEqual:
+    case IfLess:        case IfNotGreaterEqual: case IfNotGreater:      case IfNotLessEqual:    case IfNotLess:
+    case IfNotEqual:    case IfStrictEqual:     case IfStictNotEqual:   case IfTrue:            case Jump:
+        return true;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+// ** Optimizer::isNop
+bool Optimizer::isNop( const Instruction& instruction )
+{
+    switch( instruction.opCode ) {
+    case Label:
+    case Nop:
+    case Debug:
+    case DebugLine:
+    case DebugFile: return true;
+    default:        break;
+    }
+
+    return false;
+}
+
+// ** Optimizer::isConstant
+bool Optimizer::isConstant( const Instruction& instruction, Value& value )
+{
+    switch( instruction.opCode ) {
+    case PushByte:
+    case PushShort:
+    case PushInt:       value = instruction.Integer;    return true;
+    case PushUInt:      value = instruction.UInt;       return true;
+    case PushDouble:    value = instruction.Number;     return true;
+    default:            break;
+    }
+
+    return false;
+}
+
+// ** Optimizer::localIndex
+int Optimizer::localIndex( const Instruction& instruction )
+{
+    switch( instruction.opCode ) {
+    case GetLocal0:
+    case GetLocal1:
+    case GetLocal2:
+    case GetLocal3: return instruction.opCode - GetLocal0;
+    case GetLocal:  return instruction.Integer;
+    default:        break;
+    }
+
+    return -1;
+}
+
+} // namespace avm2
@@ -0,0 +1,93 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __avm2__Optimizer__
+#define __avm2__Optimizer__
+
+#include "Instructions.h"
+#include "Exception.h"
+
+namespace avm2
+{
+    // ** class Optimizer
+    //! Runs link-time optimization passes over the instructions of a single function body.
+    /*! Passes only mark instructions as removed or rewrite them in place, the body is compacted once in the end
+     *  and branch targets and exception ranges are remapped to the instructions that follow removed ones.
+     */
+    class Optimizer {
+    public:
+
+        // ** enum Pass
+        enum Pass {
+            FoldConstants   = 1 << 0,   //!< Replaces arithmetic on constants with a single push.
+            ThreadJumps     = 1 << 1,   //!< Retargets branches to a Jump to the final destination.
+            RemoveDeadCode  = 1 << 2,   //!< Removes unreachable instructions and jumps to the next instruction.
+            StripDebug      = 1 << 3,   //!< Removes Label, Nop, Debug, DebugLine and DebugFile.
+            UnbindCallees   = 1 << 4,   //!< Lets GetProperty skip binding a method closure when the value is only called with the same receiver.
+
+            NoPasses        = 0,
+            AllPasses       = FoldConstants | ThreadJumps | RemoveDeadCode | StripDebug | UnbindCallees,
+        #if AVM2_DEBUG
+            DefaultPasses   = FoldConstants | ThreadJumps | RemoveDeadCode | UnbindCallees
+        #else
+            DefaultPasses   = AllPasses
+        #endif
+        };
+
+                                Optimizer( int passes );
+
+        //! Optimizes instructions in place, remapping branch targets and exception ranges.
+        void                    optimize( Instructions& instructions, const Exceptions& exceptions );
+
+    private:
+
+        void                    stripDebug( void );
+        void                    foldConstants( void );
+        void                    threadJumps( void );
+        void                    removeDeadCode( const Exceptions& exceptions );
+        void                    unbindCallees( void );
+        void                    compact( Instructions& instructions, const Exceptions& exceptions );
+
+        int                     previous( int index ) const;
+        int                     next( int index ) const;
+        int                     findCall( int from ) const;
+        int                     resolveJump( int target ) const;
+        bool                    isBoundary( int from, int to ) const;
+        static bool             isBranch( const Instruction& instruction );
+        static bool             isNop( const Instruction& instruction );
+        static bool             isConstant( const Instruction& instruction, Value& value );
+        static int              localIndex( const Instruction& instruction );
+
+    private:
+
+        int                     m_passes;
+        Instructions            m_instructions;
+        array<int>              m_removed;      //!< Instructions that are dropped during compaction.
+        array<int>              m_boundaries;   //!< Instructions that are entered from anywhere but the previous one.
+    };
+}
+
+#endif /* defined(__avm2__Optimizer__) */
@@ -0,0 +1,541 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "RegisterTranslator.h"
+#include "Object.h"
+#include "Multiname.h"
+
+namespace avm2
+{
+
+// ** RegisterTranslator::RegisterTranslator
+RegisterTranslator::RegisterTranslator( int localCount, int maxStack ) : m_localCount( localCount ), m_maxStack( maxStack )
+{
+
+}
+
+// ** RegisterTranslator::registerCount
+int RegisterTranslator::registerCount( void ) const
+{
+    // ** Locals are followed by a temporary per operand stack slot, constants are not registers
+    return m_localCount + m_maxStack;
+}
+
+// ** RegisterTranslator::constants
+const ValueArray& RegisterTranslator::constants( void ) const
+{
+    return m_constants;
+}
+
+// ** RegisterTranslator::translate
+void RegisterTranslator::translate( Instructions& instructions, const Exceptions& exceptions )
+{
+    int         count = ( int )instructions.size();
+    array<int>  boundaries( count + 1 );
+
+    for( int i = 0; i <= count; i++ ) {
+        boundaries[i] = 0;
+    }
+
+    // ** Mark instructions that are entered from anywhere but the previous one
+    for( int i = 0; i < count; i++ ) {
+        const Instruction& instr = instructions[i];
+
+        switch( instr.opCode ) {
+        case IfEqual:       case IfFalse:           case IfGreaterEqual:    case IfGreater:         case IfLessEqual:
+        case IfLess:        case IfNotGreaterEqual: case IfNotGreater:      case IfNotLessEqual:    case IfNotLess:
+        case IfNotEqual:    case IfStrictEqual:     case IfStictNotEqual:   case IfTrue:            case Jump:
+            boundaries[instr.offset + 1] = 1;
+            break;
+
+        case LookupSwitch:
+            boundaries[instr.defaultOffset] = 1;
+            for( int j = 0; j <= instr.caseCount; j++ ) {
+                boundaries[instr.caseOffsets[j] + 1] = 1;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        const Exception* e = exceptions[i].get();
+
+        boundaries[e->from()]   = 1;
+        boundaries[e->to() + 1] = 1;
+        boundaries[e->target()] = 1;
+    }
+
+    // ** Translate instructions
+    m_indices.resize( count + 1 );
+
+    for( int i = 0; i < count; i++ ) {
+        const Instruction& instr = instructions[i];
+
+        if( boundaries[i] ) {
+            flush( m_pending.size() );
+        }
+
+        m_indices[i] = m_output.size();
+
+        switch( instr.opCode ) {
+        case GetLocal0:     push( instr, 0 );               break;
+        case GetLocal1:     push( instr, 1 );               break;
+        case GetLocal2:     push( instr, 2 );               break;
+        case GetLocal3:     push( instr, 3 );               break;
+        case GetLocal:      push( instr, instr.Integer );    break;
+
+        case PushByte:
+        case PushShort:
+        case PushInt:
+        case PushDouble:
+        case PushString:
+        case PushTrue:
+        case PushFalse:
+        case PushNull:
+        case PushUndefined: push( instr, NoRegister );      break;
+
+        case SetLocal1:     emitSetLocal( 1 );              break;
+        case SetLocal2:     emitSetLocal( 2 );              break;
+        case SetLocal3:     emitSetLocal( 3 );              break;
+        case SetLocal:      emitSetLocal( instr.Integer );  break;
+
+        case Add:           emitBinary( RegAdd, instr );        break;
+        case Subtract:      emitBinary( RegSubtract, instr );   break;
+        case Multiply:      emitBinary( RegMultiply, instr );   break;
+        case Increment:     emitUnary( RegIncrement, instr );   break;
+        case IncrementI:    emitUnary( RegIncrementI, instr );  break;
+        case Decrement:     emitUnary( RegDecrement, instr );   break;
+
+        case IfLess:            emitBranch( RegIfLess, instr, 2 );      break;
+        case IfGreater:
+        case IfNotLessEqual:    emitBranch( RegIfGreater, instr, 2 );   break;
+        case IfLessEqual:
+        case IfNotGreater:      emitBranch( RegIfLessEqual, instr, 2 ); break;
+        case IfNotLess:         emitBranch( RegIfNotLess, instr, 2 );   break;
+        case IfNotEqual:
+        case IfStictNotEqual:   emitBranch( RegIfNotEqual, instr, 2 );  break;
+        case IfTrue:            emitBranch( RegIfTrue, instr, 1 );      break;
+        case IfFalse:           emitBranch( RegIfFalse, instr, 1 );     break;
+
+        case PushScope:     emitPushScope( instr );             break;
+        case GetProperty:   {
+                                // ** Instructions up to the next boundary, the lookahead never needs more than a stack worth of them
+                                int next = 0;
+
+                                while( i + 1 + next < count && !boundaries[i + 1 + next] && next <= m_maxStack ) {
+                                    next++;
+                                }
+
+                                emitGetProperty( instr, &instructions[0] + i + 1, next );
+                            }
+                            break;
+
+        case Equals:
+        case StrictEquals:  if( i + 1 < count && !boundaries[i + 1] && emitCompareBranch( instructions[i + 1] ) ) {
+                                m_indices[++i] = m_output.size();
+                            } else {
+                                flush( m_pending.size() );
+                                emit( instr );
+                            }
+                            break;
+
+        case Pop:           if( m_pending.size() ) {
+                                m_pending.pop_back();
+                            } else {
+                                emit( instr );
+                            }
+                            break;
+
+        default:            flush( m_pending.size() );
+                            emit( instr );
+                            break;
+        }
+    }
+
+    flush( m_pending.size() );
+    m_indices[count] = m_output.size();
+
+    // ** Remap branch targets, stored as a target index minus one
+    for( int i = 0, n = ( int )m_output.size(); i < n; i++ ) {
+        Instruction& instr = m_output[i];
+
+        switch( instr.opCode ) {
+        case IfEqual:       case IfFalse:           case IfGreaterEqual:    case IfGreater:         case IfLessEqual:
+        case IfLess:        case IfNotGreaterEqual: case IfNotGreater:      case IfNotLessEqual:    case IfNotLess:
+        case IfNotEqual:    case IfStrictEqual:     case IfStictNotEqual:   case IfTrue:            case Jump:
+        case RegIfLess:     case RegIfGreater:      case RegIfLessEqual:    case RegIfNotLess:      case RegIfNotEqual:
+        case RegIfTrue:     case RegIfFalse:            case RegIfEquals:       case RegIfNotEquals:
+            instr.offset = remap( instr.offset + 1 ) - 1;
+            break;
+
+        case LookupSwitch:
+            instr.defaultOffset = remap( instr.defaultOffset );
+            for( int j = 0; j <= instr.caseCount; j++ ) {
+                instr.caseOffsets[j] = remap( instr.caseOffsets[j] + 1 ) - 1;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // ** Remap exception ranges, the last instruction of a range is inclusive
+    for( int i = 0, n = ( int )exceptions.size(); i < n; i++ ) {
+        Exception* e = exceptions[i].get();
+
+        int from   = remap( e->from() );
+        int to     = remap( e->to() + 1 ) - 1;
+        int target = remap( e->target() );
+
+        e->setFrom( from );
+        e->setTo( to );
+        e->setTarget( target );
+    }
+
+    instructions = m_output;
+}
+
+// ** RegisterTranslator::remap
+int RegisterTranslator::remap( int target ) const
+{
+    return m_indices[target];
+}
+
+// ** RegisterTranslator::push
+void RegisterTranslator::push( const Instruction& instruction, int reg )
+{
+    // ** Symbolic stack can't get deeper than the declared one, unless the bytecode lies about it
+    if( ( int )m_pending.size() >= m_maxStack ) {
+        flush( m_pending.size() );
+    }
+
+    Operand operand;
+    operand.m_instruction = instruction;
+    operand.m_register    = reg;
+    m_pending.push_back( operand );
+}
+
+// ** RegisterTranslator::pushTemporary
+void RegisterTranslator::pushTemporary( int reg )
+{
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+    instr.opCode  = GetLocal;
+    instr.Integer = reg;
+
+    push( instr, reg );
+}
+
+// ** RegisterTranslator::operandRegister
+int RegisterTranslator::operandRegister( Operand& operand )
+{
+    if( operand.m_register != NoRegister ) {
+        return operand.m_register;
+    }
+
+    const Instruction& instr = operand.m_instruction;
+    Value              value;
+
+    switch( instr.opCode ) {
+    case PushByte:
+    case PushShort:
+    case PushInt:       value = Value( instr.Integer );             break;
+    case PushDouble:    value = Value( instr.Number );              break;
+    case PushString:    value = Value( ( Object* )instr.Str );      break;
+    case PushTrue:      value = Value( true );                      break;
+    case PushFalse:     value = Value( false );                     break;
+    case PushNull:      value = Value::null;                        break;
+    case PushUndefined: value = Value::undefined;                   break;
+    default:            assert( false );
+    }
+
+    operand.m_register = ~( int )m_constants.size();
+    m_constants.push_back( value );
+
+    return operand.m_register;
+}
+
+// ** RegisterTranslator::flush
+void RegisterTranslator::flush( int count )
+{
+    assert( count <= ( int )m_pending.size() );
+
+    for( int i = 0; i < count; i++ ) {
+        emit( m_pending[i].m_instruction );
+    }
+
+    for( int i = count, n = ( int )m_pending.size(); i < n; i++ ) {
+        m_pending[i - count] = m_pending[i];
+    }
+
+    m_pending.resize( m_pending.size() - count );
+}
+
+// ** RegisterTranslator::emit
+void RegisterTranslator::emit( const Instruction& instruction )
+{
+    m_output.push_back( instruction );
+}
+
+// ** RegisterTranslator::isRegisterResult
+bool RegisterTranslator::isRegisterResult( const Instruction& instruction ) const
+{
+    switch( instruction.opCode ) {
+    case RegMove:
+    case RegAdd:
+    case RegSubtract:
+    case RegMultiply:
+    case RegIncrement:
+    case RegIncrementI:
+    case RegDecrement:  return true;
+    default:            break;
+    }
+
+    return false;
+}
+
+// ** RegisterTranslator::emitSetLocal
+void RegisterTranslator::emitSetLocal( int index )
+{
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+
+    if( m_pending.size() == 0 ) {
+        instr.opCode  = SetLocal;
+        instr.Integer = index;
+        emit( instr );
+        return;
+    }
+
+    int top    = ( int )m_pending.size() - 1;
+    int source = operandRegister( m_pending[top] );
+
+    // ** Values below still read the old local value, so they are pushed before it's overwritten
+    bool overwritesPending = false;
+
+    for( int i = 0; i < top; i++ ) {
+        if( m_pending[i].m_register == index ) {
+            overwritesPending = true;
+            break;
+        }
+    }
+
+    // ** Store the result of the last register instruction directly into a local
+    if( !overwritesPending && source >= m_localCount && m_output.size() && isRegisterResult( m_output.back() ) && m_output.back().dst == source ) {
+        m_output.back().dst = index;
+        m_pending.pop_back();
+        return;
+    }
+
+    if( overwritesPending ) {
+        flush( top );
+    }
+
+    instr.opCode = RegMove;
+    instr.dst    = index;
+    instr.lhs    = source;
+
+    m_pending.pop_back();
+    emit( instr );
+}
+
+// ** RegisterTranslator::emitUnary
+void RegisterTranslator::emitUnary( OpCode opCode, const Instruction& instruction )
+{
+    if( m_pending.size() == 0 ) {
+        emit( instruction );
+        return;
+    }
+
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+
+    instr.opCode = opCode;
+    instr.lhs    = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+
+    // ** A result takes the temporary of the operand stack slot it would be pushed to
+    instr.dst    = m_localCount + m_pending.size();
+
+    emit( instr );
+    pushTemporary( instr.dst );
+}
+
+// ** RegisterTranslator::emitBinary
+void RegisterTranslator::emitBinary( OpCode opCode, const Instruction& instruction )
+{
+    if( m_pending.size() < 2 ) {
+        flush( m_pending.size() );
+        emit( instruction );
+        return;
+    }
+
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+
+    instr.opCode = opCode;
+    instr.rhs    = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+    instr.lhs    = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+    instr.dst    = m_localCount + m_pending.size();
+
+    emit( instr );
+    pushTemporary( instr.dst );
+}
+
+// ** RegisterTranslator::emitBranch
+void RegisterTranslator::emitBranch( OpCode opCode, const Instruction& instruction, int operandCount )
+{
+    if( ( int )m_pending.size() < operandCount ) {
+        flush( m_pending.size() );
+        emit( instruction );
+        return;
+    }
+
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+
+    instr.opCode = opCode;
+    instr.offset = instruction.offset;
+
+    if( operandCount == 2 ) {
+        instr.rhs = operandRegister( m_pending.back() );
+        m_pending.pop_back();
+    }
+
+    instr.lhs = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+
+    // ** Values left below the operands are pushed, so both branch successors see the same stack
+    flush( m_pending.size() );
+    emit( instr );
+}
+
+// ** RegisterTranslator::emitPushScope
+void RegisterTranslator::emitPushScope( const Instruction& instruction )
+{
+    if( m_pending.size() == 0 ) {
+        emit( instruction );
+        return;
+    }
+
+    Instruction instr;
+    memset( &instr, 0, sizeof( instr ) );
+
+    // ** Scope stack is separate, so values below the scope object can stay pending
+    instr.opCode = RegPushScope;
+    instr.lhs    = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+
+    emit( instr );
+}
+
+// ** RegisterTranslator::emitGetProperty
+void RegisterTranslator::emitGetProperty( const Instruction& instruction, const Instruction* next, int count )
+{
+    // ** A runtime name is on top of the object, so the object is not a pending register
+    if( m_pending.size() == 0 || instruction.Identifier->hasRuntimeName() ) {
+        flush( m_pending.size() );
+        emit( instruction );
+        return;
+    }
+
+    // ** Skip values pushed above the result, they stay pending as well
+    int pushed = 0;
+
+    while( pushed < count && registerOperands( next[pushed] ) < 0 ) {
+        pushed++;
+    }
+
+    // ** The result is consumed by a register instruction only if it reaches down to it
+    if( pushed == count || registerOperands( next[pushed] ) <= pushed || ( int )m_pending.size() + pushed < registerOperands( next[pushed] ) ) {
+        flush( m_pending.size() );
+        emit( instruction );
+        return;
+    }
+
+    Instruction instr = instruction;
+
+    instr.opCode = RegGetProperty;
+    instr.lhs    = operandRegister( m_pending.back() );
+    m_pending.pop_back();
+    instr.dst    = m_localCount + m_pending.size();
+
+    emit( instr );
+    pushTemporary( instr.dst );
+}
+
+// ** RegisterTranslator::registerOperands
+int RegisterTranslator::registerOperands( const Instruction& instruction ) const
+{
+    switch( instruction.opCode ) {
+    case GetLocal0:     case GetLocal1:     case GetLocal2:     case GetLocal3:     case GetLocal:
+    case PushByte:      case PushShort:     case PushInt:       case PushDouble:    case PushString:
+    case PushTrue:      case PushFalse:     case PushNull:      case PushUndefined:
+        return -1;
+
+    case SetLocal1:     case SetLocal2:     case SetLocal3:     case SetLocal:
+    case Increment:     case IncrementI:    case Decrement:     case IfTrue:        case IfFalse:
+    case PushScope:     case Pop:
+        return 1;
+
+    case GetProperty:
+        return instruction.Identifier->hasRuntimeName() ? 0 : 1;
+
+    case Add:           case Subtract:      case Multiply:
+    case IfLess:        case IfGreater:     case IfNotLessEqual:    case IfLessEqual:   case IfNotGreater:
+    case IfNotLess:     case IfNotEqual:    case IfStictNotEqual:
+        return 2;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+// ** RegisterTranslator::emitCompareBranch
+bool RegisterTranslator::emitCompareBranch( const Instruction& next )
+{
+    if( m_pending.size() < 2 ) {
+        return false;
+    }
+
+    switch( next.opCode ) {
+    case IfTrue:    emitBranch( RegIfEquals, next, 2 );     return true;
+    case IfFalse:   emitBranch( RegIfNotEquals, next, 2 );  return true;
+    default:        break;
+    }
+
+    return false;
+}
+
+} // namespace avm2
@@ -0,0 +1,102 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __avm2__RegisterTranslator__
+#define __avm2__RegisterTranslator__
+
+#include "Instructions.h"
+#include "Exception.h"
+#include "Value.h"
+
+namespace avm2
+{
+    // ** class RegisterTranslator
+    //! Rewrites operand stack shuffling between locals into register instructions and fuses frequent sequences.
+    /*! Values pushed by GetLocal and Push* are not emitted right away, they are tracked on a symbolic stack
+     *  and consumed by register instructions that read locals, constants and temporaries directly. Operand stack
+     *  positions of intermediate results become temporary registers placed after the locals. Constants stay in
+     *  a read-only pool of the function and are addressed by negative operand indices.
+     *  Pending values are pushed for real before branch targets, exception boundaries and any other instruction,
+     *  so the operand stack is always exact where the regular interpreter takes over.
+     *
+     *  Frequent sequences that consume a pending value are fused into superinstructions: a method prologue
+     *  GetLocal0; PushScope, a field read GetLocal; GetProperty and a comparison followed by IfTrue or IfFalse.
+     *  A field read is fused only if a register instruction consumes its result, otherwise the result would be
+     *  pushed back by a GetLocal and nothing would be saved.
+     */
+    class RegisterTranslator {
+    public:
+
+                                RegisterTranslator( int localCount, int maxStack );
+
+        //! Translates linked instructions in place, remapping branch targets and exception ranges.
+        void                    translate( Instructions& instructions, const Exceptions& exceptions );
+        //! Returns a total number of registers used by translated instructions.
+        int                     registerCount( void ) const;
+        //! Returns a constant pool, constant k is read by an operand index ~k.
+        const ValueArray&       constants( void ) const;
+
+    private:
+
+        // ** struct Operand
+        //! A value that is pending on a symbolic operand stack.
+        struct Operand {
+            Instruction         m_instruction;  //!< An instruction that pushes this value to the operand stack.
+            int                 m_register;     //!< A register or a constant index holding this value, or NoRegister for constants not yet placed.
+        };
+
+        typedef array<Operand>  Operands;
+
+        enum { NoRegister = -0x7fffffff - 1 };
+
+        void                    push( const Instruction& instruction, int reg );
+        void                    pushTemporary( int reg );
+        int                     operandRegister( Operand& operand );
+        void                    flush( int count );
+        void                    emit( const Instruction& instruction );
+        void                    emitSetLocal( int index );
+        void                    emitUnary( OpCode opCode, const Instruction& instruction );
+        void                    emitBinary( OpCode opCode, const Instruction& instruction );
+        void                    emitBranch( OpCode opCode, const Instruction& instruction, int operandCount );
+        void                    emitPushScope( const Instruction& instruction );
+        void                    emitGetProperty( const Instruction& instruction, const Instruction* next, int count );
+        bool                    emitCompareBranch( const Instruction& next );
+        bool                    isRegisterResult( const Instruction& instruction ) const;
+        int                     registerOperands( const Instruction& instruction ) const;
+        int                     remap( int target ) const;
+
+    private:
+
+        int                     m_localCount;
+        int                     m_maxStack;
+        ValueArray              m_constants;
+        Operands                m_pending;      //!< Values on top of the operand stack that were not pushed yet.
+        Instructions            m_output;
+        array<int>              m_indices;      //!< Maps an input instruction index to the first output instruction.
+    };
+}
+
+#endif /* defined(__avm2__RegisterTranslator__) */
@@ -0,0 +1,85 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "Shape.h"
+
+namespace avm2
+{
+
+// ** Shape::Shape
+Shape::Shape( void ) : m_parent( NULL )
+{
+
+}
+
+// ** Shape::Shape
+Shape::Shape( Shape* parent, const Str& name ) : m_parent( parent ), m_names( parent->m_names ), m_indices( parent->m_indices )
+{
+    m_indices.add( name, parent->size() );
+    m_names.push_back( name );
+}
+
+// ** Shape::size
+int Shape::size( void ) const
+{
+    return m_indices.size();
+}
+
+// ** Shape::find
+int Shape::find( const Str& name ) const
+{
+    int index = -1;
+    return m_indices.get( name, &index ) ? index : -1;
+}
+
+// ** Shape::name
+const Str& Shape::name( int index ) const
+{
+    assert( index >= 0 && index < size() );
+    return m_names[index];
+}
+
+// ** Shape::transition
+Shape* Shape::transition( const Str& name )
+{
+    Shape* shape = NULL;
+
+    if( m_transitions.get( name, &shape ) ) {
+        return shape;
+    }
+
+    if( size() >= MaxProperties ) {
+        return NULL;
+    }
+
+    shape = new Shape( this, name );
+    m_transitions.add( name, shape );
+    m_children.push_back( shape );
+
+    return shape;
+}
+
+} // namespace avm2
@@ -0,0 +1,73 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#ifndef __avm2__Shape__
+#define __avm2__Shape__
+
+#include "Common.h"
+
+namespace avm2
+{
+    // ** class Shape
+    //! A hidden class shared by all dynamic objects that were populated with the same property names in the same order.
+    /*! Shapes form a transition tree rooted at the Domain, each shape maps a property name to an index
+     *  inside an object inline property array. Shapes are never released before the root.
+     */
+    class Shape : public ref_counted {
+    public:
+
+        //! Objects with more properties than this switch to a dictionary mode.
+        enum { MaxProperties = 32 };
+
+                                Shape( void );
+
+        //! Returns a total number of properties described by this shape.
+        int                     size( void ) const;
+        //! Returns an inline property index by a given name, or -1 if there is no such property.
+        int                     find( const Str& name ) const;
+        //! Returns a property name at a given index.
+        const Str&              name( int index ) const;
+        //! Returns a shape with a given property appended, or NULL if the shape can't grow anymore.
+        Shape*                  transition( const Str& name );
+
+    private:
+
+                                Shape( Shape* parent, const Str& name );
+
+    private:
+
+        typedef string_hash<int>    Indices;
+        typedef string_hash<Shape*> Transitions;
+
+        Shape*                  m_parent;       //!< Parent shape, owns this one.
+        StrArray                m_names;        //!< Property names by an inline index, so enumeration doesn't walk parents.
+        Indices                 m_indices;      //!< Inline indices of all properties.
+        Transitions             m_transitions;  //!< Child shapes by an added property name.
+        Shapes                  m_children;     //!< Child shapes owned by this one.
+    };
+}
+
+#endif /* defined(__avm2__Shape__) */
@@ -29,10 +29,208 @@
 #include "Abc.h"
 #include "Multiname.h"
 #include "Object.h"
+#include "Class.h"
 
 namespace avm2
 {
 
+// ------------------------------------------------------ FrameArena ------------------------------------------------------ //
+
+// ** FrameArena::FrameArena
+FrameArena::FrameArena( void ) : m_current( -1 )
+{
+
+}
+
+// ** FrameArena::~FrameArena
+FrameArena::~FrameArena( void )
+{
+    for( int i = 0, n = ( int )m_chunks.size(); i < n; i++ ) {
+        delete m_chunks[i];
+    }
+}
+
+// ** FrameArena::instance
+FrameArena& FrameArena::instance( void )
+{
+    // ** Thread local storage can't hold objects with constructors, so each thread allocates its arena on first use
+    static AVM2_THREAD_LOCAL FrameArena* arena = NULL;
+
+    if( !arena ) {
+        arena = new FrameArena;
+    }
+
+    return *arena;
+}
+
+// ** FrameArena::allocate
+Value* FrameArena::allocate( int count )
+{
+    Chunk* chunk = m_current >= 0 ? m_chunks[m_current] : NULL;
+
+    // ** Move to the next chunk once the current one is full
+    if( !chunk || chunk->m_used + count > ( int )chunk->m_values.size() ) {
+        m_current++;
+
+        if( m_current == ( int )m_chunks.size() ) {
+            m_chunks.push_back( new Chunk );
+            m_chunks.back()->m_used = 0;
+        }
+
+        chunk = m_chunks[m_current];
+        assert( chunk->m_used == 0 );
+
+        if( ( int )chunk->m_values.size() < count ) {
+            chunk->m_values.resize( count > ChunkSize ? count : ChunkSize );
+        }
+    }
+
+    Value* values = &chunk->m_values[chunk->m_used];
+    chunk->m_used += count;
+
+    return values;
+}
+
+// ** FrameArena::release
+void FrameArena::release( Value* values, int count )
+{
+    assert( m_current >= 0 );
+
+    Chunk* chunk = m_chunks[m_current];
+    assert( values + count == &chunk->m_values[0] + chunk->m_used );
+
+    for( int i = 0; i < count; i++ ) {
+        values[i].setUndefined();
+    }
+
+    chunk->m_used -= count;
+
+    if( chunk->m_used == 0 ) {
+        m_current--;
+    }
+}
+
+// ** FrameArena::allocateAt
+Value* FrameArena::allocateAt( Value* base, int count )
+{
+    assert( m_current >= 0 );
+
+    Chunk* chunk  = m_chunks[m_current];
+    int    offset = ( int )( base - &chunk->m_values[0] );
+    assert( offset >= 0 && offset <= chunk->m_used );
+
+    if( offset + count > ( int )chunk->m_values.size() ) {
+        return NULL;
+    }
+
+    if( offset + count > chunk->m_used ) {
+        chunk->m_used = offset + count;
+    }
+
+    return base;
+}
+
+// ** FrameArena::mark
+int FrameArena::mark( void ) const
+{
+    return m_current >= 0 ? m_chunks[m_current]->m_used : 0;
+}
+
+// ** FrameArena::rewind
+void FrameArena::rewind( Value* values, int count, int mark )
+{
+    assert( m_current >= 0 );
+
+    for( int i = 0; i < count; i++ ) {
+        values[i].setUndefined();
+    }
+
+    m_chunks[m_current]->m_used = mark;
+}
+
+// ----------------------------------------------------- ValueStorage ----------------------------------------------------- //
+
+// ** ValueStorage::ValueStorage
+ValueStorage::ValueStorage( const ValueStorage& other ) : m_values( NULL ), m_size( 0 ), m_capacity( 0 ), m_detached( 0 )
+{
+    for( int i = 0, n = other.size(); i < n; i++ ) {
+        push_back( other[i] );
+    }
+}
+
+// ** ValueStorage::bind
+void ValueStorage::bind( Value* values, int capacity )
+{
+    assert( m_size == 0 );
+
+    m_values   = values;
+    m_capacity = capacity;
+}
+
+// ** ValueStorage::unbind
+void ValueStorage::unbind( void )
+{
+    clear();
+
+    m_values   = NULL;
+    m_capacity = 0;
+    m_detached = 0;
+    m_heap.clear();
+}
+
+// ** ValueStorage::clear
+void ValueStorage::clear( void )
+{
+    while( m_size ) {
+        pop_back();
+    }
+}
+
+// ** ValueStorage::detach
+Value* ValueStorage::detach( int count )
+{
+    assert( count <= m_size );
+
+    // ** Reset Values left from the previous detach
+    for( int i = m_size; i < m_detached; i++ ) {
+        m_values[i].setUndefined();
+    }
+
+    m_detached = m_size;
+    m_size    -= count;
+
+    return m_values + m_size;
+}
+
+// ** ValueStorage::isDetached
+bool ValueStorage::isDetached( const Value* values, int count ) const
+{
+    return m_heap.empty() && values > m_values + m_size && values + count == m_values + m_detached;
+}
+
+// ** ValueStorage::grow
+void ValueStorage::grow( void )
+{
+    // ** Bytecode exceeded its declared limits, continue with a heap copy
+    ValueArray values( m_capacity ? m_capacity * 2 : 8 );
+
+    for( int i = 0; i < m_size; i++ ) {
+        values[i] = m_values[i];
+        m_values[i].setUndefined();
+    }
+
+    for( int i = m_size; i < m_detached; i++ ) {
+        m_values[i].setUndefined();
+    }
+
+    m_heap.swap( values );
+    m_values   = &m_heap[0];
+    m_capacity = ( int )m_heap.size();
+    m_detached = 0;
+}
+
+// ------------------------------------------------------ Stack ------------------------------------------------------ //
+
 // ** Stack::swap
 void Stack::swap( void )
 {
@@ -54,15 +252,26 @@ void Stack::drop( int count )
     }
 }
 
+// ** Stack::pushedBy
+Str Stack::pushedBy( int index ) const
+{
+#if AVM2_DEBUG
+    return m_pushedBy[index];
+#else
+    return "";
+#endif
+}
+
 // ** Stack::arguments
 void Stack::arguments( Arguments& args, int count )
 {
-    args.clear();
+    // ** Arguments are left in place, a script callee reuses them as its registers
+    args.assign( detach( count ), count );
+    AVM2_DEBUG_TRACE( m_pushedBy.resize( size() ) );
 
     AVM2_VERBOSE( "( " );
     for( int i = 0; i < count; i++ ) {
-        args.push( pop() );
-        AVM2_VERBOSE( "%s ", args.values().back().asCString() );
+        AVM2_VERBOSE( "%s ", args.arg( i ).asCString() );
     }
     AVM2_VERBOSE( ")\n" );
 }
@@ -70,48 +279,47 @@ void Stack::arguments( Arguments& args, int count )
 // ------------------------------------------------------ ScopeStack ------------------------------------------------------ //
 
 // ** ScopeStack::ScopeStack
-ScopeStack::ScopeStack( int size ) : m_outer( NULL )
+ScopeStack::ScopeStack( int size )
 {
 }
 
-// ** ScopeStack::ScopeStack
-ScopeStack::ScopeStack( const ScopeStack& other ) : m_outer( NULL )
+// ** ScopeStack::operator []
+Object* ScopeStack::operator [] ( int index ) const
 {
-    for( int i = 0, n = other.size(); i < n; i++ ) {
-        push( other.at( i ) );
-    }
-
-    setOuter( other.m_outer );
+    return m_stack[index].asObject();
 }
 
-ScopeStack::~ScopeStack( void )
+// ** ScopeStack::globalScope
+Object* ScopeStack::globalScope( void ) const
 {
-    delete m_outer;
+    return m_outer != NULL ? m_outer->globalScope() : at( 0 );
 }
 
-// ** ScopeStack::operator []
-Object* ScopeStack::operator [] ( int index ) const
+// ** ScopeStack::setOuter
+void ScopeStack::setOuter( ScopeChain* value )
 {
-    return m_stack[index];
+    m_outer = value;
+    m_chain = NULL;
 }
 
-// ** ScopeStack::globalScope
-Object* ScopeStack::globalScope( void ) const
+// ** ScopeStack::outer
+ScopeChain* ScopeStack::outer( void ) const
 {
-    return m_outer ? m_outer->globalScope() : at( 0 );
+    return m_outer.get();
 }
 
-// ** ScopeStack::setOuter
-void ScopeStack::setOuter( const ScopeStack* value )
+// ** ScopeStack::capture
+ScopeChain* ScopeStack::capture( void ) const
 {
-    if( m_outer ) {
-        delete m_outer;
-        m_outer = NULL;
+    if( m_stack.size() == 0 ) {
+        return m_outer.get();
     }
 
-    if( value ) {
-        m_outer = new ScopeStack( *value );
+    if( m_chain == NULL ) {
+        m_chain = new ScopeChain( m_stack, m_outer.get() );
     }
+
+    return m_chain.get();
 }
 
 // ** ScopeStack::find
@@ -120,14 +328,14 @@ Object* ScopeStack::find( const Name* name, Value* value ) const
     // ** Search a scope stack
     for( int i = m_stack.size() - 1; i >= 0; i-- )
     {
-        Object* object = m_stack[i];
+        Object* object = m_stack[i].asObject();
 
         if( object && object->resolveProperty( name, value ) ) {
             return object;
         }
     }
 
-    return m_outer ? m_outer->find( name, value ) : NULL;
+    return m_outer != NULL ? m_outer->find( name, value ) : NULL;
 }
 
 // ** ScopeStack::size
@@ -139,21 +347,69 @@ int ScopeStack::size( void ) const
 // ** ScopeStack::push
 void ScopeStack::push( Object* value, const char* pushedBy )
 {
+    if( value ) {
+        value->markAsScope();
+    }
+
     m_stack.push_back( value );
-    m_pushedBy.push_back( pushedBy );
+    m_chain = NULL;
+    AVM2_DEBUG_TRACE( m_pushedBy.push_back( pushedBy ) );
 }
 
 // ** ScopeStack::pop
 void ScopeStack::pop( void )
 {
     m_stack.pop_back();
-    m_pushedBy.pop_back();
+    m_chain = NULL;
+    AVM2_DEBUG_TRACE( m_pushedBy.pop_back() );
+}
+
+// ** ScopeStack::pushedBy
+Str ScopeStack::pushedBy( int index ) const
+{
+#if AVM2_DEBUG
+    return m_pushedBy[index];
+#else
+    return "";
+#endif
 }
 
 // ** ScopeStack::at
 Object* ScopeStack::at( int index ) const
 {
-    return m_stack[index];
+    return m_stack[index].asObject();
+}
+
+// ------------------------------------------------------ ScopeChain ------------------------------------------------------ //
+
+// ** ScopeChain::ScopeChain
+ScopeChain::ScopeChain( const ValueStorage& scopes, ScopeChain* outer ) : m_outer( outer )
+{
+    m_scopes.resize( scopes.size() );
+
+    for( int i = 0, n = scopes.size(); i < n; i++ ) {
+        m_scopes[i] = scopes[i];
+    }
+}
+
+// ** ScopeChain::globalScope
+Object* ScopeChain::globalScope( void ) const
+{
+    return m_outer != NULL ? m_outer->globalScope() : m_scopes[0].asObject();
+}
+
+// ** ScopeChain::find
+Object* ScopeChain::find( const Name* name, Value* value ) const
+{
+    for( int i = ( int )m_scopes.size() - 1; i >= 0; i-- ) {
+        Object* object = m_scopes[i].asObject();
+
+        if( object && object->resolveProperty( name, value ) ) {
+            return object;
+        }
+    }
+
+    return m_outer != NULL ? m_outer->find( name, value ) : NULL;
 }
 
 }
\ No newline at end of file
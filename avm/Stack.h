@@ -34,34 +34,134 @@ namespace avm2 {
 
     class AbcInfo;
 
-    class Stack : private array<Value> {
+    // ** class FrameArena
+    //! A contiguous LIFO storage that script frames carve their registers, operand and scope stacks from.
+    class FrameArena {
     public:
 
-                                Stack( int size = 0 ) { /*if( size ) resize( size );*/ }
+        //! A default number of Values inside each arena chunk.
+        enum { ChunkSize = 16384 };
 
-        void                    push( const Value& v, const char* pushedBy = "" ) { push_back( v ); m_pushedBy.push_back( pushedBy ); }
-        Value                   pop( void ) { Value v = back(); pop_back(); m_pushedBy.pop_back(); return v; }
+                                FrameArena( void );
+                                ~FrameArena( void );
+
+        //! Returns an arena of the calling thread, frames of a call chain never cross threads.
+        static FrameArena&      instance( void );
+
+        //! Returns a block of undefined Values.
+        Value*                  allocate( int count );
+        //! Releases the most recently allocated block, all Values are reset to undefined.
+        void                    release( Value* values, int count );
+        //! Returns a block starting at a given Value of the current chunk, or NULL if the chunk can't fit it.
+        Value*                  allocateAt( Value* base, int count );
+        //! Returns the number of used Values in a current chunk.
+        int                     mark( void ) const;
+        //! Releases a block returned by allocateAt and rewinds the current chunk to a given mark.
+        void                    rewind( Value* values, int count, int mark );
+
+    private:
+
+        // ** struct Chunk
+        struct Chunk {
+            ValueArray          m_values;
+            int                 m_used;
+        };
+
+        array<Chunk*>           m_chunks;
+        int                     m_current;
+    };
+
+    // ** class ValueStorage
+    //! A fixed capacity array of Values bound to a FrameArena block, moves to a heap once it overflows.
+    class ValueStorage {
+    friend class Jit;
+    public:
+
+                                ValueStorage( void ) : m_values( NULL ), m_size( 0 ), m_capacity( 0 ), m_detached( 0 ) {}
+                                ValueStorage( const ValueStorage& other );
+
+        //! Binds an empty storage to a given block of Values.
+        void                    bind( Value* values, int capacity );
+        //! Clears the storage and detaches it from a bound block.
+        void                    unbind( void );
+
+        void                    push_back( const Value& value ) { if( m_size == m_capacity ) grow(); m_values[m_size++] = value; }
+        void                    pop_back( void ) { m_values[--m_size].setUndefined(); }
+        Value&                  back( void ) { return m_values[m_size - 1]; }
+        Value&                  operator [] ( int index ) { return m_values[index]; }
+        const Value&            operator [] ( int index ) const { return m_values[index]; }
+        int                     size( void ) const { return m_size; }
+        void                    clear( void );
+        //! Removes top Values without resetting them, they stay valid until the next push or detach.
+        Value*                  detach( int count );
+        //! Returns true if a given range is the last detached block of a storage bound to a FrameArena.
+        bool                    isDetached( const Value* values, int count ) const;
+
+    private:
+
+        void                    operator = ( const ValueStorage& );
+        void                    grow( void );
+
+    private:
+
+        Value*                  m_values;
+        int                     m_size;
+        int                     m_capacity;
+        int                     m_detached;     //!< An end of the last detached block.
+        ValueArray              m_heap;
+    };
+
+    // ** class Stack
+    class Stack : private ValueStorage {
+    friend class Frame;
+    friend class Jit;
+    public:
+
+                                Stack( void ) {}
+
+        void                    push( const Value& v, const char* pushedBy = "" ) { push_back( v ); AVM2_DEBUG_TRACE( m_pushedBy.push_back( pushedBy ) ); }
+        Value                   pop( void ) { Value v = back(); pop_back(); AVM2_DEBUG_TRACE( m_pushedBy.pop_back() ); return v; }
         void                    arguments( Arguments& args, int count );
         const Value&            top( int index = 0 ) const { return (*this)[size() - index - 1]; }
-        int                     size( void ) const { return array<Value>::size(); }
+        int                     size( void ) const { return ValueStorage::size(); }
         const Value&            at( int index ) const { return (*this)[index]; }
         void                    swap( void );
         void                    drop( int count );
-        void                    clear( void ) { array<Value>::clear(); m_pushedBy.clear(); }
-        Str                     pushedBy( int index ) const { return m_pushedBy[index]; }
+        void                    clear( void ) { ValueStorage::clear(); AVM2_DEBUG_TRACE( m_pushedBy.clear() ); }
+        Str                     pushedBy( int index ) const;
 
     private:
 
+    #if AVM2_DEBUG
         array<Str>              m_pushedBy;
+    #endif
+    };
+
+    // ** class ScopeChain
+    //! An immutable segment of a scope chain captured by closures.
+    /*! Segments are linked to their outer segments by pointer, so closures created inside the same scopes share
+     *  a single chain and creating a closure copies nothing.
+     */
+    class ScopeChain : public ref_counted {
+    public:
+
+                                ScopeChain( const ValueStorage& scopes, ScopeChain* outer );
+
+        Object*                 globalScope( void ) const;
+        Object*                 find( const Name* name, Value* value ) const;
+
+    private:
+
+        ScopeChainPtr           m_outer;
+        ValueArray              m_scopes;
     };
 
     // ** class ScopeStack
     class ScopeStack {
+    friend class Frame;
     public:
 
                                 ScopeStack( int size = 0 );
-                                ScopeStack( const ScopeStack& other );
-                                ~ScopeStack( void );
 
         Object*                 operator [] ( int index ) const;
 
@@ -70,18 +170,30 @@ namespace avm2 {
         int                     size( void ) const;
         void                    push( Object* value, const char* pushedBy = "" );
         Object*                 find( const Name* name, Value* value ) const;
-        void                    clear( void ) { m_stack.clear(); m_pushedBy.clear(); }
+        void                    clear( void ) { m_stack.clear(); m_chain = NULL; AVM2_DEBUG_TRACE( m_pushedBy.clear() ); }
 
         Object*                 top( int index = 0 ) const { return (*this)[size() - index - 1]; }
         void                    pop( void );
-        Str                     pushedBy( int index ) const { return m_pushedBy[index]; }
-        void                    setOuter( const ScopeStack* value );
+        Str                     pushedBy( int index ) const;
+        void                    setOuter( ScopeChain* value );
+        //! Returns an immutable chain of all scopes, shared by closures until the next push or pop.
+        ScopeChain*             capture( void ) const;
+        //! Returns a chain of scopes captured by an enclosing closure.
+        ScopeChain*             outer( void ) const;
+
+    private:
+
+                                ScopeStack( const ScopeStack& );
+        void                    operator = ( const ScopeStack& );
 
     private:
 
-        ScopeStack*             m_outer;
-        array<gc_ptr<Object> >  m_stack;
+        ScopeChainPtr           m_outer;
+        mutable ScopeChainPtr   m_chain;    //!< The last captured chain, reset once the scope stack changes.
+        ValueStorage            m_stack;
+    #if AVM2_DEBUG
         array<Str>              m_pushedBy;
+    #endif
     };
 
 } // namespace avm2
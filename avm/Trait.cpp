@@ -35,13 +35,21 @@ namespace avm2
 
 // ---------------------------------------------- Traits ----------------------------------------------- //
 
+// ** Traits::Traits
+Traits::Traits( void ) : m_isFlattened( false )
+{
+
+}
+
 // ** Traits::addTrait
-void Traits::addTrait( const Str& owner, const QName* name, const ::avm2::Class* valueType, const Value& value, Type type, int slot, Uint8 attr )
+void Traits::addTrait( const Str& owner, const QName* name, const ::avm2::Class* valueType, const Value& value, Type type, int slot, Uint8 attr, int dispId )
 {
     assert( name );
 
     const Namespace* ns     = name->ns();
 
+    m_isFlattened = false;
+
     if( type == Setter || type == Getter ) {
         addProperty( owner, name, value, type, slot, attr );
         return;
@@ -52,6 +60,7 @@ void Traits::addTrait( const Str& owner, const QName* name, const ::avm2::Class*
     trait.m_value  = value.isUndefined() ? defaultValueForType( valueType ) : value;
     trait.m_type   = type;
     trait.m_slot   = slot;
+    trait.m_dispId = type == Method ? dispId : 0;
     trait.m_attr   = attr;
 
     if( ::avm2::Function* function = value.asFunction() ) {
@@ -67,7 +76,9 @@ void Traits::mergeTraits( const Str& ns, const Traits* traits )
     if( traits == NULL ) {
         return;
     }
-    
+
+    m_isFlattened = false;
+
     for( TraitRegistry::const_iterator i = traits->m_traits.begin(), end = traits->m_traits.end(); i != end; ++i ) {
         m_traits.set( ns + "." + i->second.m_name->name(), i->second );
     }
@@ -99,6 +110,7 @@ void Traits::addProperty( const Str& owner, const QName* name, const Value& valu
         trait.m_value  = Value( Value::undefined, Value::undefined );
         trait.m_type   = type;
         trait.m_slot   = slot;
+        trait.m_dispId = 0;
         trait.m_attr   = attr;
         m_traits.set( name->qualifiedName(), trait );
     }
@@ -123,12 +135,12 @@ void Traits::addProperty( const Str& owner, const QName* name, const Value& valu
 }
 
 // ** Traits::setSlots
-void Traits::setSlots( ValueArray& slots ) const
+void Traits::setSlots( Value* slots, int count ) const
 {
-    assert( slots.size() > slotCount() );
+    assert( count > slotCount() );
 
     if( m_super != NULL ) {
-        m_super->setSlots( slots );
+        m_super->setSlots( slots, count );
     }
 
     for( TraitRegistry::const_iterator i = m_traits.begin(), end = m_traits.end(); i != end; ++i ) {
@@ -148,7 +160,8 @@ int Traits::slotCount( void ) const
 void Traits::setSuper( Traits* value )
 {
     assert( m_super == NULL );
-    m_super = value;
+    m_super       = value;
+    m_isFlattened = false;
 
     if( m_super == NULL ) {
         return;
@@ -161,6 +174,9 @@ void Traits::setSuper( Traits* value )
         switch( trait.m_type ) {
         case Method:    {
                             FunctionScript* function = cast_to<FunctionScript>( trait.m_value.asFunction() );
+                            if( function ) {
+                                function->setSuperTraits( m_super.get() );
+                            }
                             if( function && m_super->findTrait( i->first, trait.m_type, super ) ) {
                                 function->setSuper( super.m_value.asFunction() );
                             }
@@ -207,6 +223,127 @@ void Traits::assignSlots( void )
             idx++;
         }
     }
+
+    flatten();
+}
+
+// ** Traits::flatten
+void Traits::flatten( void )
+{
+    m_slots.clear();
+    collectSlots( m_slots );
+    buildDispatchTable();
+    m_isFlattened = true;
+}
+
+// ** Traits::buildDispatchTable
+void Traits::buildDispatchTable( void )
+{
+    // ** Inherited methods keep their dispatch indices, index zero is never used
+    if( m_super != NULL ) {
+        m_methods     = m_super->m_methods;
+        m_dispatchIds = m_super->m_dispatchIds;
+    } else {
+        m_methods.clear();
+        m_dispatchIds.clear();
+    }
+
+    if( m_methods.size() == 0 ) {
+        m_methods.resize( 1 );
+    }
+
+    m_dispatchIds.resize( slotCount() + 1 );
+
+    for( TraitRegistry::iterator i = m_traits.begin(), end = m_traits.end(); i != end; ++i ) {
+        Trait&              trait    = i->second;
+        ::avm2::Function*   function = trait.m_value.asFunction();
+
+        if( trait.m_type != Method || function == NULL ) {
+            continue;
+        }
+
+        const Traits* base      = this;
+        int           inherited = 0;
+        int           id        = 0;
+        int           count     = m_methods.size();
+
+        // ** Overrides take the dispatch index of a base method, so calls through the base index reach them
+        if( m_super != NULL && m_super->resolveSlot( i->first, TraitRead, inherited ) && ( id = m_super->dispatchId( inherited ) ) != 0 ) {
+            base = m_methods[id].m_base;
+        }
+        // ** Otherwise an index assigned by a compiler is used unless it's already taken
+        else if( trait.m_dispId > 0 && trait.m_dispId <= count + m_traits.size() && ( trait.m_dispId >= count || m_methods[trait.m_dispId].m_function == NULL ) ) {
+            id = trait.m_dispId;
+        }
+        else {
+            id = count;
+        }
+
+        if( id >= m_methods.size() ) {
+            m_methods.resize( id + 1 );
+        }
+
+        if( trait.m_slot >= m_dispatchIds.size() ) {
+            m_dispatchIds.resize( trait.m_slot + 1 );
+        }
+
+        m_methods[id].m_function    = function;
+        m_methods[id].m_base        = base;
+        m_dispatchIds[trait.m_slot] = id;
+        trait.m_dispId              = id;
+    }
+}
+
+// ** Traits::dispatchId
+int Traits::dispatchId( int slot ) const
+{
+    return slot > 0 && slot < m_dispatchIds.size() ? m_dispatchIds[slot] : 0;
+}
+
+// ** Traits::resolveDispatchId
+int Traits::resolveDispatchId( const Name* name ) const
+{
+    const Multiname* mname = name->isMultiname();
+    const QName*     qname = name->isQName();
+
+    if( !mname && !qname ) {
+        return 0;
+    }
+
+    for( int i = 0, n = mname ? mname->count() : 1; i < n; i++ ) {
+        int slot = 0;
+
+        if( resolveSlot( mname ? mname->atom( i ) : qname->atom(), TraitRead, slot ) ) {
+            return dispatchId( slot );
+        }
+    }
+
+    return 0;
+}
+
+// ** Traits::method
+::avm2::Function* Traits::method( int dispId ) const
+{
+    return m_methods[dispId].m_function.get();
+}
+
+// ** Traits::dispatchBase
+const Traits* Traits::dispatchBase( int dispId ) const
+{
+    return dispId > 0 && dispId < m_methods.size() ? m_methods[dispId].m_base : NULL;
+}
+
+// ** Traits::collectSlots
+void Traits::collectSlots( string_hash<int>& slots ) const
+{
+    if( m_super != NULL ) {
+        m_super->collectSlots( slots );
+    }
+
+    // ** Own traits override the inherited ones
+    for( TraitRegistry::const_iterator i = m_traits.begin(), end = m_traits.end(); i != end; ++i ) {
+        slots.set( i->first, i->second.m_slot );
+    }
 }
 
 // ** Traits::isSlotFree
@@ -224,11 +361,28 @@ bool Traits::isSlotFree( int idx ) const
 // ** Traits::resolveSlot
 bool Traits::resolveSlot( const Str& name, TraitAccess access, int& slot ) const
 {
+    return resolveSlot( name, TraitRegistry::compute_hash( name ), access, slot );
+}
+
+// ** Traits::resolveSlot
+bool Traits::resolveSlot( const Atom& name, TraitAccess access, int& slot ) const
+{
+    return resolveSlot( name.m_value, name.m_hash, access, slot );
+}
+
+// ** Traits::resolveSlot
+bool Traits::resolveSlot( const Str& name, int hash, TraitAccess access, int& slot ) const
+{
+    // ** A flattened table has all inherited traits, so a single probe is enough
+    if( m_isFlattened ) {
+        return m_slots.get( name, hash, &slot );
+    }
+
     Trait trait;
 
     // ** Find trait by name
-    if( m_traits.get( name, &trait ) == false ) {
-        return m_super != NULL ? m_super->resolveSlot( name, access, slot ) : false;
+    if( m_traits.get( name, hash, &trait ) == false ) {
+        return m_super != NULL ? m_super->resolveSlot( name, hash, access, slot ) : false;
     }
 
     slot = trait.m_slot;
@@ -60,31 +60,64 @@ namespace avm2 {
             Value           m_value;
             Type            m_type;
             int             m_slot;
+            int             m_dispId;   //!< Index of a method inside the dispatch table, zero for other traits.
             Uint8           m_attr;
         };
 
+        // ** struct DispatchEntry
+        //! An entry of the method dispatch table.
+        struct DispatchEntry {
+                            DispatchEntry( void ) : m_base( NULL ) {}
+
+            FunctionPtr     m_function;
+            const Traits*   m_base;     //!< Traits that introduced this dispatch index, shared by all overrides.
+        };
+
+        typedef array<DispatchEntry> DispatchTable;
+
     public:
 
-        void            addTrait( const Str& owner, const QName* name, const ::avm2::Class* valueType, const Value& value, Type type, int slot, Uint8 attr );
+                        Traits( void );
+
+        void            addTrait( const Str& owner, const QName* name, const ::avm2::Class* valueType, const Value& value, Type type, int slot, Uint8 attr, int dispId = 0 );
         void            assignSlots( void );
         void            setSuper( Traits* value );
-        void            setSlots( ValueArray& slots ) const;
+        void            setSlots( Value* slots, int count ) const;
         bool            resolveSlot( const Str& name, TraitAccess access, int& slot ) const;
+        bool            resolveSlot( const Atom& name, TraitAccess access, int& slot ) const;
         int             slotCount( void ) const;
         void            mergeTraits( const Str& ns, const Traits* traits );
+        void            flatten( void );
+        //! Returns a dispatch index of a method held by a given slot, or zero if the slot holds anything else.
+        int             dispatchId( int slot ) const;
+        //! Returns a dispatch index of a method a given name resolves to, or zero if there is no such method.
+        int             resolveDispatchId( const Name* name ) const;
+        //! Returns a method at a given dispatch index.
+        ::avm2::Function* method( int dispId ) const;
+        //! Returns traits that introduced a given dispatch index, or NULL if there is no such index.
+        const Traits*   dispatchBase( int dispId ) const;
 
     private:
 
         void            addProperty( const Str& owner, const QName* name, const Value& value, Type type, int slot, Uint8 attr );
         bool            findTrait( const Str& name, Type type, Trait& trait ) const;
+        bool            resolveSlot( const Str& name, int hash, TraitAccess access, int& slot ) const;
         Value           defaultValueForType( const ::avm2::Class* type ) const;
         bool            isSlotFree( int idx ) const;
+        void            collectSlots( string_hash<int>& slots ) const;
+        void            buildDispatchTable( void );
 
     private:
 
         typedef string_hash<Trait>  TraitRegistry;
+        typedef string_hash<int>    SlotRegistry;
+
         TraitRegistry   m_traits;
         TraitsWeak      m_super;
+        SlotRegistry    m_slots;        //!< Slots of all own and inherited traits, valid once flattened.
+        DispatchTable   m_methods;      //!< Method dispatch table with all inherited methods, overrides replace entries of their base methods.
+        IntegerArray    m_dispatchIds;  //!< Dispatch indices of methods by a slot.
+        bool            m_isFlattened;
     };
 
 } // namespace avm2
@@ -66,50 +66,56 @@ bool string_to_number(double* result, const char* str)
     return true;
 }
 
+#if AVM2_NAN_BOXING
+    #define ValueInitUndefined  m_bits( Uint64( TagUndefined ) << 48 )
+#else
+    #define ValueInitUndefined  m_type( Undefined )
+#endif
+
 // ** Value::Value
-Value::Value( ::avm2::Object* value ) : m_type( Undefined )
+Value::Value( ::avm2::Object* value ) : ValueInitUndefined
 {
     setObject( value );
 }
 
 // ** Value::Value
-Value::Value( Function* value ) : m_type( Undefined )
+Value::Value( Function* value ) : ValueInitUndefined
 {
     setObject( value );
 }
 
 // ** Value::Value
-Value::Value( float value ) : m_type( Undefined )
+Value::Value( float value ) : ValueInitUndefined
 {
     setNumber( value );
 }
 
 // ** Value::Value
-Value::Value( int value ) : m_type( Undefined )
+Value::Value( int value ) : ValueInitUndefined
 {
-    setNumber( value );
+    setInt( value );
 }
 
 // ** Value::Value
-Value::Value( unsigned int value ) : m_type( Undefined )
+Value::Value( unsigned int value ) : ValueInitUndefined
 {
-    setNumber( value );
+    setUInt( value );
 }
 
 // ** Value::Value
-Value::Value( double value ) : m_type( Undefined )
+Value::Value( double value ) : ValueInitUndefined
 {
     setNumber( value );
 }
 
 // ** Value::Value
-Value::Value( bool value ) : m_type( Undefined )
+Value::Value( bool value ) : ValueInitUndefined
 {
     setBool( value );
 }
 
 // ** Value::Value
-Value::Value( FunctionNative* func ) : m_type( Undefined )
+Value::Value( FunctionNative* func ) : ValueInitUndefined
 {
     setFunction( func );
 }
@@ -121,19 +127,19 @@ Value::Value( FunctionNative* func ) : m_type( Undefined )
 //}
 
 // ** Value::Value
-Value::Value( const Value& getter, const Value& setter ) : m_type( Property )
+Value::Value( const Value& getter, const Value& setter ) : ValueInitUndefined
 {
-    m_property = new as_property( getter, setter );
+    setProperty( new as_property( getter, setter ) );
 }
 
 // ** Value::Value
-Value::Value( const char* value) : m_type( Undefined )
+Value::Value( const char* value) : ValueInitUndefined
 {
     setString( value );
 }
 
 // ** Value::Value
-Value::Value( const wchar_t* value )	: m_type( String )
+Value::Value( const wchar_t* value )	: ValueInitUndefined
 {
     // Encode the string value as UTF-8.
     //
@@ -153,33 +159,39 @@ Value::Value( const wchar_t* value )	: m_type( String )
     // way to do it.  Everything else just
     // continues to work.
 
+    Str encoded;
+
 #if (WCHAR_MAX != MAXLONG)
-    tu_string::encode_utf8_from_wchar( &m_string, (const uint16 *)value );
+    tu_string::encode_utf8_from_wchar( &encoded, (const uint16 *)value );
 #else
 # if (WCHAR_MAX != MAXSHORT)
 # error "Can't determine the size of wchar_t"
 # else
-    tu_string::encode_utf8_from_wchar( &m_string, (const uint32 *)value );
+    tu_string::encode_utf8_from_wchar( &encoded, (const uint32 *)value );
 # endif
 #endif
+
+    setString( encoded );
 }
 
 // ** Value::Value
-Value::Value( void ) : m_type( Undefined )
+Value::Value( void ) : ValueInitUndefined
 {
 }
 
 // ** Value::Value
-Value::Value( const Value& value ) : m_type( Undefined )
+Value::Value( const Value& value ) : ValueInitUndefined
 {
     *this = value;
 }
 
+#undef ValueInitUndefined
+
 // ** Value::valueOf
 Value Value::valueOf( void ) const
 {
-    switch( m_type ) {
-    case Object:    return m_object ? m_object->valueOf() : Value::null;
+    switch( typeId() ) {
+    case Object:    return object() ? object()->valueOf() : Value::null;
     default:        break;
     }
 
@@ -192,29 +204,40 @@ const char*	Value::asCString( void ) const
     return asString().c_str();
 }
 
+// ** Value::asStringCopy
+Str Value::asStringCopy( void ) const
+{
+    return asString();
+}
+
 // ** Value::asString
 const Str& Value::asString( void ) const
 {
-    switch( m_type ) {
-    case String:                                            break;
-    case Undefined: m_string = "undefined";                 break;
-    case Boolean:   m_string = m_bool ? "true" : "false";   break;
-    case Number:    if( isnan( m_number ) ) {
+    if( typeId() == String ) {
+        return string();
+    }
+
+    Str& result = conversionBuffer();
+
+    switch( typeId() ) {
+    case Undefined: result = "undefined";                   break;
+    case Boolean:   result = boolean() ? "true" : "false";  break;
+    case Number:    if( isnan( number() ) ) {
                         // @@ Moock says if value is a NAN, then result is "NaN"
                         // INF goes to "Infinity"
                         // -INF goes to "-Infinity"
-                        m_string = "NaN";
+                        result = "NaN";
                     }
-                    else if( isinf( m_number ) ) {
-                        m_string = "Infinity";
+                    else if( isinf( number() ) ) {
+                        result = "Infinity";
                     }
-                    else if( m_number == 0.0 ) {
-                        m_string = "0";
+                    else if( number() == 0.0 ) {
+                        result = "0";
                     }
                     else {
                         char buffer[50];
-                        snprintf( buffer, 50, "%.14g", m_number );
-                        m_string = buffer;
+                        snprintf( buffer, 50, "%.14g", number() );
+                        result = buffer;
                     }
                     break;
 
@@ -223,20 +246,20 @@ const Str& Value::asString( void ) const
                     //
                     // The default toString() returns "[object
                     // Object]" but may be customized.
-                    m_string = m_object == NULL ? "null" : m_object->to_string();
+                    result = object() == NULL ? "null" : object()->to_string();
                     break;
 
     case Property:  assert(false);  break;
     default:        assert(0);
     }
 
-    return m_string;
+    return result;
 }
 
 // ** Value::asNumber
 double Value::asNumber( void ) const
 {
-    switch( m_type ) {
+    switch( typeId() ) {
     case String:    // @@ Moock says the rule here is: if the
                     // string is a valid float literal, then it
                     // gets converted; otherwise it is set to NaN.
@@ -244,14 +267,14 @@ double Value::asNumber( void ) const
                     // Also, "Infinity", "-Infinity", and "NaN"
                     // are recognized.
                     double val;
-                    if( !string_to_number( &val, m_string.c_str() ) ) {
+                    if( !string_to_number( &val, string().c_str() ) ) {
                         val = get_nan();
                     }
                     return val;
 
-    case Number:    return m_number;
-    case Boolean:   return m_bool ? 1 : 0;
-    case Object:    return m_object != NULL ? m_object->to_number() : 0;
+    case Number:    return number();
+    case Boolean:   return boolean() ? 1 : 0;
+    case Object:    return object() != NULL ? object()->to_number() : 0;
 
     case Property:  assert(false); return get_nan();
     case Undefined: return get_nan();
@@ -261,19 +284,19 @@ double Value::asNumber( void ) const
     return 0.0f;
 }
 
-// ** Value::asInt
-int Value::asInt( void ) const
+// ** Value::convertToInt
+int Value::convertToInt( void ) const
 {
-    switch( m_type ) {
+    switch( typeId() ) {
     case String:    int val;
-                    if( !string_to_number( &val, m_string.c_str() ) ) {
+                    if( !string_to_number( &val, string().c_str() ) ) {
                         val = 0;
                     }
                     return val;
 
-    case Number:    return isnan( m_number ) ? 0 : m_number;
-    case Boolean:   return m_bool ? 1 : 0;
-    case Object:    return m_object != NULL ? m_object->to_number() : 0;
+    case Number:    return toInt32( number() );
+    case Boolean:   return boolean() ? 1 : 0;
+    case Object:    return object() != NULL ? toInt32( object()->to_number() ) : 0;
     case Property:  assert(false); return get_nan();
     case Undefined: return 0;
     default:        return 0;
@@ -282,15 +305,35 @@ int Value::asInt( void ) const
     return 0;
 }
 
+// ** Value::toInt32
+int Value::toInt32( double value )
+{
+    if( value >= -2147483648.0 && value < 2147483648.0 ) {
+        return int( value );
+    }
+
+    if( isnan( value ) || isinf( value ) ) {
+        return 0;
+    }
+
+    // ** Out of range values wrap around modulo 2^32
+    double wrapped = fmod( value < 0 ? ceil( value ) : floor( value ), 4294967296.0 );
+    if( wrapped < 0 ) {
+        wrapped += 4294967296.0;
+    }
+
+    return int( Uint32( wrapped ) );
+}
+
 // ** Value::asBool
 bool Value::asBool( void ) const
 {
-    switch (m_type) {
-    case String:    return m_string.size() > 0 ? true : false;
-    case Object:    return m_object != NULL ? m_object->to_bool() : false;
+    switch( typeId() ) {
+    case String:    return string().size() > 0 ? true : false;
+    case Object:    return object() != NULL ? object()->to_bool() : false;
     case Property:  assert(false); return false;
-    case Number:    return m_number != 0;
-    case Boolean:   return m_bool;
+    case Number:    return number() != 0;
+    case Boolean:   return boolean();
     case Undefined: return false;
     default:        assert(0);
     }
@@ -301,8 +344,8 @@ bool Value::asBool( void ) const
 // ** Value::asObject
 Object*	Value::asObject( void ) const
 {
-    switch( m_type ) {
-    case Object:    return m_object.get();
+    switch( typeId() ) {
+    case Object:    return object();
 //    case Property:  assert( false ); return NULL;
     default:        break;
     }
@@ -316,6 +359,33 @@ Class* Value::asClass( void ) const
     return cast_to<Class>( asObject() );
 }
 
+// ** Value::asIndex
+bool Value::asIndex( int* index ) const
+{
+    if( isInt() ) {
+        *index = integer();
+        return *index >= 0 && *index <= Array::MaxIndex;
+    }
+
+    if( isUInt() ) {
+        *index = int( uinteger() );
+        return uinteger() <= Array::MaxIndex;
+    }
+
+    if( typeId() != Number ) {
+        return false;
+    }
+
+    double value = number();
+
+    if( value >= 0.0 && value <= Array::MaxIndex && value == floor( value ) ) {
+        *index = int( value );
+        return true;
+    }
+
+    return false;
+}
+
 // ** Value::asFunction
 Function* Value::asFunction( void ) const
 {
@@ -334,10 +404,8 @@ IntegerArray Value::asIntegerArray( void ) const
     IntegerArray result;
 
     if( Array* array = asArray() ) {
-        const ValueArray& items = array->items();
-
-        for( int i = 0, n = ( int )items.size(); i < n; i++ ) {
-            result.push_back( items[i].asInt() );
+        for( int i = 0, n = array->length(); i < n; i++ ) {
+            result.push_back( array->at( i ).asInt() );
         }
     } else {
         result.push_back( asInt() );
@@ -352,10 +420,8 @@ StrArray Value::asStrArray( void ) const
     StrArray result;
 
     if( Array* array = asArray() ) {
-        const ValueArray& items = array->items();
-
-        for( int i = 0, n = ( int )items.size(); i < n; i++ ) {
-            result.push_back( items[i].asString() );
+        for( int i = 0, n = array->length(); i < n; i++ ) {
+            result.push_back( array->at( i ).asString() );
         }
     } else {
         result.push_back( asString() );
@@ -364,24 +430,12 @@ StrArray Value::asStrArray( void ) const
     return result;
 }
 
-// ** Value::setObject
-void Value::setObject( ::avm2::Object* value )
-{
-    if( m_type == Object && m_object.get() == value ) {
-        return;
-    }
-
-    dispose();
-    m_type   = Object;
-    m_object = value;
-}
-
 // ** Value::type
 const char* Value::type( void ) const
 {
-    switch( m_type ) {
-    case Object:    if( m_object ) {
-                        return m_object->m_class != NULL ? m_object->m_class->name().c_str() : "object";
+    switch( typeId() ) {
+    case Object:    if( object() ) {
+                        return object()->m_class != NULL ? object()->m_class->name().c_str() : "object";
                     } else {
                         return "null";
                     }
@@ -397,12 +451,6 @@ const char* Value::type( void ) const
     return "unknown";
 }
 
-// ** Value::typeId
-Value::eType Value::typeId( void ) const
-{
-    return m_type;
-}
-
 // ** Value::is
 bool Value::is( const Class* type ) const
 {
@@ -410,9 +458,9 @@ bool Value::is( const Class* type ) const
         return false;
     }
 
-    switch( m_type ) {
-    case Object:    if( m_object && m_object->m_class != NULL ) {
-                        return m_object->m_class->is( type );
+    switch( typeId() ) {
+    case Object:    if( object() && object()->m_class != NULL ) {
+                        return object()->m_class->is( type );
                     }
                     break;
     case Boolean:   return type->name() == "Boolean";
@@ -426,54 +474,39 @@ bool Value::is( const Class* type ) const
 // ** Value::isFunction
 bool Value::isFunction( void ) const
 {
-    return m_type == Object && cast_to<Function>( m_object.get() ) != NULL;
+    return typeId() == Object && cast_to<Function>( object() ) != NULL;
 }
 
 // ** Value::isArray
 bool Value::isArray( void ) const
 {
-    return m_type == Object && cast_to<Array>( m_object.get() ) != NULL;
+    return typeId() == Object && cast_to<Array>( object() ) != NULL;
 }
 
 // ** Value::isStringObject
 bool Value::isStringObject( void ) const
 {
     typedef ::avm2::String StringType;
-    return m_type == Object && cast_to<StringType>( m_object.get() ) != NULL;
-}
-
-// ** Value::operator =
-void Value::operator = ( const Value& other )
-{
-    switch( other.m_type ) {
-    case Undefined: setUndefined();                 break;
-    case Number:    setNumber( other.m_number );    break;
-    case Boolean:   setBool( other.m_bool );        break;
-    case String:    setString( other.m_string );    break;
-    case Object:    setObject( other.m_object );    break;
-    case Property:  dispose();
-                    m_type      = Property;
-                    m_property  = other.m_property;
-                    break;
-
-    default:        assert(0);
-    }
+    return typeId() == Object && cast_to<StringType>( object() ) != NULL;
 }
 
 // ** Value::operator ==
 bool Value::operator == ( const Value& other ) const
 {
-    if( m_type != Property && other.m_type != Property && m_type != other.m_type)
+    eType type      = typeId();
+    eType otherType = other.typeId();
+
+    if( type != Property && otherType != Property && type != otherType)
     {
         return (isUndefined() && other.isNull()) || (isNull() && other.isUndefined());
     }
 
-    switch( m_type ) {
-    case Undefined: return other.m_type   == Undefined;
-    case String:    return m_string       == other.asString();
-    case Number:    return m_number       == other.asNumber();
-    case Boolean:   return m_bool         == other.asBool();
-    case Object:    return isStringObject() ? asString() == other.asString() : m_object.get() == other.asObject();
+    switch( type ) {
+    case Undefined: return otherType    == Undefined;
+    case String:    return string()     == other.asString();
+    case Number:    return isInt() && other.isInt() ? integer() == other.integer() : number() == other.asNumber();
+    case Boolean:   return boolean()    == other.asBool();
+    case Object:    return isStringObject() ? asString() == other.asString() : object() == other.asObject();
     case Property:  assert( false ); return false;
     default:        assert( false ); return false;
     }
@@ -485,6 +518,232 @@ bool Value::operator != ( const Value& other ) const
     return !(*this == other);
 }
 
+// ** Value::asProperty
+Property* Value::asProperty( void ) const
+{
+    return isProperty() ? property() : NULL;
+}
+
+// ** Value::setFunction
+void Value::setFunction( FunctionNative* func )
+{
+    setObject( func );
+}
+
+#if AVM2_NAN_BOXING
+
+// ** InternedString::intern
+InternedString* InternedString::intern( const Str& value )
+{
+    InternedString* result = NULL;
+
+    if( !internedStrings().get( value, &result ) ) {
+        result = new InternedString;
+        result->m_value    = value;
+        result->m_refCount = 0;
+        internedStrings().add( value, result );
+    }
+
+    result->m_refCount++;
+    return result;
+}
+
+// ** InternedString::release
+void InternedString::release( void )
+{
+    assert( m_refCount > 0 );
+
+    if( --m_refCount == 0 ) {
+        internedStrings().erase( m_value );
+        delete this;
+    }
+}
+
+// ** InternedString::internedStrings
+string_hash<InternedString*>& InternedString::internedStrings( void )
+{
+    static string_hash<InternedString*> strings;
+    return strings;
+}
+
+// ** Value::conversionBuffer
+Str& Value::conversionBuffer( void ) const
+{
+    // ** A NaN-boxed Value has no room for a converted string, so asString results
+    //    live in a small ring of buffers and stay valid for the next few conversions.
+    static Str  buffers[16];
+    static int  index = 0;
+
+    return buffers[index++ & 15];
+}
+
+// ** Value::retain
+void Value::retain( void ) const
+{
+    switch( tag() ) {
+    case TagString:     reinterpret_cast<InternedString*>( pointer() )->m_refCount++;
+                        break;
+    case TagObject:     if( object() ) {
+                            gc_ptr<class Object> ref( object() );
+                            ref.raw_set_ptr_gc_access_only( NULL );
+                        }
+                        break;
+    case TagProperty:   {
+                            gc_ptr<as_property> ref( property() );
+                            ref.raw_set_ptr_gc_access_only( NULL );
+                        }
+                        break;
+    default:            break;
+    }
+}
+
+// ** Value::dispose
+void Value::dispose( void )
+{
+    switch( tag() ) {
+    case TagString:     reinterpret_cast<InternedString*>( pointer() )->release();
+                        break;
+    case TagObject:     if( object() ) {
+                            // ** Dropping the reference through a temporary gc_ptr lets the collector destroy the object
+                            gc_ptr<class Object> ref;
+                            ref.raw_set_ptr_gc_access_only( object() );
+                        }
+                        break;
+    case TagProperty:   {
+                            gc_ptr<as_property> ref;
+                            ref.raw_set_ptr_gc_access_only( property() );
+                        }
+                        break;
+    default:            return;
+    }
+
+    setBits( TagUndefined, 0 );
+}
+
+// ** Value::operator =
+void Value::operator = ( const Value& other )
+{
+    if( this == &other ) {
+        return;
+    }
+
+    other.retain();
+    dispose();
+    m_bits = other.m_bits;
+}
+
+// ** Value::setObject
+void Value::setObject( ::avm2::Object* value )
+{
+    if( tag() == TagObject && object() == value ) {
+        return;
+    }
+
+    assert( (reinterpret_cast<Uint64>( value ) >> 48) == 0 );
+
+    Value result;
+    result.setBits( TagObject, reinterpret_cast<Uint64>( value ) );
+    result.retain();
+
+    *this = result;
+}
+
+// ** Value::setProperty
+void Value::setProperty( as_property* value )
+{
+    Value result;
+    result.setBits( TagProperty, reinterpret_cast<Uint64>( value ) );
+    result.retain();
+
+    *this = result;
+}
+
+// ** Value::setUndefined
+void Value::setUndefined( void )
+{
+    dispose();
+    setBits( TagUndefined, 0 );
+}
+
+// ** Value::setNumber
+void Value::setNumber( double value )
+{
+    dispose();
+
+    // ** All NaNs are collapsed to a single quiet NaN, so they never collide with tagged values
+    if( isnan( value ) ) {
+        m_bits = 0x7FF8000000000000ULL;
+        return;
+    }
+
+    union { double number; Uint64 bits; } cast;
+    cast.number = value;
+    m_bits = cast.bits;
+}
+
+// ** Value::setInt
+void Value::setInt( int value )
+{
+    dispose();
+    setBits( TagInt, Uint32( value ) );
+}
+
+// ** Value::setUInt
+void Value::setUInt( Uint32 value )
+{
+    dispose();
+    setBits( TagInt, Uint64( value ) | (Uint64( 1 ) << 32) );
+}
+
+// ** Value::setBool
+void Value::setBool( bool value )
+{
+    dispose();
+    setBits( TagBoolean, value ? 1 : 0 );
+}
+
+// ** Value::setString
+void Value::setString( const Str& value )
+{
+    // ** Intern before disposing, the value may reference the string stored in this Value
+    InternedString* string = InternedString::intern( value );
+
+    dispose();
+    setBits( TagString, reinterpret_cast<Uint64>( string ) );
+}
+
+// ** Value::setString
+void Value::setString( const char* value )
+{
+    setString( Str( value ) );
+}
+
+#else
+
+// ** Value::conversionBuffer
+Str& Value::conversionBuffer( void ) const
+{
+    return m_string;
+}
+
+// ** Value::operator =
+void Value::operator = ( const Value& other )
+{
+    switch( other.m_type ) {
+    case Undefined: setUndefined();                 break;
+    case Number:    dispose();
+                    m_type       = Number;
+                    m_numberType = other.m_numberType;
+                    m_number     = other.m_number;
+                    break;
+    case Boolean:   setBool( other.m_bool );        break;
+    case String:    setString( other.m_string );    break;
+    case Object:    setObject( other.m_object );    break;
+    case Property:  setProperty( other.m_property );break;
+    default:        assert(0);
+    }
+}
+
 // ** Value::dispose
 void Value::dispose( void )
 {
@@ -492,18 +751,58 @@ void Value::dispose( void )
     m_property = NULL;
 }
 
-// ** Value::asProperty
-Property* Value::asProperty( void ) const
+// ** Value::setObject
+void Value::setObject( ::avm2::Object* value )
+{
+    if( m_type == Object && m_object.get() == value ) {
+        return;
+    }
+
+    dispose();
+    m_type   = Object;
+    m_object = value;
+}
+
+// ** Value::setProperty
+void Value::setProperty( as_property* value )
+{
+    dispose();
+    m_type      = Property;
+    m_property  = value;
+}
+
+// ** Value::setUndefined
+void Value::setUndefined( void )
 {
-    return isProperty() ? m_property : NULL;
+    dispose();
+    m_type = Undefined;
 }
 
 // ** Value::setNumber
 void Value::setNumber( double value )
 {
     dispose();
-    m_type   = Number;
-    m_number = value;
+    m_type       = Number;
+    m_numberType = NumberDouble;
+    m_number     = value;
+}
+
+// ** Value::setInt
+void Value::setInt( int value )
+{
+    dispose();
+    m_type       = Number;
+    m_numberType = NumberInt;
+    m_int        = value;
+}
+
+// ** Value::setUInt
+void Value::setUInt( Uint32 value )
+{
+    dispose();
+    m_type       = Number;
+    m_numberType = NumberUInt;
+    m_uint       = value;
 }
 
 // ** Value::setBool
@@ -514,12 +813,6 @@ void Value::setBool( bool value )
     m_bool = value;
 }
 
-// ** Value::setFunction
-void Value::setFunction( FunctionNative* func )
-{
-    setObject( func );
-}
-
 // ** Value::setString
 void Value::setString( const Str& value )
 {
@@ -536,11 +829,18 @@ void Value::setString( const char* value )
     m_string = value;
 }
 
+#endif  /*  AVM2_NAN_BOXING */
+
 // ** Value::add
 Value Value::add( Domain* domain, const Value& a, const Value& b, bool useValueOf )
 {
     typedef ::avm2::String StringType;
 
+    if( a.isInt() && b.isInt() ) {
+        Sint64 sum = Sint64( a.integer() ) + b.integer();
+        return sum == Sint32( sum ) ? Value( int( sum ) ) : Value( double( sum ) );
+    }
+
     Value::eType typeA = a.typeId();
     Value::eType typeB = b.typeId();
 
@@ -564,9 +864,60 @@ Value Value::add( Domain* domain, const Value& a, const Value& b, bool useValueO
     return Value::undefined;
 }
 
+// ** Value::subtract
+Value Value::subtract( const Value& a, const Value& b )
+{
+    if( a.isInt() && b.isInt() ) {
+        Sint64 difference = Sint64( a.integer() ) - b.integer();
+        return difference == Sint32( difference ) ? Value( int( difference ) ) : Value( double( difference ) );
+    }
+
+    return a.asNumber() - b.asNumber();
+}
+
+// ** Value::multiply
+Value Value::multiply( const Value& a, const Value& b )
+{
+    if( a.isInt() && b.isInt() ) {
+        Sint64 product = Sint64( a.integer() ) * b.integer();
+
+        // ** A zero product of a negative operand is -0, which only a double can hold
+        if( product == Sint32( product ) && (product != 0 || (a.integer() >= 0 && b.integer() >= 0)) ) {
+            return Value( int( product ) );
+        }
+    }
+
+    return a.asNumber() * b.asNumber();
+}
+
+// ** Value::negate
+Value Value::negate( const Value& a )
+{
+    if( a.isInt() && a.integer() != 0 && a.integer() != -2147483647 - 1 ) {
+        return Value( -a.integer() );
+    }
+
+    return -a.asNumber();
+}
+
+// ** Value::increment
+Value Value::increment( const Value& a, int delta )
+{
+    if( a.isInt() ) {
+        Sint64 result = Sint64( a.integer() ) + delta;
+        return result == Sint32( result ) ? Value( int( result ) ) : Value( double( result ) );
+    }
+
+    return Value( double( a.asNumber() + delta ) );
+}
+
 // ** Value::compare
 bool Value::compare( const Value& a, const Value& b )
 {
+    if( a.isInt() && b.isInt() ) {
+        return a.integer() == b.integer();
+    }
+
     return a.valueOf() == b.valueOf();
 }
 
@@ -58,6 +58,7 @@ namespace avm2
 
     // ** class Value
 	class Value {
+    friend class Jit;
     public:
 
         // ** enum eType
@@ -102,7 +103,7 @@ namespace avm2
 		//! Returns a string representation of this Value type.
         const char*                 type( void ) const;
         //! Returns the Value type id.
-        eType                       typeId( void ) const;
+        inline eType                typeId( void ) const;
 		//! Returns true if this Value is of a given type.
         bool                        is( const Class* type ) const;
 		//! Returns true if this Value is a Function.
@@ -118,6 +119,10 @@ namespace avm2
 		inline bool                 isString( void ) const;
 		//! Returns true if this Value is a Number.
 		inline bool                 isNumber( void ) const;
+		//! Returns true if this Value is a Number stored as a 32-bit signed integer.
+		inline bool                 isInt( void ) const;
+		//! Returns true if this Value is a Number stored as a 32-bit unsigned integer.
+		inline bool                 isUInt( void ) const;
 		//! Returns true if this Value is an Object.
 		inline bool                 isObject( void ) const;
 		//! Returns true if this Value is a Property.
@@ -130,20 +135,28 @@ namespace avm2
 		//! Returns true if this Value is undefined.
 		inline bool                 isUndefined( void ) const;
 
-		//! Returns the string representation of a Value as a C string.
+		//! Returns the string representation of a Value as a C string, valid as long as the asString result.
         const char*                 asCString( void ) const;
 		//! Returns the string representation of a Value.
+        /*! A converted string is held by the Value and is overwritten by its next conversion. With AVM2_NAN_BOXING
+         *  it lives in a shared ring of 16 buffers instead, so any 16 conversions later, script code included,
+         *  may overwrite it. Callers that keep the result across other calls use asStringCopy.
+         */
         const Str&                  asString( void ) const;
+		//! Returns a copy of the string representation of a Value.
+        Str                         asStringCopy( void ) const;
 		//! Returns the double representation of a Value.
         double                      asNumber( void ) const;
 		//! Returns the integer representation of a Value.
-        int                         asInt( void ) const;
+        inline int                  asInt( void ) const;
 		//! Returns the unsigned integer representation of a Value.
-        Uint32                      asUInt( void ) const { return ( Uint32 )asNumber(); }
+        Uint32                      asUInt( void ) const { return isUInt() ? uinteger() : Uint32( asInt() ); }
 		//! Returns the float representation of a Value.
 		float                       asFloat( void ) const { return ( float )asNumber(); };
 		//! Returns the boolean representation of a Value.
 		bool                        asBool( void ) const;
+		//! Returns true if this Value is a Number that is a valid element index, and writes the index.
+		bool                        asIndex( int* index ) const;
 		//! Returns the pointer to Function if this Value stores a Function object, otherwise NULL.
 		Function*                   asFunction( void ) const;
 		//! Returns the pointer to Array if this Value stores a Array object, otherwise NULL.
@@ -177,7 +190,9 @@ namespace avm2
 		//! Sets this Value to a Boolean.
         void                        setBool( bool value );
 		//! Sets this Value to a Number from a given int value.
-        void                        setInt( int value ) { setNumber( value ); }
+        void                        setInt( int value );
+		//! Sets this Value to a Number from a given unsigned int value.
+        void                        setUInt( Uint32 value );
 		//! Sets this Value to NaN.
         void                        setNaN( void ) { setNumber( get_nan() ); }
 		//! Sets this Value to an Object.
@@ -185,7 +200,7 @@ namespace avm2
 		//! Sets this Value to a Function.
         void                        setFunction( FunctionNative* func );
 		//! Sets this Value to an undefined.
-        void                        setUndefined( void ) { dispose(); m_type = Undefined; }
+        void                        setUndefined( void );
 		//! Sets this Value to a null.
         void                        setNull( void ) { setObject( NULL ); }
 
@@ -194,6 +209,20 @@ namespace avm2
 
         //! Adds two given values.
         static Value                add( Domain* domain, const Value& a, const Value& b, bool useValueOf = true );
+        //! Subtracts two given values, int operands produce an int unless the result overflows.
+        static Value                subtract( const Value& a, const Value& b );
+        //! Multiplies two given values, int operands produce an int unless the result overflows.
+        static Value                multiply( const Value& a, const Value& b );
+        //! Negates a given value.
+        static Value                negate( const Value& a );
+        //! Adds a small delta to a given value, used by increments and decrements.
+        static Value                increment( const Value& a, int delta );
+        //! Returns true if a < b, int operands are compared without a conversion to double.
+        static inline bool          less( const Value& a, const Value& b );
+        //! Returns true if a <= b, int operands are compared without a conversion to double.
+        static inline bool          lessEqual( const Value& a, const Value& b );
+        //! Converts a double to int with a wrap around, like ToInt32 does in ECMA-262.
+        static int                  toInt32( double value );
         //! Compares two given values.
         static bool                 compare( const Value& a, const Value& b );
         //! Does an inplace type coercion of a given value, returns true on success.
@@ -207,56 +236,287 @@ namespace avm2
 
     private:
 
+        // ** Storage primitives, the only members that depend on a Value encoding.
+
+        //! Returns a stored number, the Value should be a Number.
+        inline double               number( void ) const;
+        //! Returns a stored int, the Value should be an int.
+        inline Sint32               integer( void ) const;
+        //! Returns a stored unsigned int, the Value should be an unsigned int.
+        inline Uint32               uinteger( void ) const;
+        //! Returns a stored boolean, the Value should be a Boolean.
+        inline bool                 boolean( void ) const;
+        //! Returns a stored string, the Value should be a String.
+        inline const Str&           string( void ) const;
+        //! Returns a stored object pointer, the Value should be an Object.
+        inline ::avm2::Object*      object( void ) const;
+        //! Returns a stored property pointer, the Value should be a Property.
+        inline as_property*         property( void ) const;
+        //! Converts a Value that is not an int to integer.
+        int                         convertToInt( void ) const;
+        //! Returns a string used to hold a result of asString conversion.
+        Str&                        conversionBuffer( void ) const;
+        //! Sets this Value to a Property.
+        void                        setProperty( as_property* value );
+
+    private:
+
+    #if AVM2_NAN_BOXING
+        // ** enum Tag
+        //! Values are stored as a double, all other types are packed into the payload of a negative quiet NaN.
+        //! Integers keep 32 bits of a value in the payload, the bit above them marks an unsigned integer.
+        enum Tag {
+            TagInt          = 0xFFF9,
+            TagBoolean      = 0xFFFA,
+            TagUndefined    = 0xFFFB,
+            TagString       = 0xFFFC,
+            TagObject       = 0xFFFD,
+            TagProperty     = 0xFFFE
+        };
+
+        //! Returns a tag stored in the upper 16 bits, any tag below TagInt is a double.
+        Uint16                      tag( void ) const { return Uint16( m_bits >> 48 ); }
+        //! Returns a stored pointer payload.
+        void*                       pointer( void ) const { return reinterpret_cast<void*>( m_bits & 0x0000FFFFFFFFFFFFULL ); }
+        //! Stores a tagged payload.
+        void                        setBits( Uint16 tag, Uint64 payload ) { m_bits = (Uint64( tag ) << 48) | payload; }
+        //! Increments a reference counter of a stored String, Object or Property.
+        void                        retain( void ) const;
+
+		//! Encoded value.
+        Uint64                      m_bits;
+    #else
+        // ** enum NumberType
+        enum NumberType {
+            NumberDouble,
+            NumberInt,
+            NumberUInt
+        };
+
 		//! Value type.
 		eType                       m_type;
+        //! Representation of a Number, fills the padding before the union.
+        NumberType                  m_numberType;
 		union {
 			double  m_number;
 			bool    m_bool;
+            Sint32  m_int;
+            Uint32  m_uint;
 		};
 
         mutable Str                 m_string;	//! String value.
 		gc_ptr<class Object>        m_object;	//! Object value.
 		gc_ptr<as_property>         m_property;	//! Property value.
+    #endif
 	};
 
+#if AVM2_NAN_BOXING
+    // ** struct InternedString
+    //! A reference counted string shared by all NaN-boxed Values with an equal content.
+    struct InternedString {
+        Str                         m_value;
+        int                         m_refCount;
+
+        //! Returns an interned string with a given content, the caller owns a new reference.
+        static InternedString*      intern( const Str& value );
+        //! Drops a reference, the string is removed from the intern table once it becomes unused.
+        void                        release( void );
+
+    private:
+
+        //! Returns the intern table.
+        static string_hash<InternedString*>& internedStrings( void );
+    };
+
+    // ** Value::typeId
+    inline Value::eType Value::typeId( void ) const {
+        switch( tag() ) {
+        case TagInt:        return Number;
+        case TagBoolean:    return Boolean;
+        case TagUndefined:  return Undefined;
+        case TagString:     return String;
+        case TagObject:     return Object;
+        case TagProperty:   return Property;
+        default:            break;
+        }
+
+        return Number;
+    }
+
+    // ** Value::number
+    double Value::number( void ) const {
+        if( tag() == TagInt ) {
+            return isUInt() ? double( uinteger() ) : double( integer() );
+        }
+
+        union { Uint64 bits; double number; } cast;
+        cast.bits = m_bits;
+        return cast.number;
+    }
+
+    // ** Value::integer
+    Sint32 Value::integer( void ) const {
+        return Sint32( m_bits );
+    }
+
+    // ** Value::uinteger
+    Uint32 Value::uinteger( void ) const {
+        return Uint32( m_bits );
+    }
+
+    // ** Value::isInt
+    bool Value::isInt( void ) const {
+        return (m_bits >> 32) == (Uint64( TagInt ) << 16);
+    }
+
+    // ** Value::isUInt
+    bool Value::isUInt( void ) const {
+        return (m_bits >> 32) == ((Uint64( TagInt ) << 16) | 1);
+    }
+
+    // ** Value::boolean
+    bool Value::boolean( void ) const {
+        return (m_bits & 1) != 0;
+    }
+
+    // ** Value::string
+    const Str& Value::string( void ) const {
+        return reinterpret_cast<const InternedString*>( pointer() )->m_value;
+    }
+
+    // ** Value::object
+    ::avm2::Object* Value::object( void ) const {
+        return reinterpret_cast< ::avm2::Object*>( pointer() );
+    }
+
+    // ** Value::property
+    as_property* Value::property( void ) const {
+        return reinterpret_cast<as_property*>( pointer() );
+    }
+
+    // ** Value::isNull
+    bool Value::isNull( void ) const {
+        return m_bits == (Uint64( TagObject ) << 48);
+    }
+#else
+    // ** Value::typeId
+    inline Value::eType Value::typeId( void ) const {
+        return m_type;
+    }
+
+    // ** Value::number
+    double Value::number( void ) const {
+        switch( m_numberType ) {
+        case NumberInt:     return m_int;
+        case NumberUInt:    return m_uint;
+        default:            break;
+        }
+
+        return m_number;
+    }
+
+    // ** Value::integer
+    Sint32 Value::integer( void ) const {
+        return m_int;
+    }
+
+    // ** Value::uinteger
+    Uint32 Value::uinteger( void ) const {
+        return m_uint;
+    }
+
+    // ** Value::isInt
+    bool Value::isInt( void ) const {
+        return m_type == Number && m_numberType == NumberInt;
+    }
+
+    // ** Value::isUInt
+    bool Value::isUInt( void ) const {
+        return m_type == Number && m_numberType == NumberUInt;
+    }
+
+    // ** Value::boolean
+    bool Value::boolean( void ) const {
+        return m_bool;
+    }
+
+    // ** Value::string
+    const Str& Value::string( void ) const {
+        return m_string;
+    }
+
+    // ** Value::object
+    ::avm2::Object* Value::object( void ) const {
+        return m_object.get();
+    }
+
+    // ** Value::property
+    as_property* Value::property( void ) const {
+        return m_property.get();
+    }
+
+    // ** Value::isNull
+    bool Value::isNull( void ) const {
+        return m_type == Object && m_object == NULL;
+    }
+#endif
+
     // ** Value::isBool
     bool Value::isBool( void ) const {
-        return m_type == Boolean;
+        return typeId() == Boolean;
     }
 
     // ** Value::isString
     bool Value::isString( void ) const {
-        return m_type == String;
+        return typeId() == String;
     }
 
     // ** Value::isNumber
     bool Value::isNumber( void ) const {
-        return m_type == Number && isnan(m_number) == false;
+        return typeId() == Number && isnan( number() ) == false;
     }
 
     // ** Value::isObject
     bool Value::isObject( void ) const {
-        return m_type == Object;
+        return typeId() == Object;
     }
 
     // ** Value::isProperty
     bool Value::isProperty( void ) const {
-        return m_type == Property;
-    }
-
-    // ** Value::isNull
-    bool Value::isNull( void ) const {
-        return m_type == Object && m_object == NULL;
+        return typeId() == Property;
     }
 
     // ** Value::isUndefined
     bool Value::isUndefined( void ) const {
-        return m_type == Undefined;
+        return typeId() == Undefined;
     }
 
     // ** Value::isNullOrUndefined
     bool Value::isNullOrUndefined( void ) const {
-        return m_type == Undefined || (m_type == Object && m_object == NULL);
+        return isUndefined() || isNull();
+    }
+
+    // ** Value::asInt
+    int Value::asInt( void ) const {
+        return isInt() ? integer() : convertToInt();
+    }
+
+    // ** Value::less
+    bool Value::less( const Value& a, const Value& b ) {
+        if( a.isInt() && b.isInt() ) {
+            return a.integer() < b.integer();
+        }
+
+        return a.asNumber() < b.asNumber();
+    }
+
+    // ** Value::lessEqual
+    bool Value::lessEqual( const Value& a, const Value& b ) {
+        if( a.isInt() && b.isInt() ) {
+            return a.integer() <= b.integer();
+        }
+
+        return a.asNumber() <= b.asNumber();
     }
 
     typedef std::vector<Value> ValueArray;
@@ -0,0 +1,620 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+#include "Verifier.h"
+#include "Function.h"
+#include "Class.h"
+#include "Multiname.h"
+#include "Dump.h"
+
+// ** Leaves Verifier::step once a check fails, the check has already reported an error.
+#define VerifierCheck( expression ) if( !(expression) ) {                   \
+                                        return Malformed;                   \
+                                    }
+
+namespace avm2
+{
+
+// ** Verifier::Verifier
+Verifier::Verifier( const FunctionScript* function, int localCount, int maxStack, int maxScope )
+    : m_function( function ), m_localCount( localCount ), m_maxStack( maxStack ), m_maxScope( maxScope ), m_instructions( NULL ), m_index( 0 )
+{
+
+}
+
+// ** Verifier::verify
+bool Verifier::verify( Instructions& instructions, const Exceptions& exceptions )
+{
+    m_instructions = &instructions;
+
+    switch( interpret( exceptions ) ) {
+    case Malformed:     return false;
+    case Unsupported:   AVM2_VERBOSE( "Verifier : '%s' is left unverified, %s is not supported\n", m_function->name().c_str(), Dump::formatOpCode( instructions[m_index].opCode ) );
+                        return true;
+    default:            break;
+    }
+
+    // ** Types are joined over all paths, so facts hold whichever way an instruction is reached
+    for( int i = 0, n = ( int )instructions.size(); i < n; i++ ) {
+        if( m_states[i].m_reached ) {
+            instructions[i].flags |= checks( instructions[i], m_states[i] );
+        }
+    }
+
+    return true;
+}
+
+// ** Verifier::interpret
+Verifier::Result Verifier::interpret( const Exceptions& exceptions )
+{
+    int count = ( int )m_instructions->size();
+
+    m_states.resize( count );
+    for( int i = 0; i < count; i++ ) {
+        m_states[i].m_reached = false;
+    }
+
+    if( count == 0 ) {
+        return Verified;
+    }
+
+    // ** Functions are entered with an instance or the global object in local0
+    State entry;
+    entry.m_scope   = 0;
+    entry.m_reached = true;
+    entry.m_registers.resize( m_localCount );
+
+    for( int i = 0; i < m_localCount; i++ ) {
+        entry.m_registers[i] = Unknown;
+    }
+
+    if( m_localCount ) {
+        entry.m_registers[0] = Object;
+    }
+
+    // ** Typed arguments are counted and coerced by FunctionScript::execute before the body runs
+    for( int i = 0, n = m_function->nargs(); i < n && i + 1 < m_localCount; i++ ) {
+        const Class* type = m_function->argType( i );
+
+        if( type == NULL ) {
+            continue;
+        }
+
+        switch( type->typeId() ) {
+        case TypeInt:       entry.m_registers[i + 1] = Int;     break;
+        case TypeNumber:    entry.m_registers[i + 1] = Number;  break;
+        default:            break;
+        }
+    }
+
+    Result result = merge( 0, entry );
+
+    // ** Exception handlers are entered with a thrown value on empty operand and scope stacks
+    for( int i = 0, n = ( int )exceptions.size(); i < n && result == Verified; i++ ) {
+        State handler;
+        handler.m_scope   = 0;
+        handler.m_reached = true;
+        handler.m_stack.push_back( Unknown );
+        handler.m_registers.resize( m_localCount );
+
+        for( int j = 0; j < m_localCount; j++ ) {
+            handler.m_registers[j] = Unknown;
+        }
+
+        result = merge( exceptions[i]->target(), handler );
+    }
+
+    while( m_queue.size() && result == Verified ) {
+        m_index = m_queue.back();
+        m_queue.pop_back();
+
+        State state = m_states[m_index];
+        result = step( state );
+    }
+
+    return result;
+}
+
+// ** Verifier::step
+Verifier::Result Verifier::step( State& state )
+{
+    const Instruction&  i            = (*m_instructions)[m_index];
+    Types&              registers    = state.m_registers;
+    bool                fallsThrough = true;
+
+    switch( i.opCode ) {
+    // ** Locals
+    case GetLocal0:
+    case GetLocal1:
+    case GetLocal2:
+    case GetLocal3:
+    case GetLocal:          {
+                                int index = i.opCode == GetLocal ? i.Integer : i.opCode - GetLocal0;
+                                VerifierCheck( checkLocal( index ) && push( state, registers[index] ) );
+                            }
+                            break;
+
+    case SetLocal1:
+    case SetLocal2:
+    case SetLocal3:
+    case SetLocal:          {
+                                int index = i.opCode == SetLocal ? i.Integer : i.opCode - SetLocal0;
+                                VerifierCheck( checkLocal( index ) && need( state, 1 ) );
+                                registers[index] = top( state, 0 );
+                                pop( state, 1 );
+                            }
+                            break;
+
+    case Kill:              VerifierCheck( checkLocal( i.Integer ) );
+                            registers[i.Integer] = Undefined;
+                            break;
+
+    case IncLocal:
+    case DecLocal:          VerifierCheck( checkLocal( i.Integer ) );
+                            registers[i.Integer] = Number;
+                            break;
+
+    case IncLocalI:
+    case DecLocalI:         VerifierCheck( checkLocal( i.Integer ) );
+                            registers[i.Integer] = Int;
+                            break;
+
+    // ** Scope
+    case PushScope:         VerifierCheck( pop( state, 1 ) );
+                            if( ++state.m_scope > m_maxScope ) {
+                                return error( "scope stack overflow" );
+                            }
+                            break;
+
+    case PopScope:          if( state.m_scope == 0 ) {
+                                return error( "scope stack underflow" );
+                            }
+                            state.m_scope--;
+                            break;
+
+    case GetScopeObject:    if( i.Integer >= state.m_scope ) {
+                                return error( "scope index is out of range" );
+                            }
+                            VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    case GetGlobalScope:    VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    // ** Property access
+    case FindProperty:
+    case FindPropertyStrict:
+    case GetLex:            if( i.Identifier->hasRuntimeNamespace() ) {
+                                return Unsupported;
+                            }
+                            VerifierCheck( pop( state, nameOperands( i ) ) );
+                            VerifierCheck( push( state, i.opCode == FindPropertyStrict ? Object : Unknown ) );
+                            break;
+
+    case GetProperty:       if( i.Identifier->hasRuntimeNamespace() ) {
+                                return Unsupported;
+                            }
+                            VerifierCheck( pop( state, nameOperands( i ) + 1 ) );
+                            VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    case SetProperty:
+    case InitProperty:      if( i.Identifier->hasRuntimeNamespace() ) {
+                                return Unsupported;
+                            }
+                            VerifierCheck( pop( state, nameOperands( i ) + 2 ) );
+                            break;
+
+    case DeleteProperty:    if( i.Identifier->hasRuntimeName() || i.Identifier->hasRuntimeNamespace() ) {
+                                return Unsupported;
+                            }
+                            VerifierCheck( pop( state, 1 ) );
+                            VerifierCheck( push( state, Boolean ) );
+                            break;
+
+    case GetSlot:           VerifierCheck( pop( state, 1 ) );
+                            VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    case SetSlot:           VerifierCheck( pop( state, 2 ) );
+                            break;
+
+    // ** Function invokation
+    case Call:              VerifierCheck( pop( state, i.ArgCount + 2 ) );
+                            VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    case CallProperty:
+    case CallPropVoid:
+    case ConstructProp:     if( i.Identifier->hasRuntimeNamespace() ) {
+                                return Unsupported;
+                            }
+                            VerifierCheck( pop( state, i.ArgCount + nameOperands( i ) + 1 ) );
+                            if( i.opCode != CallPropVoid ) {
+                                VerifierCheck( push( state, Unknown ) );
+                            }
+                            break;
+
+    case Construct:         VerifierCheck( pop( state, i.ArgCount + 1 ) );
+                            VerifierCheck( push( state, Unknown ) );
+                            break;
+
+    // ** The interpreter leaves the object on the stack, only the values above it are tracked
+    case ConstructSuper:    VerifierCheck( pop( state, i.ArgCount + 1 ) );
+                            break;
+
+    case ReturnValue:       VerifierCheck( pop( state, 1 ) );
+                            fallsThrough = false;
+                            break;
+
+    case ReturnVoid:        fallsThrough = false;
+                            break;
+
+    case Throw:             VerifierCheck( pop( state, 1 ) );
+                            fallsThrough = false;
+                            break;
+
+    // ** Instance construction
+    case NewObject:         VerifierCheck( pop( state, i.ArgCount * 2 ) );
+                            VerifierCheck( push( state, Object ) );
+                            break;
+
+    case NewArray:          VerifierCheck( pop( state, i.ArgCount ) );
+                            VerifierCheck( push( state, Object ) );
+                            break;
+
+    case NewClass:          VerifierCheck( pop( state, 1 ) );
+                            VerifierCheck( push( state, Function ) );
+                            break;
+
+    case NewFunction:       VerifierCheck( push( state, Function ) );
+                            break;
+
+    case NewActivation:
+    case NewCatch:          VerifierCheck( push( state, Object ) );
+                            break;
+
+    // ** Type coercion, Coerce and CoerceToAny keep a value as is
+    case Coerce:
+    case CoerceToAny:       VerifierCheck( need( state, 1 ) );
+                            break;
+
+    case ConvertToInt:      VerifierCheck( unary( state, Int ) );       break;
+    case ConvertToUInt:     VerifierCheck( unary( state, UInt ) );      break;
+    case ConvertToDouble:   VerifierCheck( unary( state, Number ) );    break;
+    case ConvertToBool:     VerifierCheck( unary( state, Boolean ) );   break;
+    case ConvertToString:   VerifierCheck( unary( state, String ) );    break;
+
+    case InstanceOf:
+    case IsTypeLate:        VerifierCheck( binary( state, Boolean ) );  break;
+
+    // ** Operand stack
+    case PushNull:          VerifierCheck( push( state, Null ) );       break;
+    case PushUndefined:     VerifierCheck( push( state, Undefined ) );  break;
+    case PushTrue:
+    case PushFalse:         VerifierCheck( push( state, Boolean ) );    break;
+    case PushByte:
+    case PushShort:
+    case PushInt:           VerifierCheck( push( state, Int ) );        break;
+    case PushUInt:          VerifierCheck( push( state, UInt ) );       break;
+    case PushDouble:        VerifierCheck( push( state, Number ) );     break;
+    case PushString:        VerifierCheck( push( state, Object ) );     break;
+
+    case Pop:               VerifierCheck( pop( state, 1 ) );
+                            break;
+
+    case Dup:               VerifierCheck( need( state, 1 ) && push( state, top( state, 0 ) ) );
+                            break;
+
+    case Swap:              {
+                                VerifierCheck( need( state, 2 ) );
+                                Types& stack = state.m_stack;
+                                Type   a     = stack[stack.size() - 1];
+                                stack[stack.size() - 1] = stack[stack.size() - 2];
+                                stack[stack.size() - 2] = a;
+                            }
+                            break;
+
+    // ** Arithmetic, Add concatenates unless both operands are numbers
+    case Add:               VerifierCheck( need( state, 2 ) );
+                            VerifierCheck( binary( state, isNumeric( top( state, 0 ) ) && isNumeric( top( state, 1 ) ) ? Number : Unknown ) );
+                            break;
+
+    case Subtract:
+    case Multiply:          VerifierCheck( binary( state, Number ) );   break;
+    case Negate:
+    case Increment:
+    case Decrement:         VerifierCheck( unary( state, Number ) );    break;
+
+    case AddI:
+    case SubtractI:
+    case MultiplyI:
+    case BitAnd:
+    case BitOr:
+    case BitXOR:
+    case LeftShift:
+    case RightShift:        VerifierCheck( binary( state, Int ) );      break;
+    case URightShift:       VerifierCheck( binary( state, UInt ) );     break;
+
+    case NegateI:
+    case IncrementI:
+    case DecrementI:
+    case BitNot:            VerifierCheck( unary( state, Int ) );       break;
+
+    // ** Comparison
+    case Equals:
+    case StrictEquals:
+    case LessThan:
+    case LessEquals:
+    case GreaterThan:
+    case GreaterEquals:
+    case In:                VerifierCheck( binary( state, Boolean ) );  break;
+
+    // ** Object iteration
+    case HasNext2:          VerifierCheck( checkLocal( i.objectReg ) && checkLocal( i.indexReg ) );
+                            VerifierCheck( push( state, Boolean ) );
+                            registers[i.indexReg] = Unknown;
+                            break;
+
+    case NextName:
+    case NextValue:         VerifierCheck( binary( state, Unknown ) );  break;
+
+    // ** Branching
+    case Label:
+    case Debug:
+    case DebugFile:
+    case DebugLine:         break;
+
+    case Jump:              return merge( i.offset + 1, state );
+
+    case IfTrue:
+    case IfFalse:           VerifierCheck( pop( state, 1 ) );
+                            VerifierCheck( merge( i.offset + 1, state ) == Verified );
+                            break;
+
+    case IfLess:
+    case IfLessEqual:
+    case IfGreater:
+    case IfGreaterEqual:
+    case IfNotLess:
+    case IfNotLessEqual:
+    case IfNotGreater:
+    case IfNotGreaterEqual:
+    case IfNotEqual:
+    case IfStictNotEqual:   VerifierCheck( pop( state, 2 ) );
+                            VerifierCheck( merge( i.offset + 1, state ) == Verified );
+                            break;
+
+    // ** The interpreter lands right after a case target and at a default target
+    case LookupSwitch:      VerifierCheck( pop( state, 1 ) );
+                            for( int j = 0; j <= i.caseCount; j++ ) {
+                                VerifierCheck( merge( i.caseOffsets[j] + 1, state ) == Verified );
+                            }
+                            return merge( i.defaultOffset, state );
+
+    // ** Super access has interpreter specific stack effects, TypeOf and ApplyType don't always push a value
+    default:                return Unsupported;
+    }
+
+    if( !fallsThrough ) {
+        return Verified;
+    }
+
+    if( m_index + 1 >= ( int )m_instructions->size() ) {
+        return error( "control flow falls off the end of the code" );
+    }
+
+    return merge( m_index + 1, state );
+}
+
+// ** Verifier::merge
+Verifier::Result Verifier::merge( int target, const State& state )
+{
+    if( target < 0 || target >= ( int )m_instructions->size() ) {
+        return error( "branch target is out of range" );
+    }
+
+    State& existing = m_states[target];
+
+    if( !existing.m_reached ) {
+        existing = state;
+        m_queue.push_back( target );
+        return Verified;
+    }
+
+    if( existing.m_stack.size() != state.m_stack.size() ) {
+        return error( "operand stack depth differs at a branch target" );
+    }
+
+    if( existing.m_scope != state.m_scope ) {
+        return error( "scope stack depth differs at a branch target" );
+    }
+
+    bool changed = false;
+
+    for( int i = 0, n = ( int )state.m_stack.size(); i < n; i++ ) {
+        Type type = join( existing.m_stack[i], state.m_stack[i] );
+        changed   = changed || type != existing.m_stack[i];
+        existing.m_stack[i] = type;
+    }
+
+    for( int i = 0, n = ( int )state.m_registers.size(); i < n; i++ ) {
+        Type type = join( existing.m_registers[i], state.m_registers[i] );
+        changed   = changed || type != existing.m_registers[i];
+        existing.m_registers[i] = type;
+    }
+
+    if( changed ) {
+        m_queue.push_back( target );
+    }
+
+    return Verified;
+}
+
+// ** Verifier::checks
+int Verifier::checks( const Instruction& instruction, const State& state ) const
+{
+    switch( instruction.opCode ) {
+    case GetProperty:       return isObject( top( state, nameOperands( instruction ) ) ) ? Instruction::NonNullReceiver : 0;
+
+    case CallProperty:
+    case CallPropVoid:
+    case ConstructProp:     return isObject( top( state, instruction.ArgCount + nameOperands( instruction ) ) ) ? Instruction::NonNullReceiver : 0;
+
+    case ConstructSuper:    return isObject( top( state, instruction.ArgCount ) ) ? Instruction::NonNullReceiver : 0;
+    case Call:              return top( state, instruction.ArgCount + 1 ) == Function ? Instruction::CalleeIsFunction : 0;
+    case Construct:         return top( state, instruction.ArgCount ) == Function ? Instruction::CalleeIsFunction : 0;
+    case ConvertToInt:      return top( state, 0 ) == Int ? Instruction::ValueHasType : 0;
+    case ConvertToUInt:     return top( state, 0 ) == UInt ? Instruction::ValueHasType : 0;
+
+    case ReturnValue:       {
+                                const Class* type = m_function->returnType();
+
+                                if( type == NULL ) {
+                                    return Instruction::ValueHasType;
+                                }
+
+                                switch( type->typeId() ) {
+                                case TypeInt:       return top( state, 0 ) == Int ? Instruction::ValueHasType : 0;
+                                case TypeNumber:    return isNumeric( top( state, 0 ) ) ? Instruction::ValueHasType : 0;
+                                default:            break;
+                                }
+                            }
+                            break;
+
+    default:                break;
+    }
+
+    return 0;
+}
+
+// ** Verifier::need
+bool Verifier::need( const State& state, int count )
+{
+    if( ( int )state.m_stack.size() < count ) {
+        error( "operand stack underflow" );
+        return false;
+    }
+
+    return true;
+}
+
+// ** Verifier::pop
+bool Verifier::pop( State& state, int count )
+{
+    if( !need( state, count ) ) {
+        return false;
+    }
+
+    state.m_stack.resize( state.m_stack.size() - count );
+    return true;
+}
+
+// ** Verifier::push
+bool Verifier::push( State& state, Type type )
+{
+    if( ( int )state.m_stack.size() >= m_maxStack ) {
+        error( "operand stack overflow" );
+        return false;
+    }
+
+    state.m_stack.push_back( type );
+    return true;
+}
+
+// ** Verifier::unary
+bool Verifier::unary( State& state, Type result )
+{
+    return pop( state, 1 ) && push( state, result );
+}
+
+// ** Verifier::binary
+bool Verifier::binary( State& state, Type result )
+{
+    return pop( state, 2 ) && push( state, result );
+}
+
+// ** Verifier::checkLocal
+bool Verifier::checkLocal( int index )
+{
+    if( index < 0 || index >= m_localCount ) {
+        error( "local register index is out of range" );
+        return false;
+    }
+
+    return true;
+}
+
+// ** Verifier::error
+Verifier::Result Verifier::error( const char* message )
+{
+    logger::error( "VerifyError: %s at instruction %d (%s) of '%s'\n", message, m_index, Dump::formatOpCode( (*m_instructions)[m_index].opCode ), m_function->name().c_str() );
+    return Malformed;
+}
+
+// ** Verifier::nameOperands
+int Verifier::nameOperands( const Instruction& instruction )
+{
+    return instruction.Identifier->hasRuntimeName() ? 1 : 0;
+}
+
+// ** Verifier::top
+Verifier::Type Verifier::top( const State& state, int index )
+{
+    return state.m_stack[state.m_stack.size() - index - 1];
+}
+
+// ** Verifier::join
+Verifier::Type Verifier::join( Type a, Type b )
+{
+    if( a == b ) {
+        return a;
+    }
+
+    if( isNumeric( a ) && isNumeric( b ) ) {
+        return Number;
+    }
+
+    if( isObject( a ) && isObject( b ) ) {
+        return Object;
+    }
+
+    return Unknown;
+}
+
+// ** Verifier::isNumeric
+bool Verifier::isNumeric( Type type )
+{
+    return type == Int || type == UInt || type == Number;
+}
+
+// ** Verifier::isObject
+bool Verifier::isObject( Type type )
+{
+    return type == Object || type == Function;
+}
+
+} // namespace avm2
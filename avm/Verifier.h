@@ -0,0 +1,120 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+
+#ifndef __avm2__Verifier__
+#define __avm2__Verifier__
+
+#include "Instructions.h"
+#include "Exception.h"
+
+namespace avm2
+{
+    // ** class Verifier
+    //! Link-time abstract interpreter that infers operand stack and register types at each instruction.
+    /*! Function bodies are walked until the types at every reachable instruction reach a fixed point. Registers
+     *  start with the types of coerced arguments and local0 is always an object. Malformed code, like a stack
+     *  underflow or branches that merge operand stacks of a different depth, is reported before anything runs.
+     *  Instructions whose operands are proven to have a right type get Instruction::flags, so handlers skip
+     *  null and undefined checks, isFunction tests and coercions.
+     *
+     *  The model mirrors stack effects of the interpreter handlers. Bodies that use an opcode the interpreter
+     *  can't execute or treats differently from the specification are left unverified and run with all checks.
+     */
+    class Verifier {
+    public:
+
+        // ** enum Type
+        enum Type {
+            Unknown,        //!< Any value, including null and undefined.
+            Undefined,
+            Null,
+            Boolean,
+            Int,            //!< A number stored as int.
+            UInt,           //!< A number stored as uint.
+            Number,         //!< A number stored in any form.
+            String,         //!< A primitive string.
+            Object,         //!< An object that is never null.
+            Function,       //!< A function that is never null.
+        };
+
+                                Verifier( const FunctionScript* function, int localCount, int maxStack, int maxScope );
+
+        //! Verifies instructions and sets flags of instructions with redundant checks, returns false if the code is malformed.
+        bool                    verify( Instructions& instructions, const Exceptions& exceptions );
+
+    private:
+
+        typedef array<Type>     Types;
+
+        // ** struct State
+        //! Types of the operand stack and registers before an instruction.
+        struct State {
+            Types               m_stack;
+            Types               m_registers;
+            int                 m_scope;        //!< Depth of the local scope stack.
+            bool                m_reached;
+        };
+
+        // ** enum Result
+        enum Result {
+            Verified,
+            Malformed,
+            Unsupported,    //!< The body can't be modelled, it is left unverified.
+        };
+
+        Result                  interpret( const Exceptions& exceptions );
+        Result                  step( State& state );
+        Result                  merge( int target, const State& state );
+        int                     checks( const Instruction& instruction, const State& state ) const;
+        bool                    need( const State& state, int count );
+        bool                    pop( State& state, int count );
+        bool                    push( State& state, Type type );
+        bool                    unary( State& state, Type result );
+        bool                    binary( State& state, Type result );
+        bool                    checkLocal( int index );
+        Result                  error( const char* message );
+
+        static int              nameOperands( const Instruction& instruction );
+        static Type             top( const State& state, int index );
+        static Type             join( Type a, Type b );
+        static bool             isNumeric( Type type );
+        static bool             isObject( Type type );
+
+    private:
+
+        const FunctionScript*   m_function;
+        int                     m_localCount;
+        int                     m_maxStack;
+        int                     m_maxScope;
+        const Instructions*     m_instructions;
+        array<State>            m_states;       //!< Types before each instruction.
+        array<int>              m_queue;        //!< Instructions reached with new types since they were interpreted.
+        int                     m_index;        //!< An instruction being interpreted.
+    };
+}
+
+#endif /* defined(__avm2__Verifier__) */
@@ -0,0 +1,697 @@
+/**************************************************************************
+
+ The MIT License (MIT)
+
+ Copyright (c) 2015 Dmitry Sovetov
+
+ https://github.com/dmsovetov
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ The above copyright notice and this permission notice shall be included in all
+ copies or substantial portions of the Software.
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ SOFTWARE.
+
+ **************************************************************************/
+
+//  Interpreter benchmarks that need neither asc.jar nor a compiled ABC file: each workload
+//  assembles its bytecode in memory, then links and runs it. Build the tool at two revisions
+//  (or with different AVM2_* flags) and compare the printed times.
+//
+//      avmbench -workload loop -passes 20 -runs 5
+//
+//  With AVM2_OPCODE_STATS set, "-opstats true" also prints the opcode pairs the workloads were linked to.
+
+#include <Domain.h>
+#include <Linker.h>
+#include <Abc.h>
+#include <Instructions.h>
+#include <Dump.h>
+
+#include <ctime>
+
+#if defined( __GLIBC__ )
+    #include <malloc.h>
+#endif
+
+using namespace avm2;
+
+//! Heap bytes still allocated after the last module ran, only known where the C library reports it.
+static double s_heapGrowth = 0.0;
+
+// ** heapInUse
+static double heapInUse( void )
+{
+#if defined( __GLIBC__ ) && ( __GLIBC__ > 2 || __GLIBC_MINOR__ >= 33 )
+    struct mallinfo2 info = mallinfo2();
+    return double( info.uordblks ) + double( info.hblkhd );
+#elif defined( __GLIBC__ )
+    struct mallinfo info = mallinfo();
+    return double( ( unsigned int )info.uordblks ) + double( ( unsigned int )info.hblkhd );
+#else
+    return 0.0;
+#endif
+}
+
+// ** class Assembler
+//! Writes a method body, branches are patched once labels are placed.
+class Assembler {
+public:
+
+                    Assembler( void );
+
+    Assembler&      op( int opCode );
+    Assembler&      op( int opCode, int operand );
+    Assembler&      op( int opCode, int operand, int argCount );
+    Assembler&      u8( int value );
+    Assembler&      u30( unsigned int value );
+    Assembler&      s24( int value );
+    //! Writes a branch to a label that may be placed later.
+    Assembler&      branch( int opCode, int label );
+    //! Places a label at the current offset.
+    Assembler&      label( int label );
+    //! Patches branch offsets and returns the bytecode.
+    const membuf&   finish( void );
+
+private:
+
+    enum { MaxLabels = 8 };
+
+    membuf          m_code;
+    int             m_labels[MaxLabels];
+    array<int>      m_branches;     //!< Pairs of a branch offset field and a label.
+};
+
+// ** Assembler::Assembler
+Assembler::Assembler( void )
+{
+    for( int i = 0; i < MaxLabels; i++ ) {
+        m_labels[i] = -1;
+    }
+}
+
+// ** Assembler::op
+Assembler& Assembler::op( int opCode )
+{
+    return u8( opCode );
+}
+
+// ** Assembler::op
+Assembler& Assembler::op( int opCode, int operand )
+{
+    return u8( opCode ).u30( operand );
+}
+
+// ** Assembler::op
+Assembler& Assembler::op( int opCode, int operand, int argCount )
+{
+    return u8( opCode ).u30( operand ).u30( argCount );
+}
+
+// ** Assembler::u8
+Assembler& Assembler::u8( int value )
+{
+    m_code.append( ( Uint8 )value );
+    return *this;
+}
+
+// ** Assembler::u30
+Assembler& Assembler::u30( unsigned int value )
+{
+    do {
+        Uint8 byte = value & 0x7f;
+        value >>= 7;
+        m_code.append( ( Uint8 )( value ? byte | 0x80 : byte ) );
+    } while( value );
+
+    return *this;
+}
+
+// ** Assembler::s24
+Assembler& Assembler::s24( int value )
+{
+    return u8( value & 0xff ).u8( ( value >> 8 ) & 0xff ).u8( ( value >> 16 ) & 0xff );
+}
+
+// ** Assembler::branch
+Assembler& Assembler::branch( int opCode, int label )
+{
+    u8( opCode );
+    m_branches.push_back( m_code.size() );
+    m_branches.push_back( label );
+    return s24( 0 );
+}
+
+// ** Assembler::label
+Assembler& Assembler::label( int label )
+{
+    assert( label >= 0 && label < MaxLabels );
+    m_labels[label] = m_code.size();
+    return *this;
+}
+
+// ** Assembler::finish
+const membuf& Assembler::finish( void )
+{
+    Uint8* code = ( Uint8* )m_code.data();
+
+    // ** Branch offsets are relative to the end of the offset field
+    for( int i = 0, n = ( int )m_branches.size(); i < n; i += 2 ) {
+        int at     = m_branches[i];
+        int offset = m_labels[m_branches[i + 1]] - ( at + 3 );
+
+        code[at + 0] = offset & 0xff;
+        code[at + 1] = ( offset >> 8 ) & 0xff;
+        code[at + 2] = ( offset >> 16 ) & 0xff;
+    }
+
+    return m_code;
+}
+
+// ** class Module
+//! An ABC module built in memory, with a single script that runs a workload.
+class Module {
+public:
+
+                    Module( void );
+
+    int             string( const char* value );
+    int             qname( const char* name );
+    int             integer( int value );
+    //! Returns a runtime multiname, qualified by the public namespace.
+    int             multinameL( void );
+    //! Adds a method with untyped parameters and returns its index.
+    int             method( Assembler& code, int paramCount, int localCount, int maxStack = 8, int maxScopeDepth = 4 );
+    //! Adds a script initializer with script traits.
+    void            script( int init, const TraitsArray& traits = TraitsArray() );
+    //! Adds a class that extends Object and returns its index.
+    int             instance( const char* name, int iinit, int cinit, const TraitsArray& traits );
+    //! Returns an untyped slot trait.
+    TraitsInfo*     slot( const char* name, int slotId );
+    //! Returns a trait that binds a class to a script slot.
+    TraitsInfo*     classSlot( const char* name, int slotId, int classIndex );
+    //! Links the module, which runs its script, and returns the number of seconds it took.
+    double          run( void );
+
+private:
+
+    AbcInfo*        m_abc;
+    int             m_package;
+    int             m_packageSet;   //!< Namespace set with the public namespace only.
+};
+
+// ** Module::Module
+Module::Module( void ) : m_abc( new AbcInfo )
+{
+    // ** Entry zero of each constant pool is reserved
+    m_abc->m_string.push_back( "" );
+    m_abc->m_namespace.push_back( NamespaceInfo() );
+    m_abc->m_multiname.push_back( MultinameInfo( 0 ) );
+    m_abc->m_integer.push_back( 0 );
+    m_abc->m_uinteger.push_back( 0 );
+    m_abc->m_double.push_back( 0 );
+    m_abc->m_ns_set.push_back( NsSetInfo() );
+
+    NamespaceInfo package;
+    package.m_kind = NamespaceInfo::PackageNamespace;
+    package.m_name = string( "" );
+    m_abc->m_namespace.push_back( package );
+    m_package = m_abc->m_namespace.size() - 1;
+
+    NsSetInfo packageSet;
+    packageSet.push_back( m_package );
+    m_abc->m_ns_set.push_back( packageSet );
+    m_packageSet = m_abc->m_ns_set.size() - 1;
+}
+
+// ** Module::string
+int Module::string( const char* value )
+{
+    for( int i = 1, n = ( int )m_abc->m_string.size(); i < n; i++ ) {
+        if( m_abc->m_string[i] == value ) {
+            return i;
+        }
+    }
+
+    m_abc->m_string.push_back( value );
+    return m_abc->m_string.size() - 1;
+}
+
+// ** Module::qname
+int Module::qname( const char* name )
+{
+    int index = string( name );
+
+    for( int i = 1, n = ( int )m_abc->m_multiname.size(); i < n; i++ ) {
+        const MultinameInfo& multiname = m_abc->m_multiname[i];
+
+        if( multiname.m_kind == MultinameInfo::QName && multiname.m_name == index ) {
+            return i;
+        }
+    }
+
+    MultinameInfo multiname( m_abc->m_multiname.size() );
+    multiname.m_kind = MultinameInfo::QName;
+    multiname.m_ns   = m_package;
+    multiname.m_name = index;
+    m_abc->m_multiname.push_back( multiname );
+
+    return multiname.m_index;
+}
+
+// ** Module::integer
+int Module::integer( int value )
+{
+    m_abc->m_integer.push_back( value );
+    return m_abc->m_integer.size() - 1;
+}
+
+// ** Module::multinameL
+int Module::multinameL( void )
+{
+    MultinameInfo multiname( m_abc->m_multiname.size() );
+    multiname.m_kind   = MultinameInfo::MultinameL;
+    multiname.m_ns_set = m_packageSet;
+    m_abc->m_multiname.push_back( multiname );
+
+    return multiname.m_index;
+}
+
+// ** Module::method
+int Module::method( Assembler& code, int paramCount, int localCount, int maxStack, int maxScopeDepth )
+{
+    MethodInfo* method = new MethodInfo( m_abc->m_method.size() );
+    method->m_return_type = 0;
+    method->m_name        = 0;
+    method->m_flags       = 0;
+
+    for( int i = 0; i < paramCount; i++ ) {
+        method->m_param_type.push_back( 0 );
+    }
+
+    BodyInfo& body = method->m_body;
+    body.m_init_scope_depth = 0;
+    body.m_max_scope_depth  = maxScopeDepth;
+    body.m_max_stack        = maxStack;
+    body.m_local_count      = localCount;
+    body.m_code             = code.finish();
+
+    m_abc->m_method.push_back( method );
+    return method->m_index;
+}
+
+// ** Module::script
+void Module::script( int init, const TraitsArray& traits )
+{
+    ScriptInfo* script = new ScriptInfo;
+    script->m_init  = init;
+    script->m_trait = traits;
+    m_abc->m_script.push_back( script );
+}
+
+// ** Module::instance
+int Module::instance( const char* name, int iinit, int cinit, const TraitsArray& traits )
+{
+    InstanceInfo* instance = new InstanceInfo( m_abc->m_instance.size() );
+    instance->m_name       = qname( name );
+    instance->m_super_name = qname( "Object" );
+    instance->m_flags      = InstanceInfo::ClassSealed;
+    instance->m_iinit      = iinit;
+    instance->m_trait      = traits;
+
+    ClassInfo* info = new ClassInfo;
+    info->m_cinit = cinit;
+
+    m_abc->m_instance.push_back( instance );
+    m_abc->m_class.push_back( info );
+
+    return instance->m_index;
+}
+
+// ** Module::slot
+TraitsInfo* Module::slot( const char* name, int slotId )
+{
+    TraitsInfo* trait = new TraitsInfo;
+    trait->m_name             = qname( name );
+    trait->m_kind             = TraitsInfo::Slot;
+    trait->m_attr             = 0;
+    trait->m_slot.m_slot_id   = slotId;
+    trait->m_slot.m_type_name = 0;
+    trait->m_slot.m_vindex    = 0;
+    trait->m_slot.m_vkind     = ConstTypeUndefined;
+    return trait;
+}
+
+// ** Module::classSlot
+TraitsInfo* Module::classSlot( const char* name, int slotId, int classIndex )
+{
+    TraitsInfo* trait = new TraitsInfo;
+    trait->m_name           = qname( name );
+    trait->m_kind           = TraitsInfo::Class;
+    trait->m_attr           = 0;
+    trait->m_cls.m_slot_id  = slotId;
+    trait->m_cls.m_classi   = classIndex;
+    return trait;
+}
+
+// ** Module::run
+double Module::run( void )
+{
+    double  heap  = heapInUse();
+    clock_t start = clock();
+
+    Domain* domain = new Domain;
+    domain->registerPackages();
+
+    Linker linker( domain, m_abc );
+    linker.link();
+
+    double seconds = double( clock() - start ) / CLOCKS_PER_SEC;
+    s_heapGrowth   = heapInUse() - heap;
+
+    return seconds;
+}
+
+// ------------------------------------------------ Workloads ------------------------------------------------ //
+
+//! var s = 0; for( var i = 0; i < count; i++ ) s += i
+static double loop( int count )
+{
+    Module    module;
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.op( PushByte ).u8( 0 ).op( SetLocal2 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLocal1 ).op( GetLocal2 ).op( Add ).op( SetLocal1 );
+    code.op( GetLocal2 ).op( Increment ).op( SetLocal2 );
+    code.label( 1 ).op( GetLocal2 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    module.script( module.method( code, 0, 3 ) );
+    return module.run();
+}
+
+//! function fib( n ) { return n < 2 ? n : fib( n - 1 ) + fib( n - 2 ) }; fib( count )
+static double calls( int count )
+{
+    Module    module;
+    Assembler fib;
+
+    fib.op( GetLocal1 ).op( PushByte ).u8( 2 ).branch( IfLess, 0 );
+    fib.op( FindPropertyStrict, module.qname( "fib" ) ).op( GetLocal1 ).op( Decrement ).op( CallProperty, module.qname( "fib" ), 1 );
+    fib.op( FindPropertyStrict, module.qname( "fib" ) ).op( GetLocal1 ).op( PushByte ).u8( 2 ).op( Subtract ).op( CallProperty, module.qname( "fib" ), 1 );
+    fib.op( Add ).op( ReturnValue );
+    fib.label( 0 ).op( GetLocal1 ).op( ReturnValue );
+
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( FindProperty, module.qname( "fib" ) ).op( NewFunction, module.method( fib, 1, 2 ) ).op( SetProperty, module.qname( "fib" ) );
+    code.op( FindPropertyStrict, module.qname( "fib" ) ).op( PushByte ).u8( count ).op( CallPropVoid, module.qname( "fib" ), 1 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.slot( "fib", 1 ) );
+
+    module.script( module.method( code, 0, 1 ), traits );
+    return module.run();
+}
+
+//! function sum( n ) { var s = 0; for( var i = 0; i < n; i++ ) s += i; return s }; for( var j = 0; j < count; j++ ) sum( 8 )
+static double sums( int count )
+{
+    Module    module;
+    Assembler sum;
+
+    sum.op( PushByte ).u8( 0 ).op( SetLocal2 );
+    sum.op( PushByte ).u8( 0 ).op( SetLocal3 );
+    sum.branch( Jump, 1 );
+    sum.label( 0 ).op( Label );
+    sum.op( GetLocal2 ).op( GetLocal3 ).op( Add ).op( SetLocal2 );
+    sum.op( GetLocal3 ).op( Increment ).op( SetLocal3 );
+    sum.label( 1 ).op( GetLocal3 ).op( GetLocal1 ).branch( IfLess, 0 );
+    sum.op( GetLocal2 ).op( ReturnValue );
+
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( FindProperty, module.qname( "sum" ) ).op( NewFunction, module.method( sum, 1, 4 ) ).op( SetProperty, module.qname( "sum" ) );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( FindPropertyStrict, module.qname( "sum" ) ).op( PushByte ).u8( 8 ).op( CallPropVoid, module.qname( "sum" ), 1 );
+    code.op( GetLocal1 ).op( Increment ).op( SetLocal1 );
+    code.label( 1 ).op( GetLocal1 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.slot( "sum", 1 ) );
+
+    module.script( module.method( code, 0, 2 ), traits );
+    return module.run();
+}
+
+//! class Point { var x; var y }; var keep = []; for( var i = 0; i < count; i++ ) keep[i] = new Point
+static double objects( int count )
+{
+    Module    module;
+    Assembler iinit;
+    Assembler cinit;
+
+    iinit.op( GetLocal0 ).op( PushScope ).op( GetLocal0 ).op( ConstructSuper, 0 ).op( ReturnVoid );
+    cinit.op( GetLocal0 ).op( PushScope ).op( ReturnVoid );
+
+    TraitsArray slots;
+    slots.push_back( module.slot( "x", 1 ) );
+    slots.push_back( module.slot( "y", 2 ) );
+
+    int point = module.instance( "Point", module.method( iinit, 0, 1 ), module.method( cinit, 0, 1 ), slots );
+
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( GetScopeObject ).u8( 0 ).op( GetLex, module.qname( "Object" ) ).op( PushScope );
+    code.op( GetLex, module.qname( "Object" ) ).op( NewClass, point ).op( PopScope ).op( InitProperty, module.qname( "Point" ) );
+    code.op( GetScopeObject ).u8( 0 ).op( NewArray, 0 ).op( InitProperty, module.qname( "keep" ) );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLex, module.qname( "keep" ) ).op( GetLocal1 );
+    code.op( FindPropertyStrict, module.qname( "Point" ) ).op( ConstructProp, module.qname( "Point" ), 0 );
+    code.op( SetProperty, module.multinameL() );
+    code.op( GetLocal1 ).op( Increment ).op( SetLocal1 );
+    code.label( 1 ).op( GetLocal1 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.classSlot( "Point", 1, point ) );
+    traits.push_back( module.slot( "keep", 2 ) );
+
+    module.script( module.method( code, 0, 2 ), traits );
+    return module.run();
+}
+
+//! class Point { var x; var y }; var p = new Point; p.x = 1; var s = 0; for( var i = 0; i < count; i++ ) { s = s + p.x; p.y = p.x }
+static double fields( int count )
+{
+    Module    module;
+    Assembler iinit;
+    Assembler cinit;
+
+    iinit.op( GetLocal0 ).op( PushScope ).op( GetLocal0 ).op( ConstructSuper, 0 ).op( ReturnVoid );
+    cinit.op( GetLocal0 ).op( PushScope ).op( ReturnVoid );
+
+    TraitsArray slots;
+    slots.push_back( module.slot( "x", 1 ) );
+    slots.push_back( module.slot( "y", 2 ) );
+
+    int point = module.instance( "Point", module.method( iinit, 0, 1 ), module.method( cinit, 0, 1 ), slots );
+
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( GetScopeObject ).u8( 0 ).op( GetLex, module.qname( "Object" ) ).op( PushScope );
+    code.op( GetLex, module.qname( "Object" ) ).op( NewClass, point ).op( PopScope ).op( InitProperty, module.qname( "Point" ) );
+    code.op( FindPropertyStrict, module.qname( "Point" ) ).op( ConstructProp, module.qname( "Point" ), 0 ).op( SetLocal1 );
+    code.op( GetLocal1 ).op( PushByte ).u8( 1 ).op( SetProperty, module.qname( "x" ) );
+    code.op( PushByte ).u8( 0 ).op( SetLocal2 );
+    code.op( PushByte ).u8( 0 ).op( SetLocal3 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLocal2 ).op( GetLocal1 ).op( GetProperty, module.qname( "x" ) ).op( Add ).op( SetLocal2 );
+    code.op( GetLocal1 ).op( GetLocal1 ).op( GetProperty, module.qname( "x" ) ).op( SetProperty, module.qname( "y" ) );
+    code.op( GetLocal3 ).op( Increment ).op( SetLocal3 );
+    code.label( 1 ).op( GetLocal3 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.classSlot( "Point", 1, point ) );
+
+    module.script( module.method( code, 0, 4 ), traits );
+    return module.run();
+}
+
+//! var keep = []; for( var i = 0; i < count; i++ ) keep[i] = i
+static double store( int count )
+{
+    Module    module;
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( GetScopeObject ).u8( 0 ).op( NewArray, 0 ).op( InitProperty, module.qname( "keep" ) );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLex, module.qname( "keep" ) ).op( GetLocal1 ).op( GetLocal1 ).op( SetProperty, module.multinameL() );
+    code.op( GetLocal1 ).op( Increment ).op( SetLocal1 );
+    code.label( 1 ).op( GetLocal1 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.slot( "keep", 1 ) );
+
+    module.script( module.method( code, 0, 2 ), traits );
+    return module.run();
+}
+
+//! var holes = []; holes[count * 10] = 0; for( var i = 0; i < count; i++ ) holes[i * 10] = i
+static double sparse( int count )
+{
+    Module    module;
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( GetScopeObject ).u8( 0 ).op( NewArray, 0 ).op( InitProperty, module.qname( "holes" ) );
+    code.op( GetLex, module.qname( "holes" ) ).op( PushInt, module.integer( count * 10 ) ).op( PushByte ).u8( 0 ).op( SetProperty, module.multinameL() );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLex, module.qname( "holes" ) ).op( GetLocal1 ).op( PushByte ).u8( 10 ).op( Multiply ).op( GetLocal1 ).op( SetProperty, module.multinameL() );
+    code.op( GetLocal1 ).op( Increment ).op( SetLocal1 );
+    code.label( 1 ).op( GetLocal1 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.slot( "holes", 1 ) );
+
+    module.script( module.method( code, 0, 2 ), traits );
+    return module.run();
+}
+
+//! var keys = {}; for( var i = 0; i < count; i++ ) keys[i] = i
+static double keys( int count )
+{
+    Module    module;
+    Assembler code;
+
+    code.op( GetLocal0 ).op( PushScope );
+    code.op( GetScopeObject ).u8( 0 ).op( NewObject, 0 ).op( InitProperty, module.qname( "keys" ) );
+    code.op( PushByte ).u8( 0 ).op( SetLocal1 );
+    code.branch( Jump, 1 );
+    code.label( 0 ).op( Label );
+    code.op( GetLex, module.qname( "keys" ) ).op( GetLocal1 ).op( GetLocal1 ).op( SetProperty, module.multinameL() );
+    code.op( GetLocal1 ).op( Increment ).op( SetLocal1 );
+    code.label( 1 ).op( GetLocal1 ).op( PushInt, module.integer( count ) ).branch( IfLess, 0 );
+    code.op( ReturnVoid );
+
+    TraitsArray traits;
+    traits.push_back( module.slot( "keys", 1 ) );
+
+    module.script( module.method( code, 0, 2 ), traits );
+    return module.run();
+}
+
+// ** struct Workload
+struct Workload {
+    const char*     name;
+    double          ( *run )( int count );
+    int             count;      //!< Iterations of a single pass.
+    int             passes;     //!< Passes, each links a fresh module and stays below the runaway limit of a call.
+    bool            heap;       //!< Reports heap bytes kept per iteration.
+};
+
+static const Workload Workloads[] = {
+    { "loop",       loop,       50000,      40, false },
+    { "calls",      calls,      20,         20, false },
+    { "sums",       sums,       20000,      20, false },
+    { "objects",    objects,    1000000,    1,  true  },
+    { "fields",     fields,     50000,      20, false },
+    { "store",      store,      1000000,    1,  true  },
+    { "sparse",     sparse,     100000,     1,  true  },
+    { "keys",       keys,       100000,     1,  true  },
+};
+
+int main(int argc, const char * argv[])
+{
+    const char* workload = NULL;
+    int         passes   = 0;
+    int         runs     = 5;
+    bool        opStats  = false;
+
+    for( int i = 0; i < argc - 1; i++ ) {
+        if( strcmp( argv[i], "-workload" ) == 0 ) {
+            workload = argv[i + 1];
+        }
+        if( strcmp( argv[i], "-passes" ) == 0 ) {
+            passes = atoi( argv[i + 1] );
+        }
+        if( strcmp( argv[i], "-runs" ) == 0 ) {
+            runs = atoi( argv[i + 1] );
+        }
+        if( strcmp( argv[i], "-opstats" ) == 0 ) {
+            opStats = strcmp( argv[i + 1], "true" ) == 0;
+        }
+    }
+
+    // ** Each workload reports the best of its runs, which is the least disturbed by the rest of the system
+    for( int i = 0, n = sizeof( Workloads ) / sizeof( Workloads[0] ); i < n; i++ ) {
+        const Workload& w = Workloads[i];
+
+        if( workload && strcmp( workload, w.name ) != 0 ) {
+            continue;
+        }
+
+        int    count = passes ? passes : w.passes;
+        double best  = 0.0;
+
+        for( int j = 0; j < runs; j++ ) {
+            double seconds = 0.0;
+
+            for( int k = 0; k < count; k++ ) {
+                seconds += w.run( w.count );
+            }
+
+            best = j ? std::min( best, seconds ) : seconds;
+        }
+
+        printf( "%-10s %8d x %-4d %8.3fs", w.name, w.count, count, best );
+
+        if( w.heap ) {
+            printf( " %8.1f bytes per iteration", s_heapGrowth / w.count );
+        }
+
+        printf( "\n" );
+    }
+
+#if AVM2_OPCODE_STATS
+    // ** Opcode pairs of the linked workloads, before and after register translation
+    if( opStats ) {
+        Dump::dumpOpCodePairs( 32 );
+    }
+#endif
+
+    return 0;
+}
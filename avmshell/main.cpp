@@ -27,6 +27,7 @@
 #include <Domain.h>
 #include <Linker.h>
 #include <Abc.h>
+#include <Dump.h>
 
 using namespace avm2;
 
@@ -34,6 +35,8 @@ int main(int argc, const char * argv[])
 {
     std::string fileName = "";
     bool        verbose  = false;
+    bool        opStats  = false;
+    bool        profile  = false;
 
     for( int i = 0; i < argc; i++ ) {
         if( strcmp( argv[i], "-abc" ) == 0 ) {
@@ -42,6 +45,12 @@ int main(int argc, const char * argv[])
         if( strcmp( argv[i], "-verbose" ) == 0 ) {
             verbose = strcmp( argv[i + 1], "true" ) == 0;
         }
+        if( strcmp( argv[i], "-opstats" ) == 0 ) {
+            opStats = strcmp( argv[i + 1], "true" ) == 0;
+        }
+        if( strcmp( argv[i], "-profile" ) == 0 ) {
+            profile = strcmp( argv[i + 1], "true" ) == 0;
+        }
     }
 
     if( fileName == "" ) {
@@ -68,6 +77,16 @@ int main(int argc, const char * argv[])
     Linker linker( domain, abc );
     linker.link();
 
+    if( profile ) {
+        Dump::dumpProfile( domain );
+    }
+
+#if AVM2_OPCODE_STATS
+    if( opStats ) {
+        Dump::dumpOpCodePairs( 32 );
+    }
+#endif
+
     return 0;
 }
 
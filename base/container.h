@@ -156,6 +156,17 @@ public:
 			return false;
 		}
 	}
+
+	bool	get(const T& key, int /*hash_value*/, U* value) const
+	// The STL hash_map always hashes the key itself.
+	{
+		return get(key, value);
+	}
+
+	static int	compute_hash(const T& /*key*/)
+	{
+		return 0;
+	}
 };
 
 
@@ -922,6 +933,33 @@ public:
 	}
 
 
+	bool	get(const T& key, int hash_value, U* value) const
+	// Same as get(key, value), but uses a hash value previously
+	// returned by compute_hash(key) instead of hashing the key again.
+	{
+		int	index = find_index(key, hash_value);
+		if (index >= 0)
+		{
+			if (value) {
+				*value = E(index).second;
+			}
+			return true;
+		}
+		return false;
+	}
+
+
+	static int	compute_hash(const T& key)
+	// Returns the hash value that this table uses for the given key.
+	{
+		int hash_value = hash_functor()(key);
+		if (hash_value == TOMBSTONE_HASH) {
+			hash_value ^= 0x8000;
+		}
+		return hash_value;
+	}
+
+
 	int	size() const
 	{
 		return m_table == NULL ? 0 : m_table->m_entry_count;
@@ -1196,6 +1234,26 @@ public:
 
 	const_iterator	find(const T& key) const { return const_cast<hash*>(this)->find(key); }
 
+	// Index API, for walking the table without an iterator.  An
+	// index stays valid until the table is resized or cleared.
+
+	int	next_index(int index) const
+	// Returns the index of the first live entry at or after the
+	// given one, or -1 if there are none.
+	{
+		if (m_table == NULL || index < 0) return -1;
+
+		while (index <= m_table->m_size_mask
+			&& (E(index).is_empty() || E(index).is_tombstone()))
+		{
+			index++;
+		}
+		return index <= m_table->m_size_mask ? index : -1;
+	}
+
+	const T&	key_at(int index) const { return E(index).first; }
+	const U&	value_at(int index) const { return E(index).second; }
+
 private:
 	// A value of m_hash_value that marks an entry as a
 	// "tombstone" -- i.e. a placeholder entry.
@@ -1206,7 +1264,14 @@ private:
 	{
 		if (m_table == NULL) return -1;
 
-		int	hash_value = compute_hash(key);
+		return find_index(key, compute_hash(key));
+	}
+
+	int	find_index(const T& key, int hash_value) const
+	// Find the index of the matching entry with a known hash value.
+	{
+		if (m_table == NULL) return -1;
+
 		int	index = (int) (hash_value & m_table->m_size_mask);
 
 		const entry*	e = &E(index);
@@ -1241,14 +1306,6 @@ private:
 		return -1;
 	}
 
-	int compute_hash(const T& key) const {
-		int hash_value = hash_functor()(key);
-		if (hash_value == TOMBSTONE_HASH) {
-			hash_value ^= 0x8000;
-		}
-		return hash_value;
-	}
-
 	// Helpers.
 	entry&	E(int index)
 	{
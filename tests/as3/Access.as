@@ -73,3 +73,18 @@ bar.read()
 //foo.readFromAnonymous()
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
+
+trace( 'Mixing numeric and string keys on a plain Object...' )
+
+var keyed : Object = {}
+keyed['5'] = 'five'
+keyed[6]   = 'six'
+
+trace( keyed[5] )		// five
+trace( keyed['6'] )		// six
+
+var index : int = 5
+keyed[index] = 'FIVE'
+trace( keyed['5'] )		// FIVE
+
+////////////////////////////////////////////////////////////////////////////////////////////////
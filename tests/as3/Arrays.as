@@ -375,6 +375,36 @@ for(var m:uint = 0; m < records.length; m++) {
 // bob, omaha
 // john, omaha
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var sparse:Array = new Array();
+sparse[10000000] = "last";
+sparse[5] = "five";
+trace(sparse.length);    // 10000001
+trace(sparse[5]);        // five
+trace(sparse[6]);        // undefined
+trace(sparse[10000000]); // last
+
+var visited:int = 0;
+sparse.forEach(function(item:*, index:int, array:Array):void { visited++; });
+trace(visited);          // 2
+
+trace(sparse.pop());     // last
+trace(sparse.length);    // 10000000
+
+var huge : Array = [];
+huge[2147483647] = "int max";
+huge["4294967296"] = "beyond uint";
+trace(huge[2147483647]);     // int max
+trace(huge["2147483647"]);   // int max
+trace(huge[4294967296]);     // beyond uint
+
+trace(sparse.indexOf("five")); // 5
+
+sparse[-1] = "negative";
+trace(sparse[-1]);       // negative
+trace(sparse.length);    // 10000000
+
 
 /*
 var myArray : Array = null
@@ -17,4 +17,18 @@ trace( bob.m_health )
 //trace( bob.m_name )	// runtime error
 trace( bob.m_speed )
 
-Entity.dump( bob, 'after' )
\ No newline at end of file
+Entity.dump( bob, 'after' )
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var counter : Counter = new TripleCounter
+for( var i : int = 0; i < 1000; i++ ) {
+	counter.bump()
+}
+
+trace( counter.m_count )	// 3000
+trace( counter.total() )	// 30000
+
+var plain : Counter = new Counter
+plain.bump()
+trace( plain.total() )		// 1
@@ -11,6 +11,14 @@
 			addEventListener( Event.ADDED, added.callback )
 			addEventListener( Event.ADDED_TO_STAGE, addedToStage.callback )
 			addEventListener( Event.ENTER_FRAME, onEnterFrame )
+
+			var bound	 = new Test( "BOUND" )
+			var callback = bound.callback
+
+			trace( bound.callback === bound.callback )	// true
+			trace( callback === bound.callback )		// true
+			bound = null
+			callback( null )							// Test:callback : BOUND
 		}
 		
 		function onEnterFrame( e ) {
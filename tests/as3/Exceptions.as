@@ -99,4 +99,71 @@ try {
 	errorStrict( false )
 } catch( e ) {
 	trace( 'Unhandled error caught: ' + e )
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function nested( value ) {
+	try {
+		try {
+			throw value
+		}
+		catch( e : String ) {
+			trace( 'Inner: ' + e )
+		}
+		finally {
+			trace( 'Inner finally' )
+		}
+	}
+	catch( e : Error ) {
+		trace( 'Outer: ' + e.message )
+	}
+	finally {
+		trace( 'Outer finally' )
+	}
+}
+
+nested( 'string' )
+nested( new Error( 'error' ) )
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+try {
+	try {
+		trace( 'No exception' )
+	}
+	finally {
+		trace( 'Finally only' )
+	}
+
+	try {
+		throw new CustomError( 'Through finally' )
+	}
+	finally {
+		trace( 'Finally only' )
+	}
+}
+catch( e : Error ) {
+	trace( e )
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function one() {
+	two()
+}
+
+function two() {
+	throw new Error( 'Thrown from a nested call with a message longer than sixty four characters' )
+}
+
+try {
+	one()
+}
+catch( e : Error ) {
+	var stackTrace : String = e.getStackTrace()
+
+	trace( e.message )
+	trace( stackTrace == null || stackTrace.indexOf( String( e ) ) == 0 )
+	trace( stackTrace == null || stackTrace.indexOf( 'two' ) > 0 )
 }
\ No newline at end of file
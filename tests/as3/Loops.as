@@ -22,4 +22,16 @@ j = 0
 do { 
 	trace( j )
 	j++
-} while ( j < 10);
\ No newline at end of file
+} while ( j < 10);
+
+trace( 'Indexed array loop:' )
+var squares : Array = []
+for( var k : int = 0; k < 5; k++ ) {
+	squares[k] = k * k
+}
+var total : int = 0
+for( k = 0; k < squares.length; k++ ) {
+	total += squares[k]
+}
+trace( total )	// 30
+trace( squares["4"] )	// 16
@@ -0,0 +1,64 @@
+﻿////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var folded : Number = 2 * 3 + 4
+trace( folded )			// 10
+trace( 7 - 10 )			// -3
+trace( 1 / 4 * 8 )		// 2
+trace( 'a' + 1 + 2 )	// a12
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function classify( value : int ) : String {
+	var result : String
+
+	if( value < 0 ) {
+		if( value < -10 ) {
+			result = 'very negative'
+		} else {
+			result = 'negative'
+		}
+	} else {
+		if( value > 10 ) {
+			result = 'very positive'
+		} else {
+			result = 'positive'
+		}
+	}
+
+	return result
+}
+
+trace( classify( -20 ) )	// very negative
+trace( classify( -1 ) )		// negative
+trace( classify( 5 ) )		// positive
+trace( classify( 50 ) )		// very positive
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var pairs : int = 0
+
+outer: for( var i : int = 0; i < 10; i++ ) {
+	for( var j : int = 0; j < 10; j++ ) {
+		if( j > i ) {
+			continue outer
+		}
+		if( i == 8 ) {
+			break outer
+		}
+		pairs++
+	}
+}
+trace( pairs )	// 36
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function early( value : int ) : int {
+	if( value > 0 ) {
+		return value
+	}
+	return -value
+	trace( 'Unreachable' )
+}
+
+trace( early( 3 ) )		// 3
+trace( early( -4 ) )	// 4
\ No newline at end of file
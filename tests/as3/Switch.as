@@ -21,4 +21,19 @@ function traceLanguage( lang ) {
 		
 		default: trace( 'Unknown language ' + lang )
 	}
-}
\ No newline at end of file
+}
+
+traceDigit( 0 )
+traceDigit( 1 )
+traceDigit( 2 )
+traceDigit( 3 )
+
+// ** The last case is reached through the last lookupswitch offset
+function traceDigit( digit : int ) {
+	switch( digit ) {
+		case 0:	trace( "zero" );	break;
+		case 1:	trace( "one" );	break;
+		case 2:	trace( "two" );	break;
+		default:	trace( "many" )
+	}
+}
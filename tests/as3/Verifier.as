@@ -0,0 +1,54 @@
+﻿import classes.Counter
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var counter : Counter = new Counter()
+
+for( var i : int = 0; i < 10; i++ ) {
+	counter.bump()
+}
+trace( counter.total() )	// 10
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function sum( values : Array ) : int {
+	var total : int = 0
+
+	for( var k : int = 0; k < values.length; k++ ) {
+		total = int( total + int( values[k] ) )
+	}
+	return total
+}
+
+trace( sum( [1, 2, 3, 4] ) )		// 10
+trace( sum( ['5', 6.5, true] ) )	// 12
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+function half( value : Number ) : Number {
+	return Number( value / 2 )
+}
+
+var halve : Function = half
+trace( halve( 5 ) )	// 2.5
+trace( uint( 7 ) )	// 7
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+var missing : Counter = null
+
+try {
+	missing.bump()
+}
+catch( e : TypeError ) {
+	trace( 'Caught: null receiver' )
+}
+
+var notFunction : * = 5
+
+try {
+	notFunction()
+}
+catch( e : TypeError ) {
+	trace( 'Caught: value is not a function' )
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+﻿package classes {
+
+	// ** class Counter
+	public class Counter {
+		public var m_count : int = 0
+
+		public function bump() : void {
+			m_count++
+		}
+
+		public function total() : int {
+			return m_count
+		}
+	}
+
+}
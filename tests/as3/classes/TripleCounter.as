@@ -0,0 +1,17 @@
+﻿package classes {
+
+	// ** class TripleCounter
+	public class TripleCounter extends Counter {
+		override public function bump() : void {
+			// ** super.bump() is a statement, its result must not stay on the operand stack
+			for( var i : int = 0; i < 3; i++ ) {
+				super.bump()
+			}
+		}
+
+		override public function total() : int {
+			return super.total() * 10
+		}
+	}
+
+}